@@ -0,0 +1,242 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ===========================================
+// ASSET MANAGER
+// Images (PNG) and sounds (OGG) are decoded on a few background threads,
+// while the main thread keeps drawing. Each call to pump() uploads the
+// decoded images to their textures, since only the main thread may touch
+// the GPU, and stops once its time budget is spent so a loading screen
+// stays responsive.
+//
+// Each file is decoded at most once. Asking for a path again, as a texture
+// or as an image, returns the same object. Returned references stay valid
+// for the manager's lifetime. Their contents are blank until the path
+// finishes loading.
+// ===========================================
+
+enum class AssetStatus { Pending, Ready, Failed };
+
+class AssetManager {
+public:
+    // At most 4 decode threads by default; decoding is mostly disk and zlib
+    static unsigned int defaultThreads() {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        return std::clamp(hardware, 1u, 4u);
+    }
+
+    explicit AssetManager(unsigned int decodeThreads = defaultThreads()) {
+        decodeThreads = std::max(decodeThreads, 1u);
+        m_threads.reserve(decodeThreads);
+        for (unsigned int i = 0; i < decodeThreads; i++) {
+            m_threads.emplace_back([this] { decodeLoop(); });
+        }
+    }
+
+    // Files still queued are dropped; ones being decoded finish first
+    ~AssetManager() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // GPU texture for the image at path
+    const sf::Texture& texture(const std::filesystem::path& path) {
+        Entry& entry = request(path, Kind::Image);
+        entry.upload = true;
+        return entry.texture;
+    }
+
+    // CPU copy of the image at path, kept after any upload. Main thread only.
+    const sf::Image& image(const std::filesystem::path& path) {
+        Entry& entry = request(path, Kind::Image);
+        if (!entry.keepImage && entry.status == AssetStatus::Ready && entry.upload) {
+            // Its pixels were already released after uploading; read them back
+            entry.image = entry.texture.copyToImage();
+        }
+        entry.keepImage = true;
+        return entry.image;
+    }
+
+    // Drops the CPU copy of the image at path once nothing reads it, as
+    // after packing it into an atlas; its texture, if any, stays
+    void releaseImage(const std::filesystem::path& path) {
+        auto it = m_index.find(key(path));
+        if (it == m_index.end()) return;
+        Entry& entry = *m_entries[it->second];
+        if (entry.status == AssetStatus::Pending) return;
+        entry.image = sf::Image();
+        entry.keepImage = false;
+    }
+
+    // Fully decoded samples of the sound at path
+    const sf::SoundBuffer& sound(const std::filesystem::path& path) {
+        return request(path, Kind::Sound).sound;
+    }
+
+    // Pending for a path never asked for
+    AssetStatus status(const std::filesystem::path& path) const {
+        auto it = m_index.find(key(path));
+        if (it == m_index.end()) {
+            it = m_index.find(key(path, Kind::Sound));
+            if (it == m_index.end()) return AssetStatus::Pending;
+        }
+        return m_entries[it->second]->status;
+    }
+
+    bool loaded(const std::filesystem::path& path) const { return status(path) == AssetStatus::Ready; }
+
+    // Finishes decoded files until budget is spent, uploading textures.
+    // True once every file asked for so far is Ready or Failed.
+    bool pump(std::chrono::microseconds budget) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (Entry* entry : m_decoded) m_finishing.push_back(entry);
+            m_decoded.clear();
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        while (!m_finishing.empty()) {
+            finish(*m_finishing.front());
+            m_finishing.pop_front();
+            if (std::chrono::steady_clock::now() >= deadline) break;
+        }
+        return done();
+    }
+
+    // Blocks until everything asked for is loaded
+    void waitAll() {
+        while (!pump(std::chrono::milliseconds(50))) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_decodedWake.wait(lock, [this] { return !m_decoded.empty() || !m_finishing.empty(); });
+        }
+    }
+
+    bool done() const { return m_finished == m_entries.size(); }
+
+    // Distinct files asked for, of which finished are Ready or Failed
+    std::size_t requested() const { return m_entries.size(); }
+    std::size_t finished() const { return m_finished; }
+    std::size_t failed() const { return m_failures.size(); }
+
+    unsigned int threads() const { return static_cast<unsigned int>(m_threads.size()); }
+
+    // Requests answered from an earlier one for the same file
+    std::size_t duplicates() const { return m_duplicates; }
+
+    float progress() const {
+        return m_entries.empty() ? 1.0f : static_cast<float>(m_finished) / m_entries.size();
+    }
+
+    // Paths that failed to load, in the order they finished
+    const std::vector<std::filesystem::path>& failures() const { return m_failures; }
+
+private:
+    enum class Kind { Image, Sound };
+
+    struct Entry {
+        std::filesystem::path path;
+        Kind kind = Kind::Image;
+        AssetStatus status = AssetStatus::Pending;
+        bool upload = false;     // a texture was asked for
+        bool keepImage = false;  // the CPU image was asked for
+        bool decoded = false;    // written by the decoding thread
+        sf::Image image;
+        sf::Texture texture;
+        sf::SoundBuffer sound;
+    };
+
+    static std::string key(const std::filesystem::path& path, Kind kind = Kind::Image) {
+        return (kind == Kind::Sound ? "sound:" : "image:") + path.lexically_normal().generic_string();
+    }
+
+    Entry& request(const std::filesystem::path& path, Kind kind) {
+        auto [it, inserted] = m_index.try_emplace(key(path, kind), m_entries.size());
+        if (!inserted) {
+            m_duplicates++;
+            return *m_entries[it->second];
+        }
+
+        m_entries.push_back(std::make_unique<Entry>());
+        Entry& entry = *m_entries.back();
+        entry.path = path;
+        entry.kind = kind;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(&entry);
+        }
+        m_wake.notify_one();
+        return entry;
+    }
+
+    // Only the entry's payload and decoded flag are written off the main thread
+    void decodeLoop() {
+        while (true) {
+            Entry* entry;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                if (m_stopping) return;
+                entry = m_queue.front();
+                m_queue.pop_front();
+            }
+
+            entry->decoded = entry->kind == Kind::Sound ? entry->sound.loadFromFile(entry->path)
+                                                        : entry->image.loadFromFile(entry->path);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_decoded.push_back(entry);
+            }
+            m_decodedWake.notify_one();
+        }
+    }
+
+    void finish(Entry& entry) {
+        bool ok = entry.decoded;
+        if (ok && entry.kind == Kind::Image && entry.upload) {
+            ok = entry.texture.loadFromImage(entry.image);
+            if (!entry.keepImage) entry.image = sf::Image();
+        }
+        entry.status = ok ? AssetStatus::Ready : AssetStatus::Failed;
+        if (!ok) m_failures.push_back(entry.path);
+        m_finished++;
+    }
+
+    // Main thread
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::unordered_map<std::string, std::size_t> m_index;
+    std::deque<Entry*> m_finishing;  // decoded, not yet finished
+    std::size_t m_finished = 0;
+    std::size_t m_duplicates = 0;
+    std::vector<std::filesystem::path> m_failures;
+
+    // Shared with the decoding threads
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_decodedWake;
+    std::deque<Entry*> m_queue;
+    std::vector<Entry*> m_decoded;
+    bool m_stopping = false;
+
+    std::vector<std::thread> m_threads;
+};
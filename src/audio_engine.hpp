@@ -0,0 +1,308 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "entity_store.hpp"
+#include "tile_map.hpp"
+
+// ===========================================
+// AUDIO ENGINE
+// Music streams from disk through sf::Music, which decodes on SFML's own
+// thread a chunk at a time. Each effect gets its own few sf::Sound voices,
+// bound to its buffer when it is defined, so starting a cue never rebinds
+// a voice. At most VOICES play at once across all effects; a cue takes a
+// free voice of its effect or, when its effect's voices or the whole mix
+// are busy, steals the least important one it may. Gain falls off with
+// distance as in DOOM and drops further for each wall between listener and
+// source on the tile grid; pan comes from the source's side of the view,
+// easing to the centre for sources within CLOSE_DISTANCE, so the player's
+// own sounds, cued where the player stood on the tick, stay centred.
+// Voices are mixed without SFML's spatialisation, so the listener never
+// has to be kept in sync.
+//
+// The simulation only pushes cues into a SoundCues queue, so it never
+// touches audio and demos replay the same with or without a device.
+// Once built, neither the queue nor the engine allocates.
+// ===========================================
+
+// One effect: its samples, how much it matters when voices run out, and
+// its volume at the listener, 0 to 100
+struct SoundSpec {
+    const sf::SoundBuffer* buffer = nullptr; // null = silent
+    int priority = 0;
+    float volume = 100.0f;
+};
+
+// A sound an event made, at a map position
+struct SoundCue {
+    int sound;
+    double x, y;
+};
+
+// Cues of the ticks since the last frame, fixed capacity so pushing from
+// the simulation never allocates
+class SoundCues {
+public:
+    PoolPressure pressure;
+
+    explicit SoundCues(std::size_t capacity) {
+        pressure.capacity = capacity;
+        m_cues.reserve(capacity);
+    }
+
+    bool push(int sound, double x, double y) { return add({sound, x, y}); }
+
+    // Follows a streamed window recentring by (shiftX, shiftY) tiles
+    void shift(int shiftX, int shiftY) {
+        for (SoundCue& cue : m_cues) {
+            cue.x -= shiftX;
+            cue.y -= shiftY;
+        }
+    }
+
+    void clear() { m_cues.clear(); }
+    std::size_t size() const { return m_cues.size(); }
+    const SoundCue* begin() const { return m_cues.data(); }
+    const SoundCue* end() const { return m_cues.data() + m_cues.size(); }
+
+private:
+    bool add(const SoundCue& cue) {
+        if (!pressure.admit(m_cues.size())) return false;
+        m_cues.push_back(cue);
+        return true;
+    }
+
+    std::vector<SoundCue> m_cues;
+};
+
+// Where sounds are heard from: a position and the view direction
+struct AudioListener {
+    double x, y;
+    double dirX, dirY;
+};
+
+class AudioEngine {
+public:
+    static constexpr std::size_t VOICES = 16;          // playing at once
+    static constexpr std::size_t VOICES_PER_SOUND = 4; // of one effect at once
+    static constexpr double CLOSE_DISTANCE = 2.5; // tiles, full volume inside; DOOM's 160 units
+    static constexpr double CLIP_DISTANCE = 18.75; // tiles, silent past; DOOM's 1200 units
+    static constexpr float OCCLUSION_GAIN = 0.5f; // kept per wall in the way
+    static constexpr int MAX_OCCLUDERS = 3;       // walls counted at most
+    static constexpr float MIN_GAIN = 0.02f;      // quieter cues are not played
+    static constexpr float PAN_SWING = 0.75f;     // pan of a source straight to one side
+
+    explicit AudioEngine(std::size_t sounds, std::size_t voices = VOICES, std::size_t voicesPerSound = VOICES_PER_SOUND)
+        : m_sounds(sounds), m_pools(sounds), m_voiceLimit(voices), m_voicesPerSound(voicesPerSound) {}
+
+    AudioEngine(const AudioEngine&) = delete;
+    AudioEngine& operator=(const AudioEngine&) = delete;
+
+    ~AudioEngine() { stopAll(); }
+
+    // Builds the effect's voices on its buffer, which must outlive the
+    // engine; a silent effect gets none
+    void define(int sound, const SoundSpec& spec) {
+        m_sounds[sound] = spec;
+        Pool& pool = m_pools[sound];
+        for (sf::Sound& voice : pool.voices) voice.stop();
+        pool.voices.clear();
+        pool.slots.assign(spec.buffer ? m_voicesPerSound : 0, Slot());
+        pool.voices.reserve(pool.slots.size());
+        for (std::size_t i = 0; i < pool.slots.size(); i++) {
+            pool.voices.emplace_back(*spec.buffer);
+            pool.voices.back().setSpatializationEnabled(false);
+        }
+    }
+
+    // Loops the file at path from the start; false when it cannot be opened
+    bool playMusic(const std::filesystem::path& path, float volume) {
+        if (!m_music.openFromFile(path)) return false;
+        m_music.setSpatializationEnabled(false);
+        m_music.setLooping(true);
+        m_music.setVolume(volume);
+        m_music.play();
+        return true;
+    }
+
+    void stopMusic() { m_music.stop(); }
+
+    // Starts every cue, in order, as heard by listener through map
+    void play(const SoundCues& cues, const AudioListener& listener, const TileMap& map) {
+        for (const SoundCue& cue : cues) play(cue, listener, map);
+    }
+
+    void stopAll() {
+        for (Pool& pool : m_pools) {
+            for (sf::Sound& voice : pool.voices) voice.stop();
+        }
+    }
+
+    // Voices that may play at once
+    std::size_t voices() const { return m_voiceLimit; }
+
+    // Cues started on a voice, of which stolen took a busy one; dropped
+    // found every voice more important, culled were inaudible or silent
+    std::size_t started() const { return m_started; }
+    std::size_t stolen() const { return m_stolen; }
+    std::size_t dropped() const { return m_dropped; }
+    std::size_t culled() const { return m_culled; }
+
+private:
+    // What a voice is playing, to judge it against a new cue
+    struct Slot {
+        int priority = 0;
+        float gain = 0.0f;
+        std::uint64_t order = 0; // when it started
+    };
+
+    // An effect's voices, each bound to its buffer for good
+    struct Pool {
+        std::vector<sf::Sound> voices;
+        std::vector<Slot> slots; // per voice
+    };
+
+    // A voice, as its effect and its place in that effect's pool
+    struct Voice {
+        int sound = -1;
+        std::size_t index = 0;
+
+        bool valid() const { return sound >= 0; }
+    };
+
+    void play(const SoundCue& cue, const AudioListener& listener, const TileMap& map) {
+        const SoundSpec& spec = m_sounds[cue.sound];
+        float gain = spec.volume / 100.0f;
+        float pan = 0.0f;
+        if (spec.buffer) {
+            const double dx = cue.x - listener.x, dy = cue.y - listener.y;
+            const double distance = std::hypot(dx, dy);
+            gain *= static_cast<float>(std::clamp((CLIP_DISTANCE - distance) / (CLIP_DISTANCE - CLOSE_DISTANCE),
+                                                  0.0, 1.0));
+            if (gain >= MIN_GAIN) gain *= std::pow(OCCLUSION_GAIN, occluders(map, listener.x, listener.y, cue.x, cue.y));
+            // The view's right is its direction turned a quarter clockwise
+            if (distance > 1e-6) {
+                const double spread = std::min(1.0, distance / CLOSE_DISTANCE);
+                pan = PAN_SWING * static_cast<float>(spread * (dx * listener.dirY - dy * listener.dirX) / distance);
+            }
+        }
+        if (!spec.buffer || gain < MIN_GAIN) {
+            m_culled++;
+            return;
+        }
+
+        Pool& pool = m_pools[cue.sound];
+        const std::size_t voice = pickVoice(cue.sound, spec.priority, gain);
+        if (voice == pool.voices.size()) {
+            m_dropped++;
+            return;
+        }
+        sf::Sound& sound = pool.voices[voice];
+        sound.stop();
+        sound.setVolume(gain * 100.0f);
+        sound.setPan(pan);
+        sound.play();
+        pool.slots[voice] = {spec.priority, gain, m_order++};
+        m_started++;
+    }
+
+    bool playing(const Voice& voice) const {
+        return m_pools[voice.sound].voices[voice.index].getStatus() != sf::SoundSource::Status::Stopped;
+    }
+
+    const Slot& slot(const Voice& voice) const { return m_pools[voice.sound].slots[voice.index]; }
+
+    // A stopped voice of sound's own while fewer than voices() play. Else
+    // a voice is stolen from the busy ones of lowest priority, then
+    // quietest, then oldest: across every effect when sound has a voice
+    // free, among its own when it has none, and only when the cue matters
+    // at least as much. The index of the voice in sound's pool, or the
+    // pool's size if none.
+    std::size_t pickVoice(int sound, int priority, float gain) {
+        Pool& pool = m_pools[sound];
+        std::size_t free = pool.voices.size();
+        Voice victim;
+        std::size_t busy = 0;
+        for (std::size_t s = 0; s < m_pools.size(); s++) {
+            for (std::size_t i = 0; i < m_pools[s].voices.size(); i++) {
+                const Voice voice{static_cast<int>(s), i};
+                if (!playing(voice)) {
+                    if (static_cast<int>(s) == sound && free == pool.voices.size()) free = i;
+                    continue;
+                }
+                busy++;
+                if (!victim.valid() || less(slot(voice), slot(victim))) victim = voice;
+            }
+        }
+        if (free != pool.voices.size() && busy < m_voiceLimit) return free;
+
+        // Sound's voices are all busy: only one of them can be taken
+        if (free == pool.voices.size()) {
+            victim = {};
+            for (std::size_t i = 0; i < pool.voices.size(); i++) {
+                const Voice voice{sound, i};
+                if (!victim.valid() || less(slot(voice), slot(victim))) victim = voice;
+            }
+        }
+        if (!victim.valid()) return pool.voices.size();
+        const Slot& held = slot(victim);
+        if (held.priority > priority || (held.priority == priority && held.gain > gain)) {
+            return pool.voices.size();
+        }
+        m_stolen++;
+        if (free == pool.voices.size()) return victim.index;
+        m_pools[victim.sound].voices[victim.index].stop();
+        return free;
+    }
+
+    static bool less(const Slot& a, const Slot& b) {
+        if (a.priority != b.priority) return a.priority < b.priority;
+        if (a.gain != b.gain) return a.gain < b.gain;
+        return a.order < b.order;
+    }
+
+    // Wall cells crossed between the cells of the two points, at most
+    // MAX_OCCLUDERS. The walk takes one cell step at a time, so it reaches
+    // the end cell in exactly as many steps as the cells are apart.
+    static int occluders(const TileMap& map, double x0, double y0, double x1, double y1) {
+        int x = static_cast<int>(std::floor(x0)), y = static_cast<int>(std::floor(y0));
+        const int endX = static_cast<int>(std::floor(x1)), endY = static_cast<int>(std::floor(y1));
+        const double dx = x1 - x0, dy = y1 - y0;
+        const int stepX = dx < 0 ? -1 : 1, stepY = dy < 0 ? -1 : 1;
+        const double deltaX = dx != 0 ? std::abs(1 / dx) : 1e30;
+        const double deltaY = dy != 0 ? std::abs(1 / dy) : 1e30;
+        double nextX = (dx < 0 ? x0 - x : x + 1 - x0) * deltaX;
+        double nextY = (dy < 0 ? y0 - y : y + 1 - y0) * deltaY;
+
+        int walls = 0;
+        for (int steps = std::abs(endX - x) + std::abs(endY - y); steps > 1 && walls < MAX_OCCLUDERS; steps--) {
+            if (nextX < nextY) {
+                nextX += deltaX;
+                x += stepX;
+            } else {
+                nextY += deltaY;
+                y += stepY;
+            }
+            if (map.blocks(x, y)) walls++;
+        }
+        return walls;
+    }
+
+    std::vector<SoundSpec> m_sounds;
+    std::vector<Pool> m_pools; // per sound
+    std::size_t m_voiceLimit;
+    std::size_t m_voicesPerSound;
+    sf::Music m_music;
+    std::uint64_t m_order = 0;
+
+    std::size_t m_started = 0;
+    std::size_t m_stolen = 0;
+    std::size_t m_dropped = 0;
+    std::size_t m_culled = 0;
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "worker_pool.hpp"
+
+// ===========================================
+// CELLULAR AUTOMATON
+// Majority smoothing on a two-state grid: with more than threshold of its
+// 8 neighbours live a cell becomes live, with fewer it dies, and at exactly
+// threshold it keeps its state. Cells outside the grid count as live.
+//
+// Both grids keep two preallocated buffers and swap them after each step,
+// and every output row depends only on the rows around it in the previous
+// buffer, so rows are split across the worker pool. CellGrid is one byte
+// per cell with a sliding 3x3 window; BitCellGrid packs 64 cells per word
+// and adds all 8 neighbours of a whole word at once with bit-sliced full
+// adders. Both give identical results.
+// ===========================================
+
+namespace cellular_detail {
+
+// Rows [0, rows) through fn(begin, end), on the pool when there is one
+template <typename Fn>
+void forRows(WorkerPool* workers, int rows, Fn&& fn) {
+    if (workers) {
+        workers->parallelFor(rows, fn);
+    } else {
+        fn(0, rows);
+    }
+}
+
+} // namespace cellular_detail
+
+// One byte per cell, with a 1-cell live border so the window never
+// bounds-checks
+class CellGrid {
+public:
+    CellGrid(int width, int height)
+        : m_width(width), m_height(height), m_stride(width + 2),
+          m_cells(static_cast<std::size_t>(m_stride) * (height + 2), 1),
+          m_next(m_cells.size(), 1) {}
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    bool alive(int x, int y) const { return m_cells[index(x, y)] != 0; }
+    void set(int x, int y, bool live) { m_cells[index(x, y)] = live ? 1 : 0; }
+
+    void step(int threshold, WorkerPool* workers = nullptr) {
+        cellular_detail::forRows(workers, m_height, [&](int begin, int end) {
+            // Column sums of the three rows, then a window of three columns
+            // slid along the row: one add and one subtract per cell
+            std::vector<std::uint8_t> columns(m_stride);
+            for (int y = begin; y < end; y++) {
+                const std::uint8_t* above = &m_cells[index(-1, y - 1)];
+                const std::uint8_t* row = &m_cells[index(-1, y)];
+                const std::uint8_t* below = &m_cells[index(-1, y + 1)];
+                std::uint8_t* out = &m_next[index(0, y)];
+                for (int x = 0; x < m_stride; x++) columns[x] = above[x] + row[x] + below[x];
+
+                int window = columns[0] + columns[1];
+                for (int x = 0; x < m_width; x++) {
+                    window += columns[x + 2];
+                    const int neighbours = window - row[x + 1];
+                    out[x] = neighbours > threshold ? 1 : neighbours < threshold ? 0 : row[x + 1];
+                    window -= columns[x];
+                }
+            }
+        });
+        std::swap(m_cells, m_next);
+    }
+
+private:
+    std::size_t index(int x, int y) const {
+        return static_cast<std::size_t>(y + 1) * m_stride + static_cast<std::size_t>(x + 1);
+    }
+
+    int m_width;
+    int m_height;
+    int m_stride;
+    std::vector<std::uint8_t> m_cells;
+    std::vector<std::uint8_t> m_next;
+};
+
+// One bit per cell, bit x % 64 of word x / 64, with a live row above and
+// below and the unused bits of each row's last word kept live
+class BitCellGrid {
+public:
+    BitCellGrid(int width, int height)
+        : m_width(width), m_height(height), m_words((width + 63) / 64),
+          m_cells(static_cast<std::size_t>(m_words) * (height + 2), ~0ull),
+          m_next(m_cells.size(), ~0ull),
+          m_tailMask(width % 64 == 0 ? 0 : ~0ull << (width % 64)) {}
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    bool alive(int x, int y) const { return (m_cells[word(x, y)] >> (x & 63)) & 1; }
+
+    void set(int x, int y, bool live) {
+        const std::uint64_t bit = 1ull << (x & 63);
+        std::uint64_t& cells = m_cells[word(x, y)];
+        cells = live ? cells | bit : cells & ~bit;
+    }
+
+    void step(int threshold, WorkerPool* workers = nullptr) {
+        cellular_detail::forRows(workers, m_height, [&](int begin, int end) {
+            for (int y = begin; y < end; y++) {
+                const std::uint64_t* above = &m_cells[word(0, y - 1)];
+                const std::uint64_t* row = &m_cells[word(0, y)];
+                const std::uint64_t* below = &m_cells[word(0, y + 1)];
+                std::uint64_t* out = &m_next[word(0, y)];
+                for (int i = 0; i < m_words; i++) {
+                    // Cells past either end of the row are live
+                    const int last = m_words - 1;
+                    auto west = [&](const std::uint64_t* r) {
+                        return (r[i] << 1) | (i > 0 ? r[i - 1] >> 63 : 1ull);
+                    };
+                    auto east = [&](const std::uint64_t* r) {
+                        return (r[i] >> 1) | (i < last ? r[i + 1] << 63 : 1ull << 63);
+                    };
+                    std::uint64_t count[4];
+                    addEight(west(above), above[i], east(above), west(row),
+                             east(row), west(below), below[i], east(below), count);
+
+                    const std::uint64_t more = greaterThan(count, threshold);
+                    const std::uint64_t fewer = ~more & ~equalTo(count, threshold);
+                    std::uint64_t next = more | (row[i] & ~fewer);
+                    if (i == last) next |= m_tailMask;
+                    out[i] = next;
+                }
+            }
+        });
+        std::swap(m_cells, m_next);
+    }
+
+private:
+    static void fullAdd(std::uint64_t a, std::uint64_t b, std::uint64_t c,
+                        std::uint64_t& sum, std::uint64_t& carry) {
+        const std::uint64_t partial = a ^ b;
+        sum = partial ^ c;
+        carry = (a & b) | (partial & c);
+    }
+
+    // Per-bit sum of eight one-bit planes as four bit planes, low first
+    static void addEight(std::uint64_t n0, std::uint64_t n1, std::uint64_t n2, std::uint64_t n3,
+                         std::uint64_t n4, std::uint64_t n5, std::uint64_t n6, std::uint64_t n7,
+                         std::uint64_t count[4]) {
+        std::uint64_t s0, c0, s1, c1, c3, t, c4;
+        fullAdd(n0, n1, n2, s0, c0);
+        fullAdd(n3, n4, n5, s1, c1);
+        const std::uint64_t s2 = n6 ^ n7, c2 = n6 & n7;
+        fullAdd(s0, s1, s2, count[0], c3);
+        fullAdd(c0, c1, c2, t, c4);
+        count[1] = t ^ c3;
+        const std::uint64_t c5 = t & c3;
+        count[2] = c4 ^ c5;
+        count[3] = c4 & c5;
+    }
+
+    // Bits whose 4-bit count is above / equal to the constant k, comparing
+    // from the top bit down
+    static std::uint64_t greaterThan(const std::uint64_t count[4], int k) {
+        std::uint64_t greater = 0, equal = ~0ull;
+        for (int bit = 3; bit >= 0; bit--) {
+            if ((k >> bit) & 1) {
+                equal &= count[bit];
+            } else {
+                greater |= equal & count[bit];
+                equal &= ~count[bit];
+            }
+        }
+        return greater;
+    }
+
+    static std::uint64_t equalTo(const std::uint64_t count[4], int k) {
+        std::uint64_t equal = ~0ull;
+        for (int bit = 0; bit < 4; bit++) equal &= ((k >> bit) & 1) ? count[bit] : ~count[bit];
+        return equal;
+    }
+
+    std::size_t word(int x, int y) const {
+        return static_cast<std::size_t>(y + 1) * m_words + static_cast<std::size_t>(x >> 6);
+    }
+
+    int m_width;
+    int m_height;
+    int m_words;
+    std::vector<std::uint64_t> m_cells;
+    std::vector<std::uint64_t> m_next;
+    std::uint64_t m_tailMask;
+};
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// ===========================================
+// DEMO FILES
+// A session as its starting settings plus one input record per simulation
+// tick, in the spirit of DOOM's .lmp. The simulation only ever sees
+// whole ticks of recorded input, so replaying the tics under the same
+// header rebuilds the session bit for bit.
+//
+// Little-endian layout: "DLMP", u16 version, u16 tick rate, u64 seed,
+// i32 map width, i32 map height, i32 enemy count, u8 flags, u32 tic count,
+// then 3 bytes per tic: the button bits and an i16 mouse delta.
+// ===========================================
+
+namespace DemoButton {
+enum : std::uint8_t {
+    Forward = 1 << 0,
+    Back = 1 << 1,
+    StrafeLeft = 1 << 2,
+    StrafeRight = 1 << 3,
+    TurnLeft = 1 << 4,
+    TurnRight = 1 << 5,
+    Fire = 1 << 6,
+};
+} // namespace DemoButton
+
+struct DemoTic {
+    std::uint8_t buttons = 0;     // DemoButton bits
+    std::int16_t mouseDeltaX = 0; // pixels
+};
+
+// Everything besides the tics that decides how the session plays out
+struct DemoHeader {
+    std::uint16_t tickRate = 0;
+    std::uint64_t seed = 0;
+    std::int32_t mapWidth = 0;
+    std::int32_t mapHeight = 0;
+    std::int32_t enemyCount = 0;
+    bool infinite = false;
+    bool morton = false;
+};
+
+class Demo {
+public:
+    // 2: enemies out of the player's sight no longer act
+    static constexpr std::uint16_t VERSION = 2;
+
+    DemoHeader header;
+    std::vector<DemoTic> tics;
+
+    bool save(const std::filesystem::path& path) const {
+        std::vector<std::uint8_t> bytes;
+        bytes.reserve(HEADER_BYTES + tics.size() * TIC_BYTES);
+        bytes.insert(bytes.end(), MAGIC, MAGIC + 4);
+        put(bytes, VERSION, 2);
+        put(bytes, header.tickRate, 2);
+        put(bytes, header.seed, 8);
+        put(bytes, static_cast<std::uint32_t>(header.mapWidth), 4);
+        put(bytes, static_cast<std::uint32_t>(header.mapHeight), 4);
+        put(bytes, static_cast<std::uint32_t>(header.enemyCount), 4);
+        put(bytes, (header.infinite ? 1u : 0u) | (header.morton ? 2u : 0u), 1);
+        put(bytes, tics.size(), 4);
+        for (const DemoTic& tic : tics) {
+            put(bytes, tic.buttons, 1);
+            put(bytes, static_cast<std::uint16_t>(tic.mouseDeltaX), 2);
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+
+    // False for a missing file, another format or version, or a file cut short
+    bool load(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (bytes.size() < HEADER_BYTES) return false;
+        for (int i = 0; i < 4; i++) {
+            if (bytes[i] != static_cast<std::uint8_t>(MAGIC[i])) return false;
+        }
+
+        std::size_t at = 4;
+        if (get(bytes, at, 2) != VERSION) return false;
+        header.tickRate = static_cast<std::uint16_t>(get(bytes, at, 2));
+        header.seed = get(bytes, at, 8);
+        header.mapWidth = static_cast<std::int32_t>(get(bytes, at, 4));
+        header.mapHeight = static_cast<std::int32_t>(get(bytes, at, 4));
+        header.enemyCount = static_cast<std::int32_t>(get(bytes, at, 4));
+        const std::uint64_t flags = get(bytes, at, 1);
+        header.infinite = (flags & 1) != 0;
+        header.morton = (flags & 2) != 0;
+        const std::uint64_t count = get(bytes, at, 4);
+        if (bytes.size() - HEADER_BYTES < count * TIC_BYTES) return false;
+
+        tics.resize(static_cast<std::size_t>(count));
+        for (DemoTic& tic : tics) {
+            tic.buttons = static_cast<std::uint8_t>(get(bytes, at, 1));
+            tic.mouseDeltaX = static_cast<std::int16_t>(static_cast<std::uint16_t>(get(bytes, at, 2)));
+        }
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[4] = {'D', 'L', 'M', 'P'};
+    static constexpr std::size_t HEADER_BYTES = 4 + 2 + 2 + 8 + 4 * 3 + 1 + 4;
+    static constexpr std::size_t TIC_BYTES = 3;
+
+    static void put(std::vector<std::uint8_t>& bytes, std::uint64_t value, int size) {
+        for (int i = 0; i < size; i++) bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    static std::uint64_t get(const std::vector<std::uint8_t>& bytes, std::size_t& at, int size) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < size; i++) value |= static_cast<std::uint64_t>(bytes[at++]) << (8 * i);
+        return value;
+    }
+};
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tile_map.hpp"
+#include "worker_pool.hpp"
+
+// ===========================================
+// DUNGEON GENERATION
+// Rooms and L-shaped corridors carved out of solid wall. Everything derives
+// from one 64-bit seed through integer-only math, so a seed gives the same
+// map on every compiler, platform and thread count. Big maps are split into
+// chunks that generate independently, each from its own derived seed, and
+// are then stitched together with corridors.
+// ===========================================
+
+// Room for dungeon generation
+struct Room {
+    int x, y, w, h;
+    int centerX() const { return x + w / 2; }
+    int centerY() const { return y + h / 2; }
+};
+
+// Mixes a value into a seed (SplitMix64 finaliser)
+inline std::uint64_t mixSeed(std::uint64_t seed, std::uint64_t value) {
+    std::uint64_t z = seed + 0x9E3779B97F4A7C15ull * (value + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Seed for the chunk at (chunkX, chunkY); any coordinate, negative included
+inline std::uint64_t chunkSeed(std::uint64_t seed, std::int64_t chunkX, std::int64_t chunkY) {
+    return mixSeed(mixSeed(seed, static_cast<std::uint64_t>(chunkX)), static_cast<std::uint64_t>(chunkY));
+}
+
+// SplitMix64 stream. Unlike std::uniform_int_distribution, range() is fully
+// specified here, so sequences match across standard libraries.
+class DungeonRng {
+public:
+    explicit DungeonRng(std::uint64_t seed) : m_state(seed) {}
+
+    std::uint32_t next() {
+        std::uint64_t z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+    }
+
+    // Uniform in [lo, hi], by rejection so there is no modulo bias
+    int range(int lo, int hi) {
+        const std::uint32_t span = static_cast<std::uint32_t>(hi - lo) + 1;
+        if (span == 0) return static_cast<int>(next());
+        const std::uint32_t threshold = (0u - span) % span;
+        std::uint32_t r;
+        do { r = next(); } while (r < threshold);
+        return lo + static_cast<int>(r % span);
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+// Buckets of rooms over a region, so an overlap test only looks at rooms in
+// the buckets the candidate covers
+class RoomIndex {
+public:
+    static constexpr int BucketSize = 16;
+
+    RoomIndex(int x0, int y0, int width, int height)
+        : m_x0(x0), m_y0(y0),
+          m_columns((width + BucketSize - 1) / BucketSize),
+          m_rowsOfBuckets((height + BucketSize - 1) / BucketSize),
+          m_buckets(static_cast<std::size_t>(m_columns) * m_rowsOfBuckets) {}
+
+    // Rooms must keep one tile of wall between them
+    bool overlaps(const Room& candidate, const std::vector<Room>& rooms) const {
+        bool hit = false;
+        forBuckets(candidate, [&](std::size_t bucket) {
+            for (int id : m_buckets[bucket]) {
+                const Room& room = rooms[id];
+                if (!(candidate.x + candidate.w + 1 < room.x || candidate.x > room.x + room.w + 1 ||
+                      candidate.y + candidate.h + 1 < room.y || candidate.y > room.y + room.h + 1)) {
+                    hit = true;
+                    return;
+                }
+            }
+        });
+        return hit;
+    }
+
+    void insert(const Room& room, int id) {
+        forBuckets(room, [&](std::size_t bucket) { m_buckets[bucket].push_back(id); });
+    }
+
+private:
+    // Every bucket touched by the room grown by its 1-tile margin
+    template <typename Fn>
+    void forBuckets(const Room& room, Fn&& fn) const {
+        const int bx0 = std::clamp((room.x - 1 - m_x0) / BucketSize, 0, m_columns - 1);
+        const int bx1 = std::clamp((room.x + room.w + 1 - m_x0) / BucketSize, 0, m_columns - 1);
+        const int by0 = std::clamp((room.y - 1 - m_y0) / BucketSize, 0, m_rowsOfBuckets - 1);
+        const int by1 = std::clamp((room.y + room.h + 1 - m_y0) / BucketSize, 0, m_rowsOfBuckets - 1);
+        for (int by = by0; by <= by1; by++) {
+            for (int bx = bx0; bx <= bx1; bx++) {
+                fn(static_cast<std::size_t>(by) * m_columns + bx);
+            }
+        }
+    }
+
+    int m_x0, m_y0;
+    int m_columns, m_rowsOfBuckets;
+    std::vector<std::vector<int>> m_buckets;
+};
+
+// Carves an L-shaped, 2-wide corridor from (x1, y1) to (x2, y2), staying
+// inside [minX, maxX) x [minY, maxY)
+inline void carveCorridor(TileMap& map, int x1, int y1, int x2, int y2,
+                          int minX, int minY, int maxX, int maxY) {
+    auto carve = [&](int x, int y) {
+        if (x >= minX && x < maxX && y >= minY && y < maxY) map.set(x, y, TileType::Empty);
+    };
+    for (int x = std::min(x1, x2); x <= std::max(x1, x2); x++) {
+        carve(x, y1);
+        carve(x, y1 + 1);
+    }
+    for (int y = std::min(y1, y2); y <= std::max(y1, y2); y++) {
+        carve(x2, y);
+        carve(x2 + 1, y);
+    }
+}
+
+// Rooms and corridors inside the region [x0, x0 + width) x [y0, y0 + height)
+// only, so regions can be generated concurrently. Rooms keep 2 tiles from
+// the region edge. The region is reset to wall first.
+inline void generateRegion(TileMap& map, int x0, int y0, int width, int height,
+                           std::uint64_t seed, std::vector<Room>& rooms) {
+    DungeonRng rng(seed);
+    RoomIndex index(x0, y0, width, height);
+    for (int y = y0; y < y0 + height; y++) {
+        for (int x = x0; x < x0 + width; x++) map.set(x, y, TileType::Wall);
+    }
+
+    // 20-30 rooms per 64x64 of area, so bigger regions keep the same density
+    constexpr int REFERENCE_AREA = 64 * 64;
+    const int areaScale = std::max(1, (width * height) / REFERENCE_AREA);
+    const int numRooms = rng.range(20, 30) * areaScale;
+
+    const std::size_t first = rooms.size();
+    for (int i = 0; i < numRooms * 3; i++) {
+        int w = rng.range(5, 12);
+        int h = rng.range(5, 12);
+        if (width - w - 4 < 0 || height - h - 4 < 0) continue;
+        Room room{rng.range(x0 + 2, x0 + width - w - 2), rng.range(y0 + 2, y0 + height - h - 2), w, h};
+
+        if (index.overlaps(room, rooms)) continue;
+        index.insert(room, static_cast<int>(rooms.size()));
+        rooms.push_back(room);
+        for (int ry = room.y; ry < room.y + room.h; ry++) {
+            for (int rx = room.x; rx < room.x + room.w; rx++) {
+                map.set(rx, ry, TileType::Empty);
+            }
+        }
+
+        if (rooms.size() - first >= static_cast<std::size_t>(numRooms)) break;
+    }
+
+    // Connect rooms
+    for (std::size_t i = first + 1; i < rooms.size(); i++) {
+        carveCorridor(map, rooms[i - 1].centerX(), rooms[i - 1].centerY(), rooms[i].centerX(), rooms[i].centerY(),
+                      x0, y0, x0 + width, y0 + height);
+    }
+}
+
+// Side of the square chunks big maps are split into; maps up to this size
+// on both axes are one chunk
+constexpr int DUNGEON_CHUNK_SIZE = 128;
+
+// Fills map with a dungeon that depends only on the map size and seed. With
+// workers, chunks are generated in parallel; the result is identical.
+inline void generateDungeon(TileMap& map, std::vector<Room>& rooms, std::uint64_t seed,
+                            WorkerPool* workers = nullptr) {
+    rooms.clear();
+
+    const int chunksX = std::max(1, map.width() / DUNGEON_CHUNK_SIZE);
+    const int chunksY = std::max(1, map.height() / DUNGEON_CHUNK_SIZE);
+    const int chunkCount = chunksX * chunksY;
+    auto chunkX0 = [&](int cx) { return map.width() * cx / chunksX; };
+    auto chunkY0 = [&](int cy) { return map.height() * cy / chunksY; };
+
+    // Chunks write disjoint cells, and rooms are kept per chunk so the
+    // final order does not depend on scheduling
+    std::vector<std::vector<Room>> chunkRooms(chunkCount);
+    auto generateChunks = [&](int begin, int end) {
+        for (int chunk = begin; chunk < end; chunk++) {
+            int cx = chunk % chunksX, cy = chunk / chunksX;
+            int x0 = chunkX0(cx), y0 = chunkY0(cy);
+            generateRegion(map, x0, y0, chunkX0(cx + 1) - x0, chunkY0(cy + 1) - y0,
+                           chunkSeed(seed, cx, cy), chunkRooms[chunk]);
+        }
+    };
+    if (workers) {
+        workers->parallelFor(chunkCount, generateChunks);
+    } else {
+        generateChunks(0, chunkCount);
+    }
+
+    // Stitch each chunk to its right and lower neighbours through their
+    // first rooms. Carving only ever opens cells, so the order is free.
+    for (int cy = 0; cy < chunksY; cy++) {
+        for (int cx = 0; cx < chunksX; cx++) {
+            const auto& here = chunkRooms[cy * chunksX + cx];
+            if (here.empty()) continue;
+            for (int neighbour : {cx + 1 < chunksX ? cy * chunksX + cx + 1 : -1,
+                                  cy + 1 < chunksY ? (cy + 1) * chunksX + cx : -1}) {
+                if (neighbour < 0 || chunkRooms[neighbour].empty()) continue;
+                const Room& a = here.front();
+                const Room& b = chunkRooms[neighbour].front();
+                carveCorridor(map, a.centerX(), a.centerY(), b.centerX(), b.centerY(),
+                              0, 0, map.width(), map.height());
+            }
+        }
+    }
+
+    for (auto& list : chunkRooms) rooms.insert(rooms.end(), list.begin(), list.end());
+}
+
+// Where the corridor crosses the edge between chunk (chunkX, chunkY) and
+// its east (axis 0) or south (axis 1) neighbour, as an offset along the edge
+inline int chunkDoor(std::uint64_t seed, std::int64_t chunkX, std::int64_t chunkY, int axis, int size) {
+    DungeonRng rng(mixSeed(chunkSeed(seed, chunkX, chunkY), 2 + static_cast<std::uint64_t>(axis)));
+    return rng.range(2, size - 4);
+}
+
+// One chunk of an unbounded world into [0, size) x [0, size) of map. Every
+// edge gets a corridor at a door position both chunks on that edge derive
+// from the seed, so neighbours line up without seeing each other.
+inline void generateChunk(TileMap& map, int size, std::uint64_t seed,
+                          std::int64_t chunkX, std::int64_t chunkY, std::vector<Room>& rooms) {
+    rooms.clear();
+    generateRegion(map, 0, 0, size, size, chunkSeed(seed, chunkX, chunkY), rooms);
+
+    const int hubX = rooms.empty() ? size / 2 : rooms.front().centerX();
+    const int hubY = rooms.empty() ? size / 2 : rooms.front().centerY();
+    const int east = chunkDoor(seed, chunkX, chunkY, 0, size);
+    const int west = chunkDoor(seed, chunkX - 1, chunkY, 0, size);
+    const int south = chunkDoor(seed, chunkX, chunkY, 1, size);
+    const int north = chunkDoor(seed, chunkX, chunkY - 1, 1, size);
+    // Horizontal legs run along the door row, vertical legs down the door
+    // column, so each corridor reaches its edge before being clipped
+    carveCorridor(map, size, east, hubX, hubY, 0, 0, size, size);
+    carveCorridor(map, -1, west, hubX, hubY, 0, 0, size, size);
+    carveCorridor(map, hubX, hubY, south, size, 0, 0, size, size);
+    carveCorridor(map, hubX, hubY, north, -1, 0, 0, size, size);
+}
+
+// Random empty tile at least 2 tiles from the map edge, drawn from rng
+inline bool findEmptySpot(const TileMap& map, DungeonRng& rng, int& x, int& y) {
+    for (int attempts = 0; attempts < 100; attempts++) {
+        x = rng.range(2, map.width() - 3);
+        y = rng.range(2, map.height() - 3);
+
+        if (map.at(x, y) == TileType::Empty) {
+            return true;
+        }
+    }
+    return false;
+}
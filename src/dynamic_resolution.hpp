@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// ===========================================
+// DYNAMIC RESOLUTION
+// Picks the internal render size from recent frame times. The size moves
+// along a ladder of column counts, from the full width down to minScale
+// of it, with rows following to keep the aspect ratio. When the average
+// frame is over budget, it drops as many rungs as the overrun calls for,
+// assuming cost scales with pixel count. When frames have clear headroom,
+// it climbs one rung. A decision waits for a full window of frames after
+// the previous one, so a single spike, or the slow frame right after a
+// change, cannot make it oscillate.
+// ===========================================
+
+class ResolutionController {
+public:
+    static constexpr int WINDOW = 30;          // frames averaged per decision
+    static constexpr int STEPS = 16;           // rungs from full width to zero
+    static constexpr double DROP_ABOVE = 0.95; // of the budget
+    static constexpr double RAISE_BELOW = 0.70;
+    static constexpr unsigned int ALIGN = 8;   // column counts stay multiples of this
+
+    ResolutionController(unsigned int maxWidth, unsigned int maxHeight, double budgetMs, double minScale = 0.5)
+        : m_maxWidth(maxWidth), m_maxHeight(maxHeight), m_budgetMs(budgetMs),
+          m_minStep(std::clamp(static_cast<int>(std::ceil(minScale * STEPS)), 1, STEPS)) {}
+
+    // One frame's time; true when the size changed
+    bool update(double frameMs) {
+        m_frames[m_count++] = frameMs;
+        if (m_count < WINDOW) return false;
+        m_count = 0;
+
+        double total = 0;
+        for (double ms : m_frames) total += ms;
+        const double average = total / WINDOW;
+
+        int step = m_step;
+        if (average > m_budgetMs * DROP_ABOVE) {
+            // Pixels scale with the square of the step; aim between the two
+            // thresholds so the next window settles instead of climbing back
+            const double fit = std::sqrt(m_budgetMs * (DROP_ABOVE + RAISE_BELOW) / 2 / average);
+            step = std::min(m_step - 1, static_cast<int>(std::floor(m_step * fit)));
+        } else if (average < m_budgetMs * RAISE_BELOW) {
+            step = m_step + 1;
+        }
+        step = std::clamp(step, m_minStep, STEPS);
+        if (step == m_step) return false;
+        m_step = step;
+        m_changes++;
+        return true;
+    }
+
+    unsigned int width() const {
+        const unsigned int columns = m_maxWidth * m_step / STEPS;
+        return std::clamp(columns / ALIGN * ALIGN, std::min(ALIGN, m_maxWidth), m_maxWidth);
+    }
+
+    unsigned int height() const {
+        return std::max(1u, static_cast<unsigned int>(std::lround(static_cast<double>(m_maxHeight) * width() / m_maxWidth)));
+    }
+
+    double scale() const { return static_cast<double>(m_step) / STEPS; }
+    double budgetMs() const { return m_budgetMs; }
+    std::size_t changes() const { return m_changes; }
+
+private:
+    unsigned int m_maxWidth;
+    unsigned int m_maxHeight;
+    double m_budgetMs;
+    int m_minStep;
+    int m_step = STEPS;
+    std::array<double, WINDOW> m_frames{};
+    int m_count = 0;
+    std::size_t m_changes = 0;
+};
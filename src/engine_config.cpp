@@ -0,0 +1,179 @@
+#include "engine_config.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+EngineConfig parseConfig(int argc, char* argv[]) {
+    EngineConfig config;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--software") == 0) {
+            config.renderMode = RenderMode::Software;
+        } else if (std::strcmp(argv[i], "--batched") == 0) {
+            config.renderMode = RenderMode::Batched;
+        } else if (std::strcmp(argv[i], "--shapes") == 0) {
+            config.renderMode = RenderMode::Shapes;
+        } else if (std::strcmp(argv[i], "--simd") == 0) {
+            config.rayIsa = bestRayIsa();
+        } else if (std::strncmp(argv[i], "--simd=", 7) == 0) {
+            const char* name = argv[i] + 7;
+            RayIsa requested = RayIsa::Scalar;
+            for (RayIsa isa : {RayIsa::SSE2, RayIsa::AVX2, RayIsa::NEON}) {
+                if (std::strcmp(name, rayIsaName(isa)) == 0) requested = isa;
+            }
+            if (!rayIsaSupported(requested)) {
+                std::cerr << "SIMD path " << name << " not available, using scalar\n";
+                requested = RayIsa::Scalar;
+            }
+            config.rayIsa = requested;
+        } else if (std::strcmp(argv[i], "--dda-bench") == 0) {
+            config.ddaBench = true;
+        } else if (std::strcmp(argv[i], "--flow-bench") == 0) {
+            config.flowBench = true;
+        } else if (std::strcmp(argv[i], "--gen-bench") == 0) {
+            config.genBench = true;
+        } else if (std::strcmp(argv[i], "--bench") == 0) {
+            config.bench = true;
+        } else if (std::strcmp(argv[i], "--bench-frames") == 0 && i + 1 < argc) {
+            config.benchFrames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            config.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--playdemo") == 0 && i + 1 < argc) {
+            config.demoPath = argv[++i];
+            config.timedemo = false;
+        } else if ((std::strcmp(argv[i], "--timedemo") == 0 || std::strcmp(argv[i], "-timedemo") == 0) &&
+                   i + 1 < argc) {
+            config.demoPath = argv[++i];
+            config.timedemo = true;
+        } else if (std::strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            config.loadPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--save-level") == 0 && i + 1 < argc) {
+            config.saveLevelPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--quicksave") == 0 && i + 1 < argc) {
+            config.quickSavePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--host") == 0 && i + 1 < argc) {
+            config.hostPort = static_cast<unsigned short>(std::clamp(std::atoi(argv[++i]), 1, 65535));
+            config.players = std::max(config.players, 2);
+        } else if (std::strcmp(argv[i], "--join") == 0 && i + 1 < argc) {
+            config.joinAddress = argv[++i];
+        } else if (std::strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            config.players = std::clamp(std::atoi(argv[++i]), 2, MAX_PLAYERS);
+        } else if (std::strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            config.inputDelay = std::clamp(std::atoi(argv[++i]), 1, 16);
+        } else if (std::strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            config.tickRate = std::clamp(std::atoi(argv[++i]), MIN_TICK_RATE, MAX_TICK_RATE);
+        } else if (std::strcmp(argv[i], "--vsync") == 0) {
+            config.pacing = FramePacing::VSync;
+        } else if (std::strcmp(argv[i], "--uncapped") == 0) {
+            config.pacing = FramePacing::Uncapped;
+        } else if (std::strcmp(argv[i], "--fps-cap") == 0 && i + 1 < argc) {
+            config.pacing = FramePacing::Capped;
+            config.frameCap = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--resolution") == 0 && i + 1 < argc) {
+            // WIDTHxHEIGHT, e.g. 3840x2160
+            unsigned int width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%ux%u", &width, &height) == 2 && width >= 320 && height >= 200) {
+                config.screenWidth = width;
+                config.screenHeight = height;
+            } else {
+                std::cerr << "Ignoring bad resolution " << argv[i] << "\n";
+            }
+        } else if (std::strcmp(argv[i], "--render-scale") == 0 && i + 1 < argc) {
+            config.renderScale = std::clamp(static_cast<float>(std::atof(argv[++i])), 0.25f, 1.0f);
+        } else if (std::strcmp(argv[i], "--upscale") == 0 && i + 1 < argc) {
+            const char* filter = argv[++i];
+            if (std::strcmp(filter, "bilinear") == 0) {
+                config.upscale = UpscaleFilter::Bilinear;
+            } else if (std::strcmp(filter, "nearest") == 0) {
+                config.upscale = UpscaleFilter::Nearest;
+            } else {
+                std::cerr << "Ignoring unknown upscale filter " << filter << "\n";
+            }
+        } else if (std::strcmp(argv[i], "--dynamic-res") == 0 && i + 1 < argc) {
+            // Target frame rate, e.g. 60 or 144
+            config.targetFps = static_cast<unsigned int>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--interlace") == 0) {
+            config.interlace = true;
+        } else if (std::strcmp(argv[i], "--atlas-cache") == 0 && i + 1 < argc) {
+            config.atlasCache = argv[++i];
+        } else if (std::strcmp(argv[i], "--no-atlas-cache") == 0) {
+            config.atlasCache.clear();
+        } else if (std::strcmp(argv[i], "--no-audio") == 0) {
+            config.audio = false;
+        } else if (std::strcmp(argv[i], "--no-music") == 0) {
+            config.music = false;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.workerThreads = static_cast<unsigned int>(std::max(0, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--map-size") == 0 && i + 1 < argc) {
+            // Rooms need at least 32 cells of span; Morton indices cover 16 bits
+            int size = std::clamp(std::atoi(argv[++i]), 32, 4096);
+            config.mapWidth = size;
+            config.mapHeight = size;
+        } else if (std::strcmp(argv[i], "--enemies") == 0 && i + 1 < argc) {
+            config.enemyCount = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--morton") == 0) {
+            config.mapLayout = TileLayout::Morton;
+        } else if (std::strcmp(argv[i], "--infinite") == 0) {
+            config.infinite = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            config.profileOverlay = true;
+        } else if (std::strcmp(argv[i], "--profile-csv") == 0 && i + 1 < argc) {
+            config.profilePath = argv[++i];
+            config.profileFormat = ProfileFormat::Csv;
+        } else if (std::strcmp(argv[i], "--profile-trace") == 0 && i + 1 < argc) {
+            config.profilePath = argv[++i];
+            config.profileFormat = ProfileFormat::ChromeTrace;
+        } else {
+            std::cerr << "Ignoring unknown option " << argv[i] << "\n";
+        }
+    }
+    
+    if (!config.demoPath.empty() && !config.recordPath.empty()) {
+        std::cerr << "Cannot record while playing a demo, not recording\n";
+        config.recordPath.clear();
+    }
+    
+    // Demos start from their seed, so they cannot start from a save
+    if (!config.loadPath.empty() && (!config.demoPath.empty() || !config.recordPath.empty())) {
+        std::cerr << "Cannot start a demo from a save, generating instead\n";
+        config.loadPath.clear();
+    }
+    
+    // Net games play their own inputs, on a level every peer generates
+    const bool netGame = config.hostPort != 0 || !config.joinAddress.empty();
+    if (config.hostPort != 0 && !config.joinAddress.empty()) {
+        std::cerr << "Cannot host and join at once, hosting\n";
+        config.joinAddress.clear();
+    }
+    if (netGame && (!config.demoPath.empty() || !config.recordPath.empty() || !config.loadPath.empty())) {
+        std::cerr << "Demos and saves play offline, ignoring them in a net game\n";
+        config.demoPath.clear();
+        config.recordPath.clear();
+        config.loadPath.clear();
+    }
+    if (netGame && config.infinite) {
+        std::cerr << "Streamed worlds play offline, generating a fixed map\n";
+        config.infinite = false;
+    }
+    if (!netGame) config.players = 1;
+    
+    // The packet kernels index rows directly
+    if (config.mapLayout == TileLayout::Morton && config.rayIsa != RayIsa::Scalar) {
+        std::cerr << "SIMD DDA needs a row-major map, using scalar\n";
+        config.rayIsa = RayIsa::Scalar;
+    }
+    return config;
+}
+
+const char* renderModeName(RenderMode mode) {
+    switch (mode) {
+        case RenderMode::Batched: return "batched vertex arrays";
+        case RenderMode::Software: return "software framebuffer";
+        case RenderMode::Shapes: return "RectangleShape columns";
+    }
+    return "unknown";
+}
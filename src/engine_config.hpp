@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <string>
+
+#include "profiler.hpp"
+#include "ray_packet.hpp"
+#include "tile_map.hpp"
+
+// ===========================================
+// ENGINE CONFIG
+// Runtime options every front end parses the same way. The engine library
+// (generation, simulation, assets and the renderer backends) is built
+// once, and each front end is a main() over it that picks what to show.
+// ===========================================
+
+constexpr unsigned int SCREEN_WIDTH = 1280;
+constexpr unsigned int SCREEN_HEIGHT = 720;
+constexpr int MAP_WIDTH = 64;   // default, see --map-size
+constexpr int MAP_HEIGHT = 64;
+
+// The world advances in fixed ticks of 1 / tickRate seconds (DOOM ran 35)
+// and frames draw between the last two; a slow frame runs several ticks,
+// up to the cap
+constexpr int DEFAULT_TICK_RATE = 60;
+constexpr int MIN_TICK_RATE = 20;
+constexpr int MAX_TICK_RATE = 240;
+constexpr int MAX_SIM_STEPS = 12;
+
+// Player slots a session holds; a net game's peers each take one
+constexpr int MAX_PLAYERS = 4;
+
+// Net games: ticks between sampling input and playing it
+constexpr int DEFAULT_INPUT_DELAY = 3;
+
+// How often frames are presented: at the display's refresh, at a fixed
+// cap, or as fast as they can be drawn
+enum class FramePacing { VSync, Capped, Uncapped };
+
+// The renderer backend, see raycast_renderer.hpp. Batched: walls as one
+// VertexArray draw. Software: walls rasterized on the CPU into a
+// Framebuffer and uploaded once per frame. Shapes: one RectangleShape per
+// wall column and sprite run, the slowest and simplest way SFML draws.
+enum class RenderMode { Batched, Software, Shapes };
+
+// How the internal render resolution is scaled up to the window
+enum class UpscaleFilter { Nearest, Bilinear };
+
+// Runtime options, parsed from the command line
+struct EngineConfig {
+    RenderMode renderMode = RenderMode::Batched;
+    unsigned int screenWidth = SCREEN_WIDTH;   // window and view, see --resolution
+    unsigned int screenHeight = SCREEN_HEIGHT;
+    float renderScale = 1.0f;        // internal resolution over the window's, see --render-scale
+    UpscaleFilter upscale = UpscaleFilter::Nearest;
+    unsigned int targetFps = 0;      // dynamic resolution keeps frames inside 1 / targetFps; 0 = off
+    bool interlace = false;          // cast half the columns per frame, see InterlacedCaster
+    std::filesystem::path atlasCache = "cache"; // packed sprite atlas, empty = repack every start
+    bool audio = true;               // effects and music, see AudioEngine
+    bool music = true;
+    unsigned int workerThreads = 0; // 0 = one per hardware thread
+    RayIsa rayIsa = RayIsa::Scalar;  // packet DDA kernel, Scalar = off
+    bool ddaBench = false;           // headless SIMD check + rays/sec report
+    int mapWidth = MAP_WIDTH;
+    int mapHeight = MAP_HEIGHT;
+    TileLayout mapLayout = TileLayout::RowMajor;
+    int enemyCount = 15;             // raise for horde mode
+    bool flowBench = false;          // headless pathing benchmark
+    bool genBench = false;           // headless generation benchmark
+    bool infinite = false;           // streamed chunks instead of one map
+    std::uint64_t seed = static_cast<std::uint64_t>(std::time(nullptr));
+    bool profileOverlay = false;     // F3 toggles it in game
+    std::filesystem::path profilePath; // per-frame capture, empty = none
+    ProfileFormat profileFormat = ProfileFormat::Csv;
+    bool bench = false;              // headless scenario benchmark
+    int benchFrames = 600;           // per scenario
+    std::filesystem::path recordPath; // demo to write, empty = none
+    std::filesystem::path demoPath;  // demo to play back, empty = none
+    std::filesystem::path loadPath;  // save to start from instead of generating, empty = none
+    std::filesystem::path saveLevelPath; // written once the level is made, empty = none
+    std::filesystem::path quickSavePath = "quicksave.sav"; // F5 writes it, F9 reads it
+    bool timedemo = false;           // play demoPath one tick per frame, uncapped
+    unsigned short hostPort = 0;     // serve a net game on this UDP port, 0 = not hosting
+    std::string joinAddress;         // the host[:port] of a net game to join, empty = not joining
+    int players = 1;                 // in the session, the local one included; see LockstepSession
+    int inputDelay = DEFAULT_INPUT_DELAY; // ticks, in a hosted game
+    int tickRate = DEFAULT_TICK_RATE; // simulation ticks per second
+    FramePacing pacing = FramePacing::VSync;
+    unsigned int frameCap = 60;      // for FramePacing::Capped
+};
+
+// Unknown options and ones that cannot be combined are reported and
+// dropped, so the result is always playable
+EngineConfig parseConfig(int argc, char* argv[]);
+
+const char* renderModeName(RenderMode mode);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#define ENTITY_RESTRICT __restrict
+#else
+#define ENTITY_RESTRICT __restrict__
+#endif
+
+// ===========================================
+// ENTITY STORE
+// Helpers for struct-of-arrays entity storage. Each field is its own
+// contiguous column, and the update kernels below are branch-free loops
+// over plain pointers with no aliasing, so the compiler vectorises them.
+// Timers count down a float "time remaining" per entity, advanced by the
+// fixed simulation step, instead of querying a clock per entity.
+// ===========================================
+
+// position[i] += velocity[i] * dt
+inline void integrate(double* ENTITY_RESTRICT position, const double* ENTITY_RESTRICT velocity,
+                      std::size_t count, double dt) {
+    for (std::size_t i = 0; i < count; i++) {
+        position[i] += velocity[i] * dt;
+    }
+}
+
+// value[i] = max(value[i], floor)
+inline void clampBelow(double* ENTITY_RESTRICT value, std::size_t count, double floor) {
+    for (std::size_t i = 0; i < count; i++) {
+        value[i] = value[i] < floor ? floor : value[i];
+    }
+}
+
+// Counts every timer down by dt and stops it at zero
+inline void tickTimers(float* ENTITY_RESTRICT timeLeft, std::size_t count, float dt) {
+    for (std::size_t i = 0; i < count; i++) {
+        float t = timeLeft[i] - dt;
+        timeLeft[i] = t > 0.0f ? t : 0.0f;
+    }
+}
+
+// Occupancy of a fixed-capacity store, reported so capacities can be tuned
+struct PoolPressure {
+    std::size_t capacity = 0;
+    std::size_t peak = 0;    // most rows live at once
+    std::size_t dropped = 0; // spawns refused because the store was full
+
+    // Call before adding a row to a store holding live rows
+    bool admit(std::size_t live) {
+        if (live >= capacity) {
+            dropped++;
+            return false;
+        }
+        peak = live + 1 > peak ? live + 1 : peak;
+        return true;
+    }
+};
+
+// Reserves capacity rows in every column so adds never reallocate
+template <typename... Columns>
+void reserveColumns(std::size_t capacity, Columns&... columns) {
+    (columns.reserve(capacity), ...);
+}
+
+// Empties every column; the reserved capacity stays
+template <typename... Columns>
+void clearColumns(Columns&... columns) {
+    (columns.clear(), ...);
+}
+
+// O(1) removal: the last row moves into row and every column shrinks by
+// one, so live rows stay the dense prefix. Row order is not preserved.
+template <typename... Columns>
+void swapRemove(std::size_t row, Columns&... columns) {
+    ((columns[row] = columns.back(), columns.pop_back()), ...);
+}
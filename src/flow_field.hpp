@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tile_map.hpp"
+
+// ===========================================
+// FLOW FIELD
+// One breadth-first search from the target tile gives every reachable open
+// tile its step count to the target, with 8-way moves that never cut a wall
+// corner. Any number of agents then steer by looking at the 8 neighbours of
+// their own tile, so pathing cost is one BFS per target move, independent of
+// how many agents follow it. With several targets the search starts from
+// all of them at once, and agents head for whichever is fewest steps away.
+// ===========================================
+
+struct FlowTarget {
+    int x, y;
+};
+
+class FlowField {
+public:
+    static constexpr std::uint32_t Unreached = 0xFFFFFFFFu;
+
+    FlowField(int width, int height)
+        : m_width(width), m_height(height),
+          m_cells(static_cast<std::size_t>(width) * height),
+          m_queue(static_cast<std::size_t>(width) * height) {}
+
+    // BFS from the target out to maxSteps (0 = no limit). Does nothing and
+    // returns false when the target and limit are unchanged. Cells are
+    // invalidated by bumping a generation counter, so a limited rebuild only
+    // touches the cells it reaches. map needs a wall border of at least 1.
+    bool build(const TileMap& map, int targetX, int targetY, std::uint32_t maxSteps = 0) {
+        const FlowTarget target{targetX, targetY};
+        return build(map, &target, 1, maxSteps);
+    }
+
+    // As above, from count targets at once; a target in a wall or off the
+    // map is left out
+    bool build(const TileMap& map, const FlowTarget* targets, std::size_t count, std::uint32_t maxSteps = 0) {
+        if (!m_stale && maxSteps == m_maxSteps &&
+            std::equal(targets, targets + count, m_targets.begin(), m_targets.end(),
+                       [](const FlowTarget& a, const FlowTarget& b) { return a.x == b.x && a.y == b.y; })) {
+            return false;
+        }
+        m_stale = false;
+        m_targets.assign(targets, targets + count);
+        m_maxSteps = maxSteps;
+        if (++m_generation == 0) {
+            for (auto& cell : m_cells) cell.generation = 0;
+            m_generation = 1;
+        }
+        m_reached = 0;
+
+        std::size_t head = 0, tail = 0;
+        for (const FlowTarget& target : m_targets) {
+            if (!map.contains(target.x, target.y) || map.isWall(target.x, target.y)) continue;
+            const std::uint32_t cell = index(target.x, target.y);
+            if (m_cells[cell].generation == m_generation) continue;
+            visit(cell, 0);
+            m_queue[tail++] = cell;
+        }
+
+        while (head < tail) {
+            const std::uint32_t current = m_queue[head++];
+            const std::uint32_t steps = m_cells[current].distance;
+            if (maxSteps != 0 && steps >= maxSteps) continue;
+
+            const int cx = static_cast<int>(current % m_width);
+            const int cy = static_cast<int>(current / m_width);
+            for (const auto& offset : NEIGHBOURS) {
+                const int nx = cx + offset[0];
+                const int ny = cy + offset[1];
+                if (map.isWall(nx, ny)) continue;
+                if (offset[0] != 0 && offset[1] != 0 &&
+                    (map.isWall(nx, cy) || map.isWall(cx, ny))) continue;
+
+                const std::uint32_t next = index(nx, ny);
+                if (m_cells[next].generation == m_generation) continue;
+                visit(next, steps + 1);
+                m_queue[tail++] = next;
+            }
+        }
+        return true;
+    }
+
+    // Steps from (x, y) to the nearest target, or Unreached
+    std::uint32_t distance(int x, int y) const {
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height) return Unreached;
+        const Cell& cell = m_cells[index(x, y)];
+        return cell.generation == m_generation ? cell.distance : Unreached;
+    }
+
+    // Unit direction from (x, y) towards the centre of the neighbouring tile
+    // one step closer to the nearest target. False on a target tile and on
+    // tiles the field does not reach.
+    bool steer(double x, double y, double& dirX, double& dirY) const {
+        const int cx = static_cast<int>(std::floor(x));
+        const int cy = static_cast<int>(std::floor(y));
+        std::uint32_t best = distance(cx, cy);
+        if (best == Unreached || best == 0) return false;
+
+        int bestX = cx, bestY = cy;
+        for (const auto& offset : NEIGHBOURS) {
+            const int nx = cx + offset[0];
+            const int ny = cy + offset[1];
+            const std::uint32_t steps = distance(nx, ny);
+            if (steps >= best) continue;
+            // Same no-corner-cutting rule as the search
+            if (offset[0] != 0 && offset[1] != 0 &&
+                (distance(nx, cy) == Unreached || distance(cx, ny) == Unreached)) continue;
+            best = steps;
+            bestX = nx;
+            bestY = ny;
+        }
+        if (bestX == cx && bestY == cy) return false;
+
+        const double dx = bestX + 0.5 - x;
+        const double dy = bestY + 0.5 - y;
+        const double length = std::sqrt(dx * dx + dy * dy);
+        if (length <= 0) return false;
+        dirX = dx / length;
+        dirY = dy / length;
+        return true;
+    }
+
+    // Makes the next build search again even for the same target, after
+    // the map changed under the field
+    void invalidate() { m_stale = true; }
+
+    std::size_t reachedCells() const { return m_reached; }
+
+private:
+    struct Cell {
+        std::uint32_t generation = 0;
+        std::uint32_t distance = 0;
+    };
+
+    static constexpr int NEIGHBOURS[8][2] = {
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}
+    };
+
+    std::uint32_t index(int x, int y) const {
+        return static_cast<std::uint32_t>(y) * static_cast<std::uint32_t>(m_width) + static_cast<std::uint32_t>(x);
+    }
+
+    void visit(std::uint32_t cell, std::uint32_t steps) {
+        m_cells[cell].generation = m_generation;
+        m_cells[cell].distance = steps;
+        m_reached++;
+    }
+
+    int m_width;
+    int m_height;
+    std::vector<Cell> m_cells;
+    std::vector<std::uint32_t> m_queue;
+    std::uint32_t m_generation = 0;
+    bool m_stale = true;
+    std::vector<FlowTarget> m_targets;
+    std::uint32_t m_maxSteps = 0;
+    std::size_t m_reached = 0;
+};
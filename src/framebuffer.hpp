@@ -0,0 +1,144 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <cstring>
+#include <memory>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FRAMEBUFFER_SSE2 1
+#endif
+
+// ===========================================
+// SOFTWARE FRAMEBUFFER
+// Persistent RGBA8 pixel store written directly by the renderer and
+// uploaded to the GPU once per frame with sf::Texture::update.
+//
+// Storage is allocated once at its full size. A smaller viewport in its
+// top-left corner can be drawn instead, so the render resolution can
+// change without reallocating; rows stay stride() pixels apart.
+// ===========================================
+
+// Packs a colour in the byte order sf::Texture::update expects (R, G, B, A in
+// memory), independent of host endianness.
+inline std::uint32_t packRGBA(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a = 255) {
+    const std::uint8_t bytes[4] = {r, g, b, a};
+    std::uint32_t pixel;
+    std::memcpy(&pixel, bytes, sizeof(pixel));
+    return pixel;
+}
+
+inline std::uint32_t packRGBA(sf::Color color) {
+    return packRGBA(color.r, color.g, color.b, color.a);
+}
+
+// Fills count pixels starting at dst. The SSE2 path writes 64 bytes per
+// iteration; std::fill_n handles the unaligned head and the tail.
+inline void fillPixels(std::uint32_t* dst, std::size_t count, std::uint32_t color) {
+#ifdef FRAMEBUFFER_SSE2
+    while (count > 0 && (reinterpret_cast<std::uintptr_t>(dst) & 15) != 0) {
+        *dst++ = color;
+        count--;
+    }
+    const __m128i wide = _mm_set1_epi32(static_cast<int>(color));
+    for (; count >= 16; count -= 16, dst += 16) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst), wide);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst + 4), wide);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst + 8), wide);
+        _mm_store_si128(reinterpret_cast<__m128i*>(dst + 12), wide);
+    }
+#endif
+    std::fill_n(dst, count, color);
+}
+
+class Framebuffer {
+public:
+    // Row storage starts on a cache line so whole-row clears stay aligned
+    static constexpr std::size_t Alignment = 64;
+
+    Framebuffer(unsigned int width, unsigned int height)
+        : m_width(width), m_height(height), m_stride(width), m_rows(height),
+          m_pixels(allocate(static_cast<std::size_t>(width) * height)) {
+        fillPixels(m_pixels.get(), pixelCount(), packRGBA(0, 0, 0));
+        if (!m_texture.resize({width, height})) {
+            throw std::bad_alloc();
+        }
+    }
+
+    // Viewport size; the storage is stride() x capacityHeight()
+    unsigned int width() const { return m_width; }
+    unsigned int height() const { return m_height; }
+    unsigned int stride() const { return m_stride; }
+    unsigned int capacityHeight() const { return m_rows; }
+    std::size_t pixelCount() const { return static_cast<std::size_t>(m_stride) * m_rows; }
+
+    // Clamped to the allocated size
+    void setViewport(unsigned int width, unsigned int height) {
+        m_width = std::min(width, m_stride);
+        m_height = std::min(height, m_rows);
+    }
+
+    std::uint32_t* data() { return m_pixels.get(); }
+    const std::uint32_t* data() const { return m_pixels.get(); }
+    std::uint32_t* row(unsigned int y) { return m_pixels.get() + static_cast<std::size_t>(y) * m_stride; }
+
+    std::uint32_t& at(unsigned int x, unsigned int y) { return row(y)[x]; }
+
+    // Over the full width, rows [yStart, yEnd) are contiguous, so a clear is
+    // one linear fill; a narrower viewport fills row by row
+    void fillRows(unsigned int yStart, unsigned int yEnd, std::uint32_t color) {
+        yEnd = std::min(yEnd, m_height);
+        if (yStart >= yEnd) return;
+        if (m_width == m_stride) {
+            fillPixels(row(yStart), static_cast<std::size_t>(yEnd - yStart) * m_width, color);
+            return;
+        }
+        for (unsigned int y = yStart; y < yEnd; y++) fillPixels(row(y), m_width, color);
+    }
+
+    // Vertical span [yStart, yEnd) of column x, walked with a row stride
+    void fillColumn(unsigned int x, int yStart, int yEnd, std::uint32_t color) {
+        yStart = std::max(yStart, 0);
+        yEnd = std::min(yEnd, static_cast<int>(m_height));
+        if (x >= m_width || yStart >= yEnd) return;
+
+        std::uint32_t* dst = row(static_cast<unsigned int>(yStart)) + x;
+        const std::size_t stride = m_stride;
+        for (int y = yStart; y < yEnd; y++, dst += stride) {
+            *dst = color;
+        }
+    }
+
+    // Single upload of the whole storage into the persistent GPU texture;
+    // never reallocates it. The viewport is the texture's top-left corner.
+    const sf::Texture& upload() {
+        m_texture.update(reinterpret_cast<const std::uint8_t*>(m_pixels.get()));
+        return m_texture;
+    }
+
+    const sf::Texture& texture() const { return m_texture; }
+
+private:
+    struct AlignedDelete {
+        void operator()(std::uint32_t* p) const {
+            ::operator delete[](p, std::align_val_t{Alignment});
+        }
+    };
+    using PixelStorage = std::unique_ptr<std::uint32_t[], AlignedDelete>;
+
+    static PixelStorage allocate(std::size_t count) {
+        void* memory = ::operator new[](count * sizeof(std::uint32_t), std::align_val_t{Alignment});
+        return PixelStorage(static_cast<std::uint32_t*>(memory));
+    }
+
+    unsigned int m_width;
+    unsigned int m_height;
+    unsigned int m_stride;
+    unsigned int m_rows;
+    PixelStorage m_pixels;
+    sf::Texture m_texture;
+};
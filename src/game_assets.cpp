@@ -0,0 +1,149 @@
+#include "game_assets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+// Clips of an enemy as cells of its sheet, by column and row
+struct SheetClips {
+    std::vector<sf::Vector2i> walk, attack, die;
+};
+
+// The three sheets are grids of 64x128 cells
+constexpr sf::Vector2i ENEMY_CELL{64, 128};
+constexpr float ENEMY_WALK_RATE = 6.0f; // frames per second
+
+void requestEnemyClip(SpriteAnimation& clip, SpriteAtlas& sprites, int group, const std::filesystem::path& sheet,
+                      const std::vector<sf::Vector2i>& cells) {
+    std::vector<sf::IntRect> areas;
+    for (sf::Vector2i cell : cells) {
+        areas.push_back({{cell.x * ENEMY_CELL.x, cell.y * ENEMY_CELL.y}, ENEMY_CELL});
+    }
+    clip.requestAreas(sprites, group, sheet, areas);
+}
+
+// Rates that fit each clip in its time
+void timeEnemyArt(EnemyArt& art) {
+    art.walk.frameRate = ENEMY_WALK_RATE;
+    art.walk.looping = true;
+    art.attack.frameRate = std::max<std::size_t>(art.attack.frames.size(), 1) / ENEMY_ATTACK_TIME;
+    art.die.frameRate = std::max<std::size_t>(art.die.frames.size(), 1) / ENEMY_DEATH_TIME;
+}
+
+void requestSheetArt(GameAssets& assets, EnemyType type, const std::filesystem::path& sheet, const SheetClips& clips) {
+    EnemyArt art;
+    const int group = assets.sprites.group(SpriteAtlas::Anchor::Bottom);
+    requestEnemyClip(art.walk, assets.sprites, group, sheet, clips.walk);
+    requestEnemyClip(art.attack, assets.sprites, group, sheet, clips.attack);
+    requestEnemyClip(art.die, assets.sprites, group, sheet, clips.die);
+    timeEnemyArt(art);
+    assets.enemyArt[static_cast<int>(type)].push_back(std::move(art));
+}
+
+// The demon's frames are separate files, ALBUM008_<n>.png, in one directory
+// per colour
+void requestDemonArt(GameAssets& assets, const std::filesystem::path& directory) {
+    auto frames = [&](std::initializer_list<int> numbers) {
+        std::vector<std::filesystem::path> paths;
+        for (int number : numbers) paths.push_back(directory / ("ALBUM008_" + std::to_string(number) + ".png"));
+        return paths;
+    };
+    EnemyArt art;
+    const int group = assets.sprites.group(SpriteAtlas::Anchor::Bottom);
+    art.walk.requestFrames(assets.sprites, group, frames({72, 80, 88}));
+    art.attack.requestFrames(assets.sprites, group, frames({127, 128, 129}));
+    art.die.requestFrames(assets.sprites, group, frames({132, 133, 134, 135, 136, 137}));
+    timeEnemyArt(art);
+    assets.enemyArt[static_cast<int>(EnemyType::Demon)].push_back(std::move(art));
+}
+
+bool requestAssets(GameAssets& assets, const std::filesystem::path& atlasCache) {
+    if (!assets.font.openFromFile("res/arial.ttf")) { 
+        std::cerr << "Could not load font\n"; 
+        return false; 
+    }
+    AssetManager& manager = assets.manager;
+    
+    // DOOM screens and status bar
+    assets.title = &manager.texture("res/doom/TITLEPIC.png");
+    assets.victory = &manager.texture("res/doom/VICTORY2.png");
+    assets.statusBar = &manager.image("res/doom/STBAR.png");
+    
+    // Wall texture
+    assets.wall = &manager.texture("res/textures/world.png");
+    assets.tileset = &manager.image("res/textures/world.png");
+    
+    // Enemies
+    requestSheetArt(assets, EnemyType::Wolf, "res/textures/wolf.png",
+                    {{{0, 1}, {1, 1}, {2, 1}, {3, 1}}, {{12, 1}, {13, 1}, {14, 1}},
+                     {{0, 2}, {1, 2}, {2, 2}, {3, 2}, {4, 2}}});
+    requestSheetArt(assets, EnemyType::SmokeDemon, "res/textures/smoke-demon.png",
+                    {{{0, 0}, {1, 0}, {0, 1}, {1, 1}}, {{2, 2}, {3, 2}, {4, 2}, {5, 2}, {6, 2}},
+                     {{0, 3}, {1, 3}, {2, 3}, {3, 3}, {4, 3}, {5, 3}}});
+    requestSheetArt(assets, EnemyType::TophatOgre, "res/textures/tophat-ogre.png",
+                    {{{0, 0}, {1, 0}, {0, 1}, {1, 1}}, {{0, 2}, {1, 2}, {2, 2}, {3, 2}},
+                     {{10, 2}, {11, 2}, {12, 2}, {13, 2}, {14, 2}}});
+    for (const char* colour : {"Red", "Blue", "Green", "Shadow"}) {
+        requestDemonArt(assets, std::filesystem::path("res/textures/Demon") / colour);
+    }
+    
+    // Effect flipbooks
+    SpriteAtlas& sprites = assets.sprites;
+    EffectAnimations& effects = assets.effects;
+    effects.blood.requestFrames(sprites, sprites.group(SpriteAtlas::Anchor::Centre),
+                                {"res/textures/Blood/BLUDA0.png", "res/textures/Blood/BLUDB0.png",
+                                 "res/textures/Blood/BLUDC0.png", "res/textures/Blood/BLUDD0.png"});
+    effects.blood.frameRate = 5.0f;
+    std::vector<std::filesystem::path> puffFrames;
+    for (char frame = 'A'; frame <= 'F'; frame++) {
+        puffFrames.push_back(std::string("res/textures/Blood/Unused FX/FOG1") + frame + "0.png");
+    }
+    effects.deathPuff.requestFrames(sprites, sprites.group(SpriteAtlas::Anchor::Centre), puffFrames);
+    effects.deathPuff.frameRate = 12.0f;
+    effects.shot.requestCells(sprites, sprites.group(SpriteAtlas::Anchor::Centre),
+                              "res/textures/Player Projectiles/WIDBALL.cells");
+    effects.shot.frameRate = 15.0f;
+    effects.shot.looping = true;
+    effects.impact.requestCells(sprites, sprites.group(SpriteAtlas::Anchor::Centre),
+                                "res/textures/Player Projectiles/EMISEXP.cells");
+    effects.impact.frameRate = 15.0f;
+    
+    sprites.request(manager, atlasCache);
+    
+    // Sound effects, where they ship
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (std::filesystem::exists(SFX_FILES[i].path)) assets.sfx[i] = &manager.sound(SFX_FILES[i].path);
+    }
+    return true;
+}
+
+void checkAssets(GameAssets& assets) {
+    assets.sprites.finish(assets.manager);
+    for (const auto& path : assets.manager.failures()) {
+        std::cerr << "Could not load " << path.string() << "\n";
+    }
+    EffectAnimations& effects = assets.effects;
+    if (!effects.blood.complete()) std::cerr << "Could not load blood frames\n";
+    if (!effects.deathPuff.complete()) std::cerr << "Could not load death puff frames\n";
+    if (!effects.shot.complete()) std::cerr << "Could not load projectile frames\n";
+    if (!effects.impact.complete()) std::cerr << "Could not load impact frames\n";
+    for (auto& looks : assets.enemyArt) {
+        const std::size_t before = looks.size();
+        looks.erase(std::remove_if(looks.begin(), looks.end(), [](EnemyArt& art) { return !art.complete(); }),
+                    looks.end());
+        if (looks.size() < before) std::cerr << "Could not load " << before - looks.size() << " enemy look(s)\n";
+    }
+    for (int i = 0; i < SFX_COUNT; i++) {
+        if (!assets.manager.loaded(SFX_FILES[i].path)) assets.sfx[i] = nullptr;
+    }
+    
+    const SpriteAtlas& sprites = assets.sprites;
+    std::cout << "Sprite atlas: " << sprites.frames() << " frames on " << sprites.pages() << " page(s)";
+    for (std::size_t page = 0; page < sprites.pages(); page++) {
+        std::cout << (page ? ", " : " of ") << sprites.pageSize(page).x << "x" << sprites.pageSize(page).y;
+    }
+    std::cout << ", " << std::lround(sprites.fill() * 100) << "% filled, "
+              << (sprites.cached() ? "from cache" : "packed") << "\n";
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "asset_manager.hpp"
+#include "particle_pool.hpp"
+#include "sprite_atlas.hpp"
+
+// ===========================================
+// GAME ASSETS
+// What the game loads and what the simulation names by number: enemy
+// types and their art, and the sound effects it cues
+// ===========================================
+
+enum class EnemyType { Wolf, SmokeDemon, TophatOgre, Demon };
+constexpr int ENEMY_TYPES = 4;
+
+// What an enemy is doing, for its animation
+enum class EnemyAnim : std::uint8_t { Walk, Attack, Die };
+
+constexpr float ENEMY_ATTACK_TIME = 0.4f; // seconds an attack animation plays
+constexpr float ENEMY_DEATH_TIME = 0.6f;  // seconds a dead enemy stays drawn
+
+// Sound effects the simulation cues, indexing GameAssets::sfx
+enum class Sfx { Shot, Hit, Death, Attack, Impact, Pickup };
+constexpr int SFX_COUNT = 6;
+
+// Main-thread time per frame spent uploading decoded assets while the
+// loading screen is up
+constexpr std::chrono::microseconds ASSET_UPLOAD_BUDGET{4000};
+constexpr float MUSIC_VOLUME = 50.0f; // of 100, under the effects
+
+// Flipbooks for particles and projectiles
+struct EffectAnimations {
+    SpriteAnimation blood;     // hit spray
+    SpriteAnimation deathPuff; // enemy killed
+    SpriteAnimation shot;      // player projectile in flight
+    SpriteAnimation impact;    // projectile hits a wall
+};
+
+// One look of an enemy type. Walking loops; an attack plays once over
+// ENEMY_ATTACK_TIME and a death over ENEMY_DEATH_TIME, holding its last
+// frame. All three share a scale group, so frames of every clip line up.
+struct EnemyArt {
+    SpriteAnimation walk, attack, die;
+    
+    const SpriteAnimation& clip(EnemyAnim anim) const {
+        switch (anim) {
+            case EnemyAnim::Walk: return walk;
+            case EnemyAnim::Attack: return attack;
+            case EnemyAnim::Die: return die;
+        }
+        return walk;
+    }
+    
+    // After the atlas is built; false when any clip is missing a frame
+    bool complete() {
+        const bool walks = walk.complete();
+        const bool attacks = attack.complete();
+        const bool dies = die.complete();
+        return walks && attacks && dies;
+    }
+};
+
+// Textures, images and flipbooks, asked for at startup and filled in as
+// the asset manager finishes them. Only the font loads up front, for the
+// loading screen. Every sprite frame, enemies and effects alike, lives in
+// the sprite atlas. Sound effects are optional: one whose file is missing
+// or fails to decode stays null and is not played.
+struct GameAssets {
+    AssetManager manager;
+    sf::Font font;
+    const sf::Texture* title = nullptr;
+    const sf::Texture* victory = nullptr;
+    const sf::Texture* wall = nullptr;
+    const sf::Image* tileset = nullptr;   // CPU copy of wall, for the software surfaces
+    const sf::Image* statusBar = nullptr;
+    SpriteAtlas sprites;
+    EffectAnimations effects;
+    std::array<std::vector<EnemyArt>, ENEMY_TYPES> enemyArt; // looks per type
+    std::array<const sf::SoundBuffer*, SFX_COUNT> sfx{};     // by Sfx
+    
+    // Null for a type with no looks left
+    const EnemyArt* enemyLook(EnemyType type, std::uint8_t variant) const {
+        const std::vector<EnemyArt>& looks = enemyArt[static_cast<int>(type)];
+        return looks.empty() ? nullptr : &looks[variant % looks.size()];
+    }
+};
+
+// Effect files by Sfx, and which wins when voices run out: a death or a
+// hit on the player over the player's own shots over hits and impacts
+struct SfxFile {
+    const char* path;
+    int priority;
+    float volume;
+};
+constexpr std::array<SfxFile, SFX_COUNT> SFX_FILES{{
+    {"res/sfx/shot.ogg", 2, 70.0f},
+    {"res/sfx/hit.ogg", 1, 80.0f},
+    {"res/sfx/death.ogg", 3, 100.0f},
+    {"res/sfx/attack.ogg", 3, 100.0f},
+    {"res/sfx/impact.ogg", 0, 60.0f},
+    {"res/sfx/pickup.ogg", 2, 80.0f},
+}};
+inline const std::filesystem::path MUSIC_FILE = "res/sfx/music.ogg";
+
+// Opens the font and queues everything else for decoding. Only the font
+// is required; a missing texture or flipbook just leaves that image blank.
+// The sprite atlas is saved to atlasCache, when set, and taken from there
+// while its sources are unchanged.
+bool requestAssets(GameAssets& assets, const std::filesystem::path& atlasCache);
+
+// Once the manager is done: builds the sprite atlas, reports what failed
+// to load and drops flipbooks missing a frame, and enemy looks missing a
+// clip, so a missing one only hides that effect or look
+void checkAssets(GameAssets& assets);
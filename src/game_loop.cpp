@@ -0,0 +1,137 @@
+#include "game_loop.hpp"
+
+#include <iostream>
+#include <memory>
+
+#include "audio_engine.hpp"
+#include "game_assets.hpp"
+
+int runGame(EngineConfig config, const char* title, PlayViewFn drawView) {
+    if (!config.demoPath.empty() || !config.recordPath.empty() || !config.loadPath.empty() ||
+        config.hostPort != 0 || !config.joinAddress.empty() || config.bench || config.ddaBench ||
+        config.flowBench || config.genBench) {
+        std::cerr << "Demos, saves, net games and benchmarks need the complete edition, ignoring them\n";
+        config.demoPath.clear();
+        config.recordPath.clear();
+        config.loadPath.clear();
+        config.hostPort = 0;
+        config.joinAddress.clear();
+        config.players = 1;
+    }
+
+    const unsigned int screenWidth = config.screenWidth;
+    const unsigned int screenHeight = config.screenHeight;
+    sf::RenderWindow window(sf::VideoMode({screenWidth, screenHeight}), title);
+    window.setVerticalSyncEnabled(config.pacing == FramePacing::VSync);
+    window.setFramerateLimit(config.pacing == FramePacing::Capped ? config.frameCap : 0);
+
+    GameAssets assets;
+    if (!requestAssets(assets, config.atlasCache)) return -1;
+    std::unique_ptr<AudioEngine> audio;
+    if (config.audio) audio = std::make_unique<AudioEngine>(SFX_COUNT);
+
+    RenderContext renderContext(config);
+    std::unique_ptr<GameWorld> world = createWorld(config, assets, renderContext.workers);
+    Player& player = world->players[0];
+    Hud hud(assets.font, nullptr, {screenWidth, screenHeight});
+
+    // Upload what has decoded, a few milliseconds a frame
+    CachedText loadingText(assets.font, 24, sf::Color::White, {20.f, screenHeight - 50.f});
+    while (window.isOpen() && !assets.manager.pump(ASSET_UPLOAD_BUDGET)) {
+        while (auto event = window.pollEvent()) {
+            if (event->is<sf::Event::Closed>()) window.close();
+        }
+        loadingText.set("Loading ", assets.manager.finished(), " / ", assets.manager.requested());
+        window.clear();
+        window.draw(loadingText.text());
+        window.display();
+    }
+    if (!window.isOpen()) return 0;
+    checkAssets(assets);
+    hud.setStatusBar(assets.statusBar);
+    renderContext.setSurfaces(*assets.tileset);
+    if (audio) {
+        for (int i = 0; i < SFX_COUNT; i++) {
+            audio->define(i, {assets.sfx[i], SFX_FILES[i].priority, SFX_FILES[i].volume});
+        }
+        if (config.music && !audio->playMusic(MUSIC_FILE, MUSIC_VOLUME)) {
+            std::cerr << "Could not open " << MUSIC_FILE.string() << "\n";
+        }
+    }
+
+    CachedText endText(assets.font, 48, sf::Color::Yellow, {screenWidth / 2.f - 200, screenHeight / 2.f - 100});
+    endText.text().setOutlineColor(sf::Color::Black);
+    endText.text().setOutlineThickness(3);
+    bool over = false; // dead or victorious, play stops under the message
+
+    sf::Clock clock;
+    sf::Clock fpsClock;
+    int frameCount = 0;
+    float fps = 0;
+    float mouseDeltaX = 0;
+    bool fire = false;
+    const sf::Vector2i screenCentre(screenWidth / 2, screenHeight / 2);
+    sf::Mouse::setPosition(screenCentre, window);
+    window.setMouseCursorVisible(false);
+
+    while (window.isOpen()) {
+        const float deltaTime = clock.restart().asSeconds();
+        sf::Clock workClock;
+        frameCount++;
+        if (fpsClock.getElapsedTime().asSeconds() >= 1.0f) {
+            fps = frameCount / fpsClock.getElapsedTime().asSeconds();
+            frameCount = 0;
+            fpsClock.restart();
+        }
+
+        if (!over && window.hasFocus()) {
+            mouseDeltaX += static_cast<float>(sf::Mouse::getPosition(window).x - screenCentre.x);
+            sf::Mouse::setPosition(screenCentre, window);
+        }
+        while (auto event = window.pollEvent()) {
+            if (event->is<sf::Event::Closed>()) window.close();
+            if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
+                if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
+            }
+            if (const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>()) {
+                if (mousePressed->button == sf::Mouse::Button::Left && !over) fire = true;
+            }
+        }
+
+        // Keys count as held for every tick of the frame; mouse motion and
+        // clicks go to the next tick, as in the complete edition
+        if (!over) {
+            const PlayerInput held = sampleKeyboard(0.0f, false);
+            for (int ticks = dueTicks(*world, deltaTime); ticks > 0 && !over; ticks--) {
+                PlayerInput input = held;
+                input.mouseDeltaX = mouseDeltaX;
+                input.fire = fire;
+                mouseDeltaX = 0;
+                fire = false;
+                tickWorld(*world, &input);
+
+                if (!world->stream && world->allEnemiesDead() && world->enemies.size() > 0) {
+                    endText.set("VICTORY!\n\nFinal Score: ", player.score, "\nKills: ", player.kills,
+                                "\nPress ESC to exit");
+                    over = true;
+                } else if (player.health <= 0) {
+                    endText.set("GAME OVER\n\nFinal Score: ", player.score, "\nPress ESC to exit");
+                    over = true;
+                }
+            }
+            if (audio) audio->play(world->cues, {player.posX, player.posY, player.dirX, player.dirY}, world->map);
+            if (over) window.setMouseCursorVisible(true);
+        }
+        world->cues.clear();
+
+        window.clear();
+        drawView(window, renderContext, *world, hud, static_cast<int>(fps),
+                 world->simAccumulator / world->timestep, 0, nullptr);
+        if (over) window.draw(endText.text());
+        renderContext.adaptResolution(workClock.getElapsedTime().asSeconds() * 1000.0);
+        window.display();
+    }
+
+    std::cout << "Final score " << player.score << ", " << player.kills << " kills\n";
+    return 0;
+}
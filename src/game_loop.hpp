@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "engine_config.hpp"
+#include "game_world.hpp"
+#include "hud.hpp"
+#include "raycast_renderer.hpp"
+
+// ===========================================
+// GAME LOOP
+// The session the raycaster front ends play: one player on a generated or
+// streamed level, from the loading screen straight into play until death,
+// victory or Esc. Demos, saves, net play and the benchmarks belong to the
+// complete edition (main_complete.cpp), which runs its own loop, as does
+// the top-down forest (main_topdown_backup.cpp).
+// ===========================================
+
+// Draws one frame of play; drawPlayView<Backend> for a raycaster
+using PlayViewFn = void (*)(sf::RenderTarget& target, RenderContext& context, const GameWorld& world,
+                            Hud& hud, int fps, float alpha, int viewer, const Player* predicted);
+
+// Plays config in a window titled title, drawing frames with drawView.
+// Returns the exit code for main.
+int runGame(EngineConfig config, const char* title, PlayViewFn drawView);
+
+// The raycaster front end over one renderer backend, chosen at compile time
+template <class Backend>
+int runGame(EngineConfig config, const char* title) {
+    config.renderMode = Backend::MODE;
+    return runGame(config, title, &drawPlayView<Backend>);
+}
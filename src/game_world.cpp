@@ -0,0 +1,813 @@
+#include "game_world.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#include "profiler.hpp"
+#include "world_save.hpp"
+
+// ===========================================
+// COLLISION DETECTION
+// ===========================================
+
+bool checkCollision(const TileMap& map, double x, double y, double radius) {
+    double corners[4][2] = {
+        {x - radius, y - radius}, {x + radius, y - radius},
+        {x - radius, y + radius}, {x + radius, y + radius}
+    };
+    
+    for (int i = 0; i < 4; i++) {
+        int mapX = static_cast<int>(std::floor(corners[i][0]));
+        int mapY = static_cast<int>(std::floor(corners[i][1]));
+        
+        if (map.isWall(mapX, mapY)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double interpolate(double from, double to, double alpha) {
+    return from + (to - from) * alpha;
+}
+
+// Walks the cells the segment (x0, y0)-(x1, y1) crosses, in order, and
+// returns how far along it (0 to 1) it first enters a blocking cell, or a
+// value above 1 when it stays clear. Testing only the end point lets a
+// step longer than a cell skip a wall, or slip between two walls that
+// touch at a corner.
+double wallOnSegment(const TileMap& map, double x0, double y0, double x1, double y1) {
+    int cellX = static_cast<int>(std::floor(x0));
+    int cellY = static_cast<int>(std::floor(y0));
+    if (map.blocks(cellX, cellY)) return 0.0;
+    const int endX = static_cast<int>(std::floor(x1));
+    const int endY = static_cast<int>(std::floor(y1));
+    
+    const double dx = x1 - x0, dy = y1 - y0;
+    const int stepX = dx > 0 ? 1 : -1;
+    const int stepY = dy > 0 ? 1 : -1;
+    const double deltaX = dx != 0 ? std::abs(1 / dx) : 1e30; // fraction per cell
+    const double deltaY = dy != 0 ? std::abs(1 / dy) : 1e30;
+    double nextX = dx > 0 ? (cellX + 1 - x0) * deltaX : (x0 - cellX) * deltaX;
+    double nextY = dy > 0 ? (cellY + 1 - y0) * deltaY : (y0 - cellY) * deltaY;
+    
+    while (cellX != endX || cellY != endY) {
+        double t;
+        if (nextX < nextY) {
+            t = nextX;
+            nextX += deltaX;
+            cellX += stepX;
+        } else {
+            t = nextY;
+            nextY += deltaY;
+            cellY += stepY;
+        }
+        if (t > 1.0) break;
+        if (map.blocks(cellX, cellY)) return t;
+    }
+    return 2.0;
+}
+
+void tryMoveWithSlide(Player& player, 
+                      const TileMap& map,
+                      double targetX, double targetY) {
+    if (!checkCollision(map, targetX, targetY, PLAYER_RADIUS)) {
+        player.posX = targetX;
+        player.posY = targetY;
+        return;
+    }
+    
+    if (!checkCollision(map, targetX, player.posY, PLAYER_RADIUS)) {
+        player.posX = targetX;
+        return;
+    }
+    
+    if (!checkCollision(map, player.posX, targetY, PLAYER_RADIUS)) {
+        player.posY = targetY;
+        return;
+    }
+}
+
+// ===========================================
+// PLAYER MOVEMENT
+// ===========================================
+
+PlayerInput sampleKeyboard(float mouseDeltaX, bool fire) {
+    PlayerInput input;
+    input.forward = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W);
+    input.back = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S);
+    input.strafeLeft = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A);
+    input.strafeRight = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D);
+    input.turnLeft = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left);
+    input.turnRight = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right);
+    input.fire = fire;
+    input.mouseDeltaX = mouseDeltaX;
+    return input;
+}
+
+DemoTic demoTic(const PlayerInput& input) {
+    DemoTic tic;
+    tic.buttons = static_cast<std::uint8_t>(
+        (input.forward ? DemoButton::Forward : 0) | (input.back ? DemoButton::Back : 0) |
+        (input.strafeLeft ? DemoButton::StrafeLeft : 0) | (input.strafeRight ? DemoButton::StrafeRight : 0) |
+        (input.turnLeft ? DemoButton::TurnLeft : 0) | (input.turnRight ? DemoButton::TurnRight : 0) |
+        (input.fire ? DemoButton::Fire : 0));
+    tic.mouseDeltaX = static_cast<std::int16_t>(std::clamp(std::lround(input.mouseDeltaX), -32768l, 32767l));
+    return tic;
+}
+
+PlayerInput playerInput(const DemoTic& tic) {
+    PlayerInput input;
+    input.forward = tic.buttons & DemoButton::Forward;
+    input.back = tic.buttons & DemoButton::Back;
+    input.strafeLeft = tic.buttons & DemoButton::StrafeLeft;
+    input.strafeRight = tic.buttons & DemoButton::StrafeRight;
+    input.turnLeft = tic.buttons & DemoButton::TurnLeft;
+    input.turnRight = tic.buttons & DemoButton::TurnRight;
+    input.fire = tic.buttons & DemoButton::Fire;
+    input.mouseDeltaX = tic.mouseDeltaX;
+    return input;
+}
+
+DemoHeader demoHeader(const EngineConfig& config) {
+    DemoHeader header;
+    header.tickRate = static_cast<std::uint16_t>(config.tickRate);
+    header.seed = config.seed;
+    header.mapWidth = config.mapWidth;
+    header.mapHeight = config.mapHeight;
+    header.enemyCount = config.enemyCount;
+    header.infinite = config.infinite;
+    header.morton = config.mapLayout == TileLayout::Morton;
+    return header;
+}
+
+bool applyDemoHeader(EngineConfig& config, const DemoHeader& header) {
+    if (header.tickRate < MIN_TICK_RATE || header.tickRate > MAX_TICK_RATE || header.mapWidth < 32 ||
+        header.mapWidth > 4096 || header.mapHeight < 32 || header.mapHeight > 4096 || header.enemyCount < 0) {
+        return false;
+    }
+    config.tickRate = header.tickRate;
+    config.seed = header.seed;
+    config.mapWidth = header.mapWidth;
+    config.mapHeight = header.mapHeight;
+    config.enemyCount = header.enemyCount;
+    config.infinite = header.infinite;
+    config.mapLayout = header.morton ? TileLayout::Morton : TileLayout::RowMajor;
+    if (header.morton) config.rayIsa = RayIsa::Scalar;
+    return true;
+}
+
+void updatePlayerMovement(Player& player, 
+                          const TileMap& map,
+                          float deltaTime,
+                          const PlayerInput& input) {
+    bool moving = false;
+    
+    // Keyboard movement
+    if (input.forward) {
+        player.momX += player.dirX * MOVE_SPEED * deltaTime;
+        player.momY += player.dirY * MOVE_SPEED * deltaTime;
+        moving = true;
+    }
+    if (input.back) {
+        player.momX -= player.dirX * MOVE_SPEED * deltaTime;
+        player.momY -= player.dirY * MOVE_SPEED * deltaTime;
+        moving = true;
+    }
+    if (input.strafeLeft) {
+        player.momX += player.planeX * STRAFE_SPEED * deltaTime;
+        player.momY += player.planeY * STRAFE_SPEED * deltaTime;
+        moving = true;
+    }
+    if (input.strafeRight) {
+        player.momX -= player.planeX * STRAFE_SPEED * deltaTime;
+        player.momY -= player.planeY * STRAFE_SPEED * deltaTime;
+        moving = true;
+    }
+    
+    // Apply friction
+    if (!moving) {
+        const double friction = std::pow(FRICTION, deltaTime * 60.0);
+        player.momX *= friction;
+        player.momY *= friction;
+        if (std::abs(player.momX) < 0.001) player.momX = 0;
+        if (std::abs(player.momY) < 0.001) player.momY = 0;
+    }
+    
+    // Apply momentum
+    double targetX = player.posX + player.momX * deltaTime;
+    double targetY = player.posY + player.momY * deltaTime;
+    tryMoveWithSlide(player, map, targetX, targetY);
+    
+    // Mouse rotation
+    if (std::abs(input.mouseDeltaX) > 0.001) {
+        double rotAngle = -input.mouseDeltaX * MOUSE_SENSITIVITY;
+        double oldDirX = player.dirX;
+        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
+        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
+        
+        double oldPlaneX = player.planeX;
+        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
+        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
+    }
+    
+    // Arrow key rotation
+    if (input.turnLeft) {
+        double rotAngle = ROT_SPEED * deltaTime;
+        double oldDirX = player.dirX;
+        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
+        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
+        
+        double oldPlaneX = player.planeX;
+        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
+        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
+    }
+    if (input.turnRight) {
+        double rotAngle = -ROT_SPEED * deltaTime;
+        double oldDirX = player.dirX;
+        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
+        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
+        
+        double oldPlaneX = player.planeX;
+        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
+        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
+    }
+}
+
+// ===========================================
+// ENTITY UPDATE
+// One fixed step of enemy AI, projectiles and blood
+// ===========================================
+
+void moveEnemy(EnemyStore& enemies, int id, SpatialHash& enemyIndex, const FlowField& flow,
+               const TileMap& map, double targetX, double targetY, float dt) {
+    double x = enemies.x[id];
+    double y = enemies.y[id];
+    
+    double dirX, dirY;
+    if (!flow.steer(x, y, dirX, dirY)) {
+        double dx = targetX - x;
+        double dy = targetY - y;
+        double distSq = dx * dx + dy * dy;
+        if (distSq <= 0.1 * 0.1) return;
+        double dist = std::sqrt(distSq);
+        dirX = dx / dist;
+        dirY = dy / dist;
+    }
+    enemies.dirX[id] = dirX;
+    enemies.dirY[id] = dirY;
+    
+    double step = enemies.speed[id] * dt;
+    double newX = x + dirX * step;
+    double newY = y + dirY * step;
+    
+    if (checkCollision(map, newX, newY, ENEMY_RADIUS)) {
+        if (!checkCollision(map, newX, y, ENEMY_RADIUS)) {
+            newY = y;
+        } else if (!checkCollision(map, x, newY, ENEMY_RADIUS)) {
+            newX = x;
+        } else {
+            return;
+        }
+    }
+    enemies.x[id] = newX;
+    enemies.y[id] = newY;
+    enemyIndex.update(id, newX, newY);
+}
+
+// Animation states: an attack falls back to walking once played. Only
+// enemies that act advance, so the ones left idle hold their frame.
+void animateEnemy(EnemyStore& enemies, int id, float dt) {
+    enemies.animTime[id] += dt;
+    if (enemies.anim[id] == EnemyAnim::Attack && enemies.animTime[id] >= ENEMY_ATTACK_TIME) {
+        enemies.play(id, EnemyAnim::Walk);
+    }
+}
+
+// Dead rows play their death, then stop being drawn
+void animateDying(EnemyStore& enemies, float dt) {
+    for (int id : enemies.dying) enemies.animTime[id] += dt;
+    enemies.dying.erase(std::remove_if(enemies.dying.begin(), enemies.dying.end(),
+                                       [&](int id) { return enemies.animTime[id] >= ENEMY_DEATH_TIME; }),
+                        enemies.dying.end());
+}
+
+// The living player nearest (x, y), the first on a tie; the first player
+// when none is alive
+Player& nearestPlayer(std::vector<Player>& players, double x, double y) {
+    Player* nearest = &players[0];
+    double best = -1.0;
+    for (Player& player : players) {
+        if (player.health <= 0) continue;
+        const double dx = player.posX - x, dy = player.posY - y;
+        const double distSq = dx * dx + dy * dy;
+        if (best < 0 || distSq < best) {
+            best = distSq;
+            nearest = &player;
+        }
+    }
+    return *nearest;
+}
+
+// Only enemies in chase range of a player act, and with a PVS only those
+// in a region that player's region can see; each goes for the nearest
+// player. The hash is updated after the query, never during it.
+void updateEnemies(EnemyStore& enemies, SpatialHash& enemyIndex, FlowField& flow, std::vector<Player>& players,
+                   const TileMap& map, const RoomVisibility* visibility, std::vector<int>& nearby,
+                   std::vector<FlowTarget>& targets, SoundCues& cues, float dt) {
+    tickTimers(enemies.attackCooldown.data(), enemies.size(), dt);
+    animateDying(enemies, dt);
+    
+    // No-op unless a player has entered another tile
+    targets.clear();
+    for (const Player& player : players) {
+        if (player.health > 0 || players.size() == 1) {
+            targets.push_back({static_cast<int>(std::floor(player.posX)), static_cast<int>(std::floor(player.posY))});
+        }
+    }
+    flow.build(map, targets.data(), targets.size(), FLOW_FIELD_RANGE);
+    
+    nearby.clear();
+    for (const Player& player : players) {
+        const int playerRegion = visibility ? visibility->regionAt(player.posX, player.posY) : RoomVisibility::None;
+        enemyIndex.forEachInRadius(player.posX, player.posY, ENEMY_CHASE_RANGE, [&](int id, double) {
+            if (!visibility ||
+                visibility->visible(playerRegion, visibility->regionAt(enemies.x[id], enemies.y[id]))) {
+                nearby.push_back(id);
+            }
+        });
+    }
+    // Near more than one player, an enemy still acts once
+    if (players.size() > 1) {
+        std::sort(nearby.begin(), nearby.end());
+        nearby.erase(std::unique(nearby.begin(), nearby.end()), nearby.end());
+    }
+    for (int id : nearby) {
+        Player& player = nearestPlayer(players, enemies.x[id], enemies.y[id]);
+        moveEnemy(enemies, id, enemyIndex, flow, map, player.posX, player.posY, dt);
+        
+        // Attack player if close
+        double dx = player.posX - enemies.x[id];
+        double dy = player.posY - enemies.y[id];
+        if (dx * dx + dy * dy < ENEMY_MELEE_RANGE * ENEMY_MELEE_RANGE && enemies.attackCooldown[id] <= 0.0f) {
+            player.health -= 10;
+            enemies.attackCooldown[id] = 1.5f;
+            enemies.play(id, EnemyAnim::Attack);
+            cues.push(static_cast<int>(Sfx::Attack), enemies.x[id], enemies.y[id]);
+        } else {
+            animateEnemy(enemies, id, dt);
+        }
+    }
+}
+
+// Where along the segment, 0 at its start and 1 at its end, it passes
+// closest to (x, y), as SpatialHash::firstOnSegment measures it
+double alongSegment(double x0, double y0, double x1, double y1, double x, double y) {
+    const double dx = x1 - x0, dy = y1 - y0;
+    const double lengthSq = dx * dx + dy * dy;
+    return lengthSq > 0 ? std::clamp(((x - x0) * dx + (y - y0) * dy) / lengthSq, 0.0, 1.0) : 0.0;
+}
+
+// The living player other than skip that the segment passes within radius
+// of, the one nearest its start, and how far along it is in at; null when
+// there is none
+Player* playerOnSegment(std::vector<Player>& players, std::size_t skip, double x0, double y0,
+                        double x1, double y1, double radius, double& at) {
+    Player* first = nullptr;
+    at = 2.0;
+    for (std::size_t slot = 0; slot < players.size(); slot++) {
+        Player& player = players[slot];
+        if (slot == skip || player.health <= 0) continue;
+        const double t = alongSegment(x0, y0, x1, y1, player.posX, player.posY);
+        const double offX = x0 + (x1 - x0) * t - player.posX, offY = y0 + (y1 - y0) * t - player.posY;
+        if (offX * offX + offY * offY <= radius * radius && t < at) {
+            first = &player;
+            at = t;
+        }
+    }
+    return first;
+}
+
+void spawnBlood(ParticlePool& particles, const EffectAnimations& effects, double x, double y) {
+    for (int p = 0; p < 5; p++) {
+        double angle = (p / 5.0) * 2 * 3.14159;
+        particles.spawn(&effects.blood, x, y, 0.5, std::cos(angle) * 2, std::sin(angle) * 2, 0.5, -9.8, 0.12f, 0.8f);
+    }
+}
+
+// Moves every projectile, then tests this step's travel as a segment, first
+// against the walls and then, up to the wall, against enemies, so no tick
+// rate lets a shot pass through either or hit through a wall. Dead enemies
+// are no longer in the index. With more than one player, other players are
+// targets too, and the shot takes whichever target it reaches first; the
+// players' deaths are left to the caller, and a frag counts as a kill. Walks backwards, so a row swapped in by kill has already
+// been resolved.
+void updateProjectiles(ProjectileStore& shots, EnemyStore& enemies, SpatialHash& enemyIndex,
+                       ParticlePool& particles, const EffectAnimations& effects,
+                       std::vector<Player>& players, const TileMap& map, SoundCues& cues, float dt) {
+    const std::size_t count = shots.size();
+    integrate(shots.x.data(), shots.velX.data(), count, dt);
+    integrate(shots.y.data(), shots.velY.data(), count, dt);
+    tickTimers(shots.timeLeft.data(), count, dt);
+    
+    for (std::size_t i = count; i-- > 0;) {
+        const double startX = shots.x[i] - shots.velX[i] * dt;
+        const double startY = shots.y[i] - shots.velY[i] * dt;
+        const double wallAt = wallOnSegment(map, startX, startY, shots.x[i], shots.y[i]);
+        const bool hitWall = wallAt <= 1.0;
+        const double x = hitWall ? interpolate(startX, shots.x[i], wallAt) : shots.x[i];
+        const double y = hitWall ? interpolate(startY, shots.y[i], wallAt) : shots.y[i];
+        
+        bool hitTarget = false;
+        if (shots.shooter[i]) {
+            const std::size_t slot = shots.shooter[i] - 1u;
+            Player& shooter = players[slot];
+            int id = enemyIndex.firstOnSegment(startX, startY, x, y,
+                                               PROJECTILE_HIT_RADIUS, [](int) { return true; });
+            double victimAt = 2.0;
+            Player* victim = players.size() > 1
+                ? playerOnSegment(players, slot, startX, startY, x, y, PROJECTILE_HIT_RADIUS, victimAt) : nullptr;
+            if (victim && id != SpatialHash::None &&
+                alongSegment(startX, startY, x, y, enemies.x[id], enemies.y[id]) <= victimAt) {
+                victim = nullptr;
+            }
+            if (victim) {
+                victim->health -= shots.damage[i];
+                hitTarget = true;
+                spawnBlood(particles, effects, victim->posX, victim->posY);
+                cues.push(static_cast<int>(Sfx::Hit), victim->posX, victim->posY);
+                // A frag counts once, for the shot that took the last health
+                if (victim->health <= 0 && victim->health + shots.damage[i] > 0) {
+                    shooter.score += 100;
+                    shooter.kills++;
+                }
+            } else if (id != SpatialHash::None) {
+                enemies.health[id] -= shots.damage[i];
+                hitTarget = true;
+                spawnBlood(particles, effects, enemies.x[id], enemies.y[id]);
+                
+                if (enemies.health[id] <= 0) {
+                    cues.push(static_cast<int>(Sfx::Death), enemies.x[id], enemies.y[id]);
+                    enemies.kill(id);
+                    enemyIndex.remove(id);
+                    shooter.score += 100;
+                    shooter.kills++;
+                    particles.spawn(&effects.deathPuff, enemies.x[id], enemies.y[id], 0.4,
+                                    0, 0, 0.3, 0, 0.6f);
+                } else {
+                    cues.push(static_cast<int>(Sfx::Hit), enemies.x[id], enemies.y[id]);
+                }
+            }
+        }
+        
+        if (hitWall && !hitTarget) {
+            // Just short of the wall face, so the burst stays out of the wall
+            constexpr double IMPACT_BACKOFF = 0.05;
+            particles.spawn(&effects.impact, x - shots.velX[i] / ProjectileStore::SPEED * IMPACT_BACKOFF,
+                            y - shots.velY[i] / ProjectileStore::SPEED * IMPACT_BACKOFF, 0.5,
+                            0, 0, 0, 0, 0.5f);
+            cues.push(static_cast<int>(Sfx::Impact), x, y);
+        }
+        if (hitWall || hitTarget || shots.timeLeft[i] <= 0.0f) shots.kill(i);
+    }
+}
+
+// ===========================================
+// WORLD STREAMING
+// ===========================================
+
+// Moves everything in window coordinates back by the window's shift,
+// previous-tick positions included. Enemies and pickups that end up off
+// the window are despawned, and shots and effects there are dropped.
+void recentreWorld(int shiftX, int shiftY, const TileMap& map, std::vector<Player>& players,
+                   EnemyStore& enemies, SpatialHash& enemyIndex,
+                   PickupStore& pickups, SpatialHash& pickupIndex,
+                   ProjectileStore& shots, ParticlePool& particles) {
+    auto inside = [&](double x, double y) {
+        return x >= 0 && y >= 0 && x < map.width() && y < map.height();
+    };
+    
+    for (Player& player : players) {
+        player.posX -= shiftX;
+        player.posY -= shiftY;
+    }
+    
+    for (size_t i = 0; i < enemies.size(); i++) {
+        if (!enemies.active[i]) continue;
+        enemies.x[i] -= shiftX;
+        enemies.y[i] -= shiftY;
+        enemies.prevX[i] -= shiftX;
+        enemies.prevY[i] -= shiftY;
+        if (inside(enemies.x[i], enemies.y[i])) {
+            enemyIndex.update(static_cast<int>(i), enemies.x[i], enemies.y[i]);
+        } else {
+            enemies.active[i] = 0;
+            enemyIndex.remove(static_cast<int>(i));
+        }
+    }
+    for (int id : enemies.dying) {
+        enemies.x[id] -= shiftX;
+        enemies.y[id] -= shiftY;
+        enemies.prevX[id] -= shiftX;
+        enemies.prevY[id] -= shiftY;
+    }
+    enemies.dying.erase(std::remove_if(enemies.dying.begin(), enemies.dying.end(),
+                                       [&](int id) { return !inside(enemies.x[id], enemies.y[id]); }),
+                        enemies.dying.end());
+    for (size_t i = 0; i < pickups.size(); i++) {
+        if (!pickups.active[i]) continue;
+        pickups.x[i] -= shiftX;
+        pickups.y[i] -= shiftY;
+        if (inside(pickups.x[i], pickups.y[i])) {
+            pickupIndex.update(static_cast<int>(i), pickups.x[i], pickups.y[i]);
+        } else {
+            pickups.active[i] = 0;
+            pickupIndex.remove(static_cast<int>(i));
+        }
+    }
+    
+    // Backwards, as kills swap the last row in
+    for (size_t i = shots.size(); i-- > 0;) {
+        shots.x[i] -= shiftX;
+        shots.y[i] -= shiftY;
+        shots.prevX[i] -= shiftX;
+        shots.prevY[i] -= shiftY;
+        if (!inside(shots.x[i], shots.y[i])) shots.kill(i);
+    }
+    for (size_t i = particles.count(); i-- > 0;) {
+        particles.x[i] -= shiftX;
+        particles.y[i] -= shiftY;
+        particles.prevX[i] -= shiftX;
+        particles.prevY[i] -= shiftY;
+        if (!inside(particles.x[i], particles.y[i])) particles.kill(i);
+    }
+}
+
+// ===========================================
+// GAME WORLD
+// ===========================================
+
+Player spawnPlayer(const std::vector<Room>& rooms, std::size_t slot) {
+    int startX = 5, startY = 5;
+    if (!rooms.empty()) {
+        const Room& room = rooms[slot % rooms.size()];
+        startX = room.centerX();
+        startY = room.centerY();
+    }
+    return Player(startX + 0.5, startY + 0.5);
+}
+
+GameWorld::GameWorld(std::unique_ptr<TileMap> fixedMap, std::unique_ptr<WorldStream> streamed,
+                     const std::vector<Room>& levelRooms, const GameAssets& gameAssets,
+                     int enemyCount, int pickupCount, std::uint64_t levelSeed, int ticksPerSecond, int playerCount,
+                     WorkerPool* workers, std::unique_ptr<RoomVisibility> knownVisibility)
+    : dungeonMap(std::move(fixedMap)), stream(std::move(streamed)),
+      map(stream ? stream->map() : *dungeonMap), assets(gameAssets), rooms(levelRooms), seed(levelSeed),
+      enemyIndex(map.width(), map.height()), pickupIndex(map.width(), map.height()),
+      flowField(map.width(), map.height()),
+      visibility(knownVisibility ? std::move(knownVisibility)
+                 : dungeonMap ? std::make_unique<RoomVisibility>(*dungeonMap, rooms, workers) : nullptr),
+      tickRate(ticksPerSecond), timestep(1.0f / tickRate) {
+    for (int slot = 0; slot < playerCount; slot++) players.push_back(spawnPlayer(rooms, slot));
+    previousPlayers = players;
+    DungeonRng spawnRng(mixSeed(seed, 1));
+    projectiles.animation = &assets.effects.shot;
+    
+    // Spawn enemies
+    enemies.reserve(enemyCount);
+    for (int i = 0; i < enemyCount; i++) {
+        int ex, ey;
+        if (findEmptySpot(map, spawnRng, ex, ey)) {
+            EnemyType type = static_cast<EnemyType>(i % ENEMY_TYPES);
+            int hp = 50;
+            float spd = 1.5f;
+            
+            switch (type) {
+                case EnemyType::Wolf: hp = 50; spd = 2.0f; break;
+                case EnemyType::SmokeDemon: hp = 75; spd = 1.5f; break;
+                case EnemyType::TophatOgre: hp = 100; spd = 1.2f; break;
+                case EnemyType::Demon: hp = 150; spd = 1.0f; break;
+            }
+            
+            // Looks take turns within a type
+            enemies.add(ex + 0.5, ey + 0.5, type, hp, spd, static_cast<std::uint8_t>(i / ENEMY_TYPES));
+        }
+    }
+    
+    // Spawn pickups
+    for (int i = 0; i < pickupCount; i++) {
+        int px, py;
+        if (findEmptySpot(map, spawnRng, px, py)) {
+            PickupType type = static_cast<PickupType>(i % 3);
+            int value = 0;
+            switch (type) {
+                case PickupType::HealthPack: value = 25; break;
+                case PickupType::Ammo: value = 20; break;
+                case PickupType::Armor: value = 50; break;
+            }
+            pickups.add(px + 0.5, py + 0.5, type, value);
+        }
+    }
+    
+    for (size_t i = 0; i < enemies.size(); i++) {
+        enemyIndex.insert(static_cast<int>(i), enemies.x[i], enemies.y[i]);
+    }
+    for (size_t i = 0; i < pickups.size(); i++) {
+        pickupIndex.insert(static_cast<int>(i), pickups.x[i], pickups.y[i]);
+    }
+}
+
+std::uint64_t worldChecksum(const GameWorld& world) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&](const auto& value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        for (unsigned char byte : bytes) hash = (hash ^ byte) * 0x100000001B3ull;
+    };
+    for (const Player& player : world.players) {
+        for (double value : {player.posX, player.posY, player.dirX, player.dirY, player.momX, player.momY}) mix(value);
+        for (int value : {player.health, player.ammo, player.score, player.kills}) mix(value);
+    }
+    for (std::size_t i = 0; i < world.enemies.size(); i++) {
+        mix(world.enemies.x[i]);
+        mix(world.enemies.y[i]);
+        mix(world.enemies.health[i]);
+        mix(world.enemies.active[i]);
+    }
+    for (std::size_t i = 0; i < world.projectiles.size(); i++) {
+        mix(world.projectiles.x[i]);
+        mix(world.projectiles.y[i]);
+    }
+    mix(world.particles.count());
+    return hash;
+}
+
+std::unique_ptr<GameWorld> createWorld(const EngineConfig& config, const GameAssets& assets,
+                                       WorkerPool& workers, const SaveFile* save) {
+    std::unique_ptr<TileMap> dungeonMap;
+    std::unique_ptr<WorldStream> stream;
+    std::unique_ptr<RoomVisibility> visibility;
+    std::vector<Room> rooms;
+    if (config.infinite) {
+        // Demos need every tick to see the same tiles
+        WorldStreamSettings settings;
+        settings.waitForWindow = !config.recordPath.empty() || !config.demoPath.empty();
+        stream = std::make_unique<WorldStream>(config.seed, settings, config.mapLayout);
+        stream->fillWindow();
+        // Rooms of the centre chunk, in window tiles
+        const int offset = stream->windowRadius() * stream->chunkSize();
+        for (Room room : stream->slot(stream->windowRadius(), stream->windowRadius())->rooms) {
+            room.x += offset;
+            room.y += offset;
+            rooms.push_back(room);
+        }
+        std::cout << "Streaming an unbounded world from seed " << config.seed << "\n";
+    } else if (save) {
+        // No generation: the tiles are copied in whole, once the save is
+        // known to fit the map, before anything is built or spawned on it
+        const auto tiles = save->section<std::uint8_t>(SaveSection::Tiles);
+        dungeonMap = std::make_unique<TileMap>(config.mapWidth, config.mapHeight, config.mapLayout,
+                                               save->header().mapBorder);
+        if (save->header().tickRate != config.tickRate || !saveConsistent(*save, *dungeonMap, config.players)) {
+            return nullptr;
+        }
+        std::memcpy(dungeonMap->storage(), tiles.data, tiles.size());
+        rooms = savedRooms(*save);
+        visibility = savedVisibility(*save, *dungeonMap);
+    } else {
+        dungeonMap = std::make_unique<TileMap>(config.mapWidth, config.mapHeight, config.mapLayout);
+        generateDungeon(*dungeonMap, rooms, config.seed, &workers);
+        std::cout << "Generated " << rooms.size() << " rooms from seed " << config.seed << "\n";
+    }
+    auto world = std::make_unique<GameWorld>(std::move(dungeonMap), std::move(stream), rooms, assets,
+                                             save ? 0 : config.enemyCount, save ? 0 : PICKUP_COUNT, config.seed,
+                                             config.tickRate, config.players, &workers, std::move(visibility));
+    if (save && !restoreWorld(*world, *save, &workers)) return nullptr;
+    if (world->visibility) {
+        const RoomVisibility& visibility = *world->visibility;
+        std::cout << "Visibility: " << visibility.regionCount() << " regions, each seeing "
+                  << std::lround(static_cast<double>(visibility.visiblePairs()) / visibility.regionCount())
+                  << " on average\n";
+    }
+    return world;
+}
+
+int dueTicks(GameWorld& world, float deltaTime) {
+    world.simAccumulator += deltaTime;
+    int ticks = 0;
+    while (world.simAccumulator >= world.timestep && ticks < MAX_SIM_STEPS) {
+        world.simAccumulator -= world.timestep;
+        ticks++;
+    }
+    if (world.simAccumulator >= world.timestep) world.simAccumulator = 0.0f;
+    return ticks;
+}
+
+void tickWorld(GameWorld& world, const PlayerInput* inputs) {
+    std::vector<Player>& players = world.players;
+    const TileMap& map = world.map;
+    const float dt = world.timestep;
+    
+    // Where everything was, for frames drawn before the next tick
+    world.previousPlayers = players;
+    world.enemies.snapshot();
+    world.projectiles.snapshot();
+    world.particles.snapshot();
+    
+    ProfileScope playerScope(ProfileStage::Player);
+    for (std::size_t slot = 0; slot < players.size(); slot++) {
+        Player& player = players[slot];
+        const PlayerInput& input = inputs[slot];
+        player.shotCooldown = std::max(0.0f, player.shotCooldown - dt);
+        if (input.fire && player.ammo > 0 && player.shotCooldown <= 0.0f) {
+            if (world.projectiles.add(player.posX, player.posY, player.dirX, player.dirY,
+                                      static_cast<std::uint8_t>(slot + 1))) {
+                world.cues.push(static_cast<int>(Sfx::Shot), player.posX, player.posY);
+                player.ammo--;
+                player.shotCooldown = 0.3f;
+            }
+        }
+        updatePlayerMovement(player, map, dt, input);
+    }
+    playerScope.stop();
+    
+    // Only offline worlds stream, so the one player leads the window
+    if (world.stream) {
+        ProfileScope streamScope(ProfileStage::Stream);
+        const Player& player = players[0];
+        int shiftX = 0, shiftY = 0;
+        if (world.stream->update(player.posX, player.posY, player.dirX, player.dirY, shiftX, shiftY)) {
+            world.flowField.invalidate();
+        }
+        if (shiftX != 0 || shiftY != 0) {
+            recentreWorld(shiftX, shiftY, map, players, world.enemies, world.enemyIndex,
+                          world.pickups, world.pickupIndex, world.projectiles, world.particles);
+            for (Player& previous : world.previousPlayers) {
+                previous.posX -= shiftX;
+                previous.posY -= shiftY;
+            }
+            world.cues.shift(shiftX, shiftY);
+        }
+    }
+    
+    {
+        ProfileScope scope(ProfileStage::Enemies);
+        updateEnemies(world.enemies, world.enemyIndex, world.flowField, players, map,
+                      world.visibility.get(), world.nearby, world.flowTargets, world.cues, dt);
+    }
+    {
+        ProfileScope scope(ProfileStage::Projectiles);
+        updateProjectiles(world.projectiles, world.enemies, world.enemyIndex, world.particles,
+                          world.assets.effects, players, map, world.cues, dt);
+    }
+    {
+        ProfileScope scope(ProfileStage::Particles);
+        world.particles.update(dt);
+    }
+    world.simTime += dt;
+    
+    // Check pickups, the first player to reach one taking it
+    ProfileScope pickupScope(ProfileStage::Player);
+    std::vector<int>& nearby = world.nearby;
+    for (Player& player : players) {
+        nearby.clear();
+        world.pickupIndex.forEachInRadius(player.posX, player.posY, PICKUP_RADIUS,
+                                          [&](int id, double) { nearby.push_back(id); });
+        for (int id : nearby) {
+            world.pickupIndex.remove(id);
+            world.pickups.active[id] = 0;
+            world.cues.push(static_cast<int>(Sfx::Pickup), world.pickups.x[id], world.pickups.y[id]);
+            
+            int value = world.pickups.value[id];
+            switch (world.pickups.type[id]) {
+                case PickupType::HealthPack:
+                    player.health = std::min(player.maxHealth, player.health + value);
+                    break;
+                case PickupType::Ammo:
+                    player.ammo += value;
+                    break;
+                case PickupType::Armor:
+                    // Could add armor system
+                    player.health = std::min(player.maxHealth, player.health + value / 2);
+                    break;
+            }
+        }
+    }
+    
+    // With company, the dead start again in their own room, keeping their
+    // score; alone, death ends the game
+    if (players.size() > 1) {
+        for (std::size_t slot = 0; slot < players.size(); slot++) {
+            Player& player = players[slot];
+            if (player.health > 0) continue;
+            world.cues.push(static_cast<int>(Sfx::Death), player.posX, player.posY);
+            Player respawned = spawnPlayer(world.rooms, slot);
+            respawned.score = player.score;
+            respawned.kills = player.kills;
+            player = respawned;
+            world.previousPlayers[slot] = respawned;
+        }
+    }
+}
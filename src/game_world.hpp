@@ -0,0 +1,309 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "audio_engine.hpp"
+#include "demo.hpp"
+#include "dungeon_gen.hpp"
+#include "engine_config.hpp"
+#include "entity_store.hpp"
+#include "flow_field.hpp"
+#include "game_assets.hpp"
+#include "particle_pool.hpp"
+#include "room_visibility.hpp"
+#include "save_state.hpp"
+#include "spatial_hash.hpp"
+#include "tile_map.hpp"
+#include "worker_pool.hpp"
+#include "world_stream.hpp"
+
+// ===========================================
+// GAME WORLD
+// Map, entities and simulation state for one session, shared by every
+// front end and the headless benchmarks
+// ===========================================
+
+// Movement constants (from DOOM)
+constexpr double MOVE_SPEED = 5.0;
+constexpr double STRAFE_SPEED = 4.5;
+constexpr double ROT_SPEED = 3.0;
+constexpr double MOUSE_SENSITIVITY = 0.002;
+constexpr double PLAYER_RADIUS = 0.3;
+constexpr double FRICTION = 0.90;   // momentum kept per 1/60 s when not moving
+
+// Interaction ranges, in tiles
+constexpr double ENEMY_CHASE_RANGE = 15.0;
+constexpr double ENEMY_MELEE_RANGE = 1.5;
+constexpr double PROJECTILE_HIT_RADIUS = 0.5;
+constexpr double PICKUP_RADIUS = 0.8;
+constexpr double ENEMY_RADIUS = 0.2;
+
+// Path search depth, in steps. Enemies the field does not reach steer
+// straight at the player.
+constexpr std::uint32_t FLOW_FIELD_RANGE = 48;
+
+// Player struct
+struct Player {
+    double posX, posY;
+    double dirX, dirY;
+    double planeX, planeY;
+    double momX, momY;
+    int health;
+    int maxHealth;
+    int ammo;
+    int score;
+    int kills;
+    float shotCooldown; // seconds until it can fire again
+    
+    Player(double x, double y) 
+        : posX(x), posY(y), dirX(-1), dirY(0), planeX(0), planeY(0.66),
+          momX(0), momY(0), health(100), maxHealth(100), ammo(50), score(0), kills(0), shotCooldown(0) {}
+};
+
+// Enemies, one column per field. Rows are never erased, so an index stays a
+// stable id for the spatial hash; death clears active instead, and the row
+// is drawn dying until its animation ends. prevX / prevY are the position
+// at the start of the current tick, for drawing between ticks.
+struct EnemyStore {
+    std::vector<double> x, y;
+    std::vector<double> prevX, prevY;
+    std::vector<double> dirX, dirY;
+    std::vector<float> speed;
+    std::vector<float> attackCooldown; // seconds until the next melee hit
+    std::vector<int> health;
+    std::vector<int> maxHealth;
+    std::vector<EnemyType> type;
+    std::vector<std::uint8_t> active;
+    std::vector<std::uint8_t> variant; // which of the type's art sets it wears
+    std::vector<EnemyAnim> anim;
+    std::vector<float> animTime;       // seconds into anim
+    std::vector<int> dying;            // dead rows still drawn, oldest first
+    
+    std::size_t size() const { return x.size(); }
+    
+    void reserve(std::size_t count) {
+        x.reserve(count); y.reserve(count); prevX.reserve(count); prevY.reserve(count);
+        dirX.reserve(count); dirY.reserve(count);
+        speed.reserve(count); attackCooldown.reserve(count);
+        health.reserve(count); maxHealth.reserve(count); type.reserve(count);
+        active.reserve(count); variant.reserve(count); anim.reserve(count); animTime.reserve(count);
+    }
+    
+    void add(double px, double py, EnemyType t, int hp, float spd, std::uint8_t look = 0) {
+        x.push_back(px); y.push_back(py);
+        prevX.push_back(px); prevY.push_back(py);
+        dirX.push_back(0); dirY.push_back(0);
+        speed.push_back(spd);
+        attackCooldown.push_back(0.0f);
+        health.push_back(hp); maxHealth.push_back(hp);
+        type.push_back(t);
+        active.push_back(1);
+        variant.push_back(look);
+        anim.push_back(EnemyAnim::Walk);
+        animTime.push_back(0.0f);
+    }
+    
+    void play(int id, EnemyAnim next) {
+        anim[id] = next;
+        animTime[id] = 0.0f;
+    }
+    
+    // Deactivates the row and starts its death
+    void kill(int id) {
+        active[id] = 0;
+        play(id, EnemyAnim::Die);
+        dying.push_back(id);
+    }
+    
+    void snapshot() {
+        prevX = x;
+        prevY = y;
+    }
+};
+
+// Projectiles in flight, preallocated; velocity already includes the speed.
+// prevX / prevY are as for enemies. shooter is the firing player's slot
+// plus one, or 0 for a shot no player fired.
+struct ProjectileStore {
+    static constexpr double SPEED = 12.0;
+    static constexpr float LIFETIME = 2.0f;
+    
+    std::vector<double> x, y;
+    std::vector<double> prevX, prevY;
+    std::vector<double> velX, velY;
+    std::vector<float> timeLeft;
+    std::vector<int> damage;
+    std::vector<std::uint8_t> shooter;
+    PoolPressure pressure;
+    const SpriteAnimation* animation = nullptr; // in-flight frames
+    
+    explicit ProjectileStore(std::size_t capacity) {
+        pressure.capacity = capacity;
+        reserveColumns(capacity, x, y, prevX, prevY, velX, velY, timeLeft, damage, shooter);
+    }
+    
+    std::size_t size() const { return x.size(); }
+    
+    bool add(double px, double py, double dx, double dy, std::uint8_t by) {
+        if (!pressure.admit(size())) return false;
+        x.push_back(px); y.push_back(py);
+        prevX.push_back(px); prevY.push_back(py);
+        velX.push_back(dx * SPEED); velY.push_back(dy * SPEED);
+        timeLeft.push_back(LIFETIME);
+        damage.push_back(by ? 25 : 10);
+        shooter.push_back(by);
+        return true;
+    }
+    
+    void kill(std::size_t i) {
+        swapRemove(i, x, y, prevX, prevY, velX, velY, timeLeft, damage, shooter);
+    }
+    
+    void clear() { clearColumns(x, y, prevX, prevY, velX, velY, timeLeft, damage, shooter); }
+    
+    void snapshot() {
+        prevX = x;
+        prevY = y;
+    }
+    
+    const AtlasFrame* frame(std::size_t i) const {
+        return animation ? animation->frameAt(LIFETIME - timeLeft[i]) : nullptr;
+    }
+};
+
+enum class PickupType { HealthPack, Ammo, Armor };
+
+// Pickup items; like enemies, rows are never erased
+struct PickupStore {
+    std::vector<double> x, y;
+    std::vector<PickupType> type;
+    std::vector<int> value;
+    std::vector<std::uint8_t> active;
+    
+    std::size_t size() const { return x.size(); }
+    
+    void add(double px, double py, PickupType t, int v) {
+        x.push_back(px); y.push_back(py);
+        type.push_back(t);
+        value.push_back(v);
+        active.push_back(1);
+    }
+};
+
+// Bodies only ever stand on empty cells, so with radius < 1 every corner is
+// at most one cell off the map and lands on the wall border.
+bool checkCollision(const TileMap& map, double x, double y, double radius);
+
+double interpolate(double from, double to, double alpha);
+
+// One tick of player controls. The game samples them from the keyboard
+// and mouse, demos replay recorded ones and the benchmark a scripted stream.
+struct PlayerInput {
+    bool forward = false, back = false;
+    bool strafeLeft = false, strafeRight = false;
+    bool turnLeft = false, turnRight = false;
+    bool fire = false;
+    float mouseDeltaX = 0;
+};
+
+PlayerInput sampleKeyboard(float mouseDeltaX, bool fire);
+
+// Demos store the mouse as whole pixels, which is all it ever reports
+DemoTic demoTic(const PlayerInput& input);
+
+PlayerInput playerInput(const DemoTic& tic);
+
+// The settings a demo must be played back under
+DemoHeader demoHeader(const EngineConfig& config);
+
+// Plays under a demo's or a host's settings. False, leaving config as it
+// was, for a tick rate, map size or enemy count no command line could have
+// given.
+bool applyDemoHeader(EngineConfig& config, const DemoHeader& header);
+
+// One tick of the player's own movement and turning
+void updatePlayerMovement(Player& player, const TileMap& map, float deltaTime, const PlayerInput& input);
+
+// Moves one enemy a step along the flow field, or straight at the target on
+// the target's own tile and beyond the field's reach. Blocked moves slide
+// along the wall on one axis, as the player's do.
+void moveEnemy(EnemyStore& enemies, int id, SpatialHash& enemyIndex, const FlowField& flow,
+               const TileMap& map, double targetX, double targetY, float dt);
+
+// Pickups on a new level
+constexpr int PICKUP_COUNT = 10;
+
+// Player slot starts in the middle of a room of its own while there are
+// enough, the first player in the first
+Player spawnPlayer(const std::vector<Room>& rooms, std::size_t slot = 0);
+
+// Exactly one of dungeonMap and stream is set, and map is whichever one it
+// is. Only fixed dungeons get a PVS, built here unless one is given.
+// Spawns draw from their own stream of the seed, so they do not shift when
+// the generator changes.
+struct GameWorld {
+    std::unique_ptr<TileMap> dungeonMap;
+    std::unique_ptr<WorldStream> stream;
+    const TileMap& map;
+    const GameAssets& assets;
+    std::vector<Room> rooms;   // the level's, or the centre chunk's when streamed
+    const std::uint64_t seed;
+    std::vector<Player> players; // by slot: one offline, one per peer in a net game
+    EnemyStore enemies;
+    PickupStore pickups;
+    
+    // Enemies and pickups are indexed by their row in the stores above
+    SpatialHash enemyIndex;
+    SpatialHash pickupIndex;
+    std::vector<int> nearby;
+    std::vector<FlowTarget> flowTargets;
+    FlowField flowField;
+    std::unique_ptr<RoomVisibility> visibility;
+    
+    // Fixed capacity; both stores report drops when they run full
+    ProjectileStore projectiles{64};
+    ParticlePool particles{2048};
+    SoundCues cues{64};        // since the last frame played them
+    const int tickRate;
+    const float timestep;      // seconds per tick
+    float simAccumulator = 0.0f; // time since the last tick, under one timestep
+    double simTime = 0.0;
+    std::vector<Player> previousPlayers; // at the start of the last tick
+    
+    GameWorld(std::unique_ptr<TileMap> fixedMap, std::unique_ptr<WorldStream> streamed,
+              const std::vector<Room>& levelRooms, const GameAssets& gameAssets,
+              int enemyCount, int pickupCount, std::uint64_t levelSeed, int ticksPerSecond, int playerCount = 1,
+              WorkerPool* workers = nullptr, std::unique_ptr<RoomVisibility> knownVisibility = nullptr);
+    
+    bool allEnemiesDead() const {
+        for (std::uint8_t active : enemies.active) {
+            if (active) return false;
+        }
+        return true;
+    }
+};
+
+// FNV-1a over the players and every entity; a replayed demo must end on the
+// checksum its recording did, and net peers compare it as they play
+std::uint64_t worldChecksum(const GameWorld& world);
+
+// A fixed dungeon of the configured size, the window over a streamed
+// world whose first rooms come from the centre chunk, or the level and
+// state of play of a save, whose header config was given. Null when the
+// save does not fit its own header.
+std::unique_ptr<GameWorld> createWorld(const EngineConfig& config, const GameAssets& assets,
+                                       WorkerPool& workers, const SaveFile* save = nullptr);
+
+// Whole ticks due after deltaTime more seconds, at most MAX_SIM_STEPS; a
+// frame that falls further behind drops the rest rather than spiralling
+int dueTicks(GameWorld& world, float deltaTime);
+
+// One tick of play: each player moves and fires under its input, the
+// streamed window follows, then enemies, projectiles and blood advance.
+// inputs holds one per player slot. Nothing here reads a clock, so equal
+// inputs give equal worlds. Sounds are only cued, for the frame to play.
+void tickWorld(GameWorld& world, const PlayerInput* inputs);
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "profiler.hpp"
+
+// ===========================================
+// HUD
+// Retained-mode overlay. Text is formatted every frame into a fixed buffer
+// with std::to_chars, but it reaches SFML (allocation and glyph layout)
+// only when the characters actually changed. The status bar, health bar and
+// crosshair are quads in one vertex array over one texture, rebuilt only
+// when the health they show changes, so the whole HUD is a single batched
+// draw plus one draw per text field.
+// ===========================================
+
+enum class TextAlign { Left, Right };
+
+class CachedText {
+public:
+    static constexpr std::size_t Capacity = 128;
+
+    CachedText(const sf::Font& font, unsigned int size, sf::Color color,
+               sf::Vector2f anchor, TextAlign align = TextAlign::Left)
+        : m_text(font, "", size), m_anchor(anchor), m_align(align) {
+        m_text.setFillColor(color);
+        m_text.setPosition(anchor);
+    }
+
+    // Concatenates string literals and integers; the string is truncated at
+    // Capacity characters
+    template <typename... Parts>
+    void set(const Parts&... parts) {
+        char* out = m_next.data();
+        char* const end = m_next.data() + Capacity;
+        (append(out, end, parts), ...);
+        const auto length = static_cast<std::size_t>(out - m_next.data());
+        if (length == m_length && std::memcmp(m_next.data(), m_current.data(), length) == 0) return;
+
+        std::memcpy(m_current.data(), m_next.data(), length);
+        m_current[length] = '\0';
+        m_length = length;
+        m_text.setString(m_current.data());
+        if (m_align == TextAlign::Right) {
+            const sf::FloatRect bounds = m_text.getLocalBounds();
+            m_text.setPosition({m_anchor.x - bounds.position.x - bounds.size.x, m_anchor.y});
+        }
+        m_rebuilds++;
+    }
+
+    sf::Text& text() { return m_text; }
+    const sf::Text& text() const { return m_text; }
+    std::size_t rebuilds() const { return m_rebuilds; }
+
+private:
+    static void append(char*& out, char* end, const char* literal) {
+        while (*literal && out < end) *out++ = *literal++;
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    static void append(char*& out, char* end, T value) {
+        auto result = std::to_chars(out, end, value);
+        if (result.ec == std::errc()) out = result.ptr;
+    }
+
+    sf::Text m_text;
+    sf::Vector2f m_anchor;
+    TextAlign m_align;
+    std::array<char, Capacity> m_next{};
+    std::array<char, Capacity + 1> m_current{};
+    std::size_t m_length = 0;
+    std::size_t m_rebuilds = 0;
+};
+
+// Quads over one texture: the status bar image plus a row of white texels
+// under it that solid-colour quads sample, so both kinds share a draw
+class QuadBatch {
+public:
+    // Image on top of a white row; without one (null or empty) the atlas is
+    // a single texel
+    bool loadAtlas(const sf::Image* image) {
+        const bool loaded = image && image->getSize().x > 0 && image->getSize().y > 0;
+        const sf::Vector2u size = loaded ? image->getSize() : sf::Vector2u{1, 0};
+        sf::Image atlas({size.x, size.y + 1}, sf::Color::White);
+        if (loaded && !atlas.copy(*image, {0, 0})) return false;
+        m_imageSize = loaded ? sf::Vector2f(static_cast<float>(size.x), static_cast<float>(size.y)) : sf::Vector2f{};
+        m_white = {0.5f, size.y + 0.5f};
+        return m_texture.loadFromImage(atlas) && loaded;
+    }
+
+    bool hasImage() const { return m_imageSize.x > 0; }
+
+    void clear() { m_vertices.clear(); }
+
+    // The whole image, stretched over rect
+    void image(sf::FloatRect rect) {
+        quad(rect, {0.f, 0.f}, m_imageSize, sf::Color::White);
+    }
+
+    void solid(sf::FloatRect rect, sf::Color color) {
+        quad(rect, m_white, {0.f, 0.f}, color);
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        target.draw(m_vertices, sf::RenderStates(&m_texture));
+    }
+
+private:
+    void quad(sf::FloatRect rect, sf::Vector2f texPos, sf::Vector2f texSize, sf::Color color) {
+        const sf::Vector2f p0 = rect.position;
+        const sf::Vector2f p1 = rect.position + rect.size;
+        const sf::Vector2f t0 = texPos;
+        const sf::Vector2f t1 = texPos + texSize;
+        const sf::Vertex corners[6] = {
+            {{p0.x, p0.y}, color, {t0.x, t0.y}}, {{p1.x, p0.y}, color, {t1.x, t0.y}},
+            {{p0.x, p1.y}, color, {t0.x, t1.y}}, {{p1.x, p0.y}, color, {t1.x, t0.y}},
+            {{p1.x, p1.y}, color, {t1.x, t1.y}}, {{p0.x, p1.y}, color, {t0.x, t1.y}},
+        };
+        for (const sf::Vertex& vertex : corners) m_vertices.append(vertex);
+    }
+
+    sf::Texture m_texture;
+    sf::VertexArray m_vertices{sf::PrimitiveType::Triangles};
+    sf::Vector2f m_imageSize;
+    sf::Vector2f m_white;
+};
+
+// What the HUD shows; compared against the last frame's to skip work
+struct HudValues {
+    int health = 0;
+    int maxHealth = 100;
+    int ammo = 0;
+    int score = 0;
+    int kills = 0;
+    int enemies = 0;
+    int fps = 0;
+    std::size_t effects = 0;
+    std::size_t effectCapacity = 0;
+};
+
+// DOOM's widescreen STBAR (426x32) scaled to the screen width along the
+// bottom edge, with the numbers over its AMMO, HEALTH and FRAG boxes, a
+// health bar in the face box and the rest on the right-hand panel
+class Hud {
+public:
+    static constexpr float BAR_WIDTH = 426.0f; // STBAR pixels
+    static constexpr float BAR_HEIGHT = 32.0f;
+
+    // statusBar may be null, or set later once it has loaded
+    Hud(const sf::Font& font, const sf::Image* statusBar, sf::Vector2u screen)
+        : m_screen(static_cast<float>(screen.x), static_cast<float>(screen.y)),
+          m_scale(m_screen.x / BAR_WIDTH),
+          m_top(m_screen.y - BAR_HEIGHT * m_scale),
+          m_ammo(font, numberSize(), sf::Color(200, 0, 0), barPoint(97, 2), TextAlign::Right),
+          m_health(font, numberSize(), sf::Color(200, 0, 0), barPoint(143, 2), TextAlign::Right),
+          m_kills(font, numberSize(), sf::Color(200, 0, 0), barPoint(191, 2), TextAlign::Right),
+          m_score(font, infoSize(), sf::Color::White, barPoint(296, 3)),
+          m_stats(font, infoSize(), sf::Color::White, barPoint(296, 17)) {
+        m_hasBar = m_batch.loadAtlas(statusBar);
+    }
+
+    // Whether STBAR loaded; without it the bar is drawn as a dark backdrop
+    bool hasStatusBar() const { return m_hasBar; }
+
+    void setStatusBar(const sf::Image* statusBar) {
+        m_hasBar = m_batch.loadAtlas(statusBar);
+        m_built = false;
+    }
+
+    void update(const HudValues& values) {
+        m_ammo.set(values.ammo);
+        m_health.set(values.health, "%");
+        m_kills.set(values.kills);
+        m_score.set("SCORE ", values.score, "  KILLS ", values.kills, "/", values.enemies);
+        m_stats.set("FPS ", values.fps, "  FX ", values.effects, "/", values.effectCapacity);
+
+        if (!m_built || values.health != m_shown.health || values.maxHealth != m_shown.maxHealth) {
+            rebuildBatch(values);
+        }
+        m_shown = values;
+        m_built = true;
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        m_batch.draw(target);
+        target.draw(m_ammo.text());
+        target.draw(m_health.text());
+        target.draw(m_kills.text());
+        target.draw(m_score.text());
+        target.draw(m_stats.text());
+    }
+
+    // Times any text field was re-laid out, for checking the cache works
+    std::size_t textRebuilds() const {
+        return m_ammo.rebuilds() + m_health.rebuilds() + m_kills.rebuilds() +
+               m_score.rebuilds() + m_stats.rebuilds();
+    }
+
+    std::size_t batchRebuilds() const { return m_batchRebuilds; }
+
+private:
+    unsigned int numberSize() const { return static_cast<unsigned int>(16 * m_scale); }
+    unsigned int infoSize() const { return static_cast<unsigned int>(5 * m_scale); }
+
+    // Screen position of a point on the status bar, in STBAR pixels
+    sf::Vector2f barPoint(float x, float y) const { return {x * m_scale, m_top + y * m_scale}; }
+
+    void rebuildBatch(const HudValues& values) {
+        m_batch.clear();
+        const sf::FloatRect bar({0.f, m_top}, {m_screen.x, m_screen.y - m_top});
+        if (m_batch.hasImage()) {
+            m_batch.image(bar);
+        } else {
+            m_batch.solid(bar, sf::Color(0, 0, 0, 180));
+        }
+
+        // Health fills the face box from the bottom
+        const sf::Vector2f box0 = barPoint(197, 1);
+        const sf::Vector2f box1 = barPoint(235, 31);
+        const float fraction = std::clamp(static_cast<float>(values.health) / std::max(values.maxHealth, 1), 0.f, 1.f);
+        const float height = (box1.y - box0.y) * fraction;
+        m_batch.solid(sf::FloatRect({box0.x, box1.y - height}, {box1.x - box0.x, height}),
+                      values.health > 50 ? sf::Color::Green : values.health > 25 ? sf::Color::Yellow : sf::Color::Red);
+
+        // Crosshair, centred on the view above the bar
+        const sf::Vector2f centre(m_screen.x / 2.f, m_screen.y / 2.f);
+        m_batch.solid(sf::FloatRect({centre.x - 10.f, centre.y - 1.f}, {20.f, 2.f}), sf::Color::Green);
+        m_batch.solid(sf::FloatRect({centre.x - 1.f, centre.y - 10.f}, {2.f, 20.f}), sf::Color::Green);
+        m_batchRebuilds++;
+    }
+
+    sf::Vector2f m_screen;
+    float m_scale;
+    float m_top;
+    QuadBatch m_batch;
+    bool m_hasBar = false;
+    CachedText m_ammo;
+    CachedText m_health;
+    CachedText m_kills;
+    CachedText m_score;
+    CachedText m_stats;
+    HudValues m_shown;
+    bool m_built = false;
+    std::size_t m_batchRebuilds = 0;
+};
+
+// Frame profiler readout in the top-left corner: frame average and
+// percentiles, then the average of every stage. Text is refreshed at most
+// twice a second so it stays readable and cheap.
+class ProfilerOverlay {
+public:
+    static constexpr float REFRESH_SECONDS = 0.5f;
+
+    ProfilerOverlay(const sf::Font& font, sf::Vector2f position, unsigned int size = 14) {
+        const float lineHeight = size * 1.3f;
+        m_lines.reserve(PROFILE_STAGE_COUNT + 2);
+        for (int i = 0; i < PROFILE_STAGE_COUNT + 2; i++) {
+            m_lines.emplace_back(font, size, sf::Color::White, sf::Vector2f(position.x + 6.f, position.y + 4.f + i * lineHeight));
+        }
+        m_backdrop.setPosition(position);
+        m_backdrop.setSize({260.f, 8.f + m_lines.size() * lineHeight});
+        m_backdrop.setFillColor(sf::Color(0, 0, 0, 160));
+    }
+
+    bool visible = false;
+
+    void update(const FrameProfiler& profiler) {
+        if (m_clock.getElapsedTime().asSeconds() < REFRESH_SECONDS) return;
+        m_clock.restart();
+
+        const ProfileSummary summary = profiler.summary();
+        if (summary.frames == 0) {
+            m_lines[0].set("Profiler compiled out");
+            return;
+        }
+        m_lines[0].set("Frame ", micros(summary.frameAverageUs), " us  p50 ", micros(summary.frameP50Us),
+                       "  p99 ", micros(summary.frameP99Us));
+        for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+            m_lines[i + 1].set(profileStageName(static_cast<ProfileStage>(i)), "  ",
+                               micros(summary.stageAverageUs[i]), " us");
+        }
+        if (profiler.capturing()) {
+            m_lines.back().set("Capturing, ", profiler.droppedSamples(), " dropped");
+        } else {
+            m_lines.back().set("");
+        }
+    }
+
+    void draw(sf::RenderTarget& target) const {
+        if (!visible) return;
+        target.draw(m_backdrop);
+        for (const CachedText& line : m_lines) target.draw(line.text());
+    }
+
+private:
+    static long micros(double us) { return static_cast<long>(us + 0.5); }
+
+    std::vector<CachedText> m_lines;
+    sf::RectangleShape m_backdrop;
+    sf::Clock m_clock;
+};
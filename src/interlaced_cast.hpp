@@ -0,0 +1,217 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "ray_packet.hpp"
+
+// ===========================================
+// INTERLACED CASTING
+// Casts every other column each frame, even columns on one frame and odd
+// ones on the next, and rebuilds the rest from wall faces that are already
+// known. A face is the side of one wall cell, so the ray through a missing
+// column can be intersected with it exactly. If the ray lands inside the
+// face's cell, the result is a real wall hit, and the true hit can only
+// be nearer. Each missing column therefore takes the nearest face that
+// its ray crosses. The candidates are last frame's faces, reprojected into
+// this frame's camera, and the faces this frame cast on either side. Only
+// a column that none of them covers pays for a DDA.
+//
+// Walls between two columns thinner than a column, such as a distant
+// corner, can be missed for a frame. Frames that turn or move too far
+// since the last one, or that change the view size, are cast in full, as
+// their history would mostly miss.
+// ===========================================
+
+class InterlacedCaster {
+public:
+    // Frames turning more than maxTurn radians, or moving more than maxMove
+    // tiles, since the previous frame are cast in full
+    explicit InterlacedCaster(double maxTurn, double maxMove = 0.5)
+        : m_maxTurn(maxTurn), m_maxMove(maxMove) {}
+
+    // Plans a frame. True when only half the columns are cast: castHalf
+    // then rebuildHalf over [0, halfColumns()), after which record.
+    bool begin(const RayCamera& cam, unsigned int width) {
+        bool interlaced = false;
+        if (m_valid && width == m_width && width % 2 == 0) {
+            const double turn = std::abs(std::atan2(m_cam.dirX * cam.dirY - m_cam.dirY * cam.dirX,
+                                                    m_cam.dirX * cam.dirX + m_cam.dirY * cam.dirY));
+            const double move = std::hypot(cam.posX - m_cam.posX, cam.posY - m_cam.posY);
+            interlaced = turn <= m_maxTurn && move <= m_maxMove;
+        }
+        if (!interlaced) {
+            m_fullFrames++;
+            return false;
+        }
+        m_parity ^= 1;
+        m_interlacedFrames++;
+        reproject(cam);
+        return true;
+    }
+
+    // Columns of each parity on an interlaced frame
+    int halfColumns() const { return static_cast<int>(m_width / 2); }
+
+    // Casts columns 2k + parity for k in [begin, end) into hits, indexed by
+    // column. The columns of one parity are a screen half as wide, seen by
+    // a camera turned across by the parity's offset, so the packet kernels
+    // cast them unchanged.
+    void castHalf(RayIsa isa, const RayCamera& cam, const RayGrid& grid, int begin, int end, RayHit* hits) {
+        RayCamera half = cam;
+        const double offset = 2.0 * m_parity / m_width;
+        half.dirX += cam.planeX * offset;
+        half.dirY += cam.planeY * offset;
+        castRayRange(isa, half, grid, m_width / 2, begin, end, &m_half[begin]);
+        for (int k = begin; k < end; k++) hits[2 * k + m_parity] = m_half[k];
+    }
+
+    // Fills columns 2k + 1 - parity for k in [begin, end), once castHalf
+    // has finished every column
+    void rebuildHalf(RayIsa isa, const RayCamera& cam, const RayGrid& grid, int begin, int end, RayHit* hits) {
+        std::size_t rebuilt = 0;
+        const int width = static_cast<int>(m_width);
+        for (int k = begin; k < end; k++) {
+            const int x = 2 * k + 1 - m_parity;
+            double rayDirX, rayDirY;
+            rayDirection(cam, m_width, x, rayDirX, rayDirY);
+
+            bool found = false;
+            RayHit best{}, candidate{};
+            auto consider = [&](const Face& face) {
+                if (!face.valid || !intersect(cam, rayDirX, rayDirY, face, candidate)) return;
+                if (!found || candidate.perpWallDist < best.perpWallDist) best = candidate;
+                found = true;
+            };
+            if (m_candidate[x] >= 0) consider(m_faces[m_candidate[x]]);
+            if (x > 0) consider(faceOf(cam, m_width, x - 1, hits[x - 1]));
+            if (x + 1 < width) consider(faceOf(cam, m_width, x + 1, hits[x + 1]));
+
+            if (found) {
+                hits[x] = best;
+                rebuilt++;
+            } else {
+                castRayRange(isa, cam, grid, m_width, x, x + 1, &hits[x]);
+            }
+        }
+        m_rebuilt += rebuilt;
+        m_recast += static_cast<std::size_t>(end - begin) - rebuilt;
+    }
+
+    // Keeps this frame's hits, every column of them, as the next frame's history
+    void record(const RayCamera& cam, unsigned int width, const RayHit* hits) {
+        if (width != m_width) {
+            m_width = width;
+            m_faces.resize(width);
+            m_candidate.resize(width);
+            m_depth.resize(width);
+            m_half.resize(width / 2 + 1);
+        }
+        for (unsigned int x = 0; x < width; x++) m_faces[x] = faceOf(cam, width, static_cast<int>(x), hits[x]);
+        m_cam = cam;
+        m_valid = true;
+    }
+
+    // Forgets the history, as when the map changes under it
+    void reset() { m_valid = false; }
+
+    std::size_t interlacedFrames() const { return m_interlacedFrames; }
+    std::size_t fullFrames() const { return m_fullFrames; }
+
+    // Missing columns on interlaced frames, rebuilt from a face or cast after all
+    std::size_t rebuiltColumns() const { return m_rebuilt; }
+    std::size_t recastColumns() const { return m_recast; }
+
+private:
+    // The side of a wall cell one hit landed on: the line x = plane for
+    // side 0, or y = plane for side 1, which rays cross going the step's
+    // way. along is where on the line the hit was, and names the cell.
+    struct Face {
+        bool valid = false;
+        int side = 0;
+        int step = 1;
+        double plane = 0;
+        double along = 0;
+    };
+
+    static Face faceOf(const RayCamera& cam, unsigned int width, int x, const RayHit& hit) {
+        Face face;
+        // finishRay clamps nearer hits to 0.1, so their hit point is unknown
+        if (hit.perpWallDist <= 0.1) return face;
+        double rayDirX, rayDirY;
+        rayDirection(cam, width, x, rayDirX, rayDirY);
+        face.side = hit.side;
+        if (hit.side == 0) {
+            face.step = rayDirX < 0 ? -1 : 1;
+            face.plane = std::round(cam.posX + hit.perpWallDist * rayDirX);
+            face.along = cam.posY + hit.perpWallDist * rayDirY;
+        } else {
+            face.step = rayDirY < 0 ? -1 : 1;
+            face.plane = std::round(cam.posY + hit.perpWallDist * rayDirY);
+            face.along = cam.posX + hit.perpWallDist * rayDirX;
+        }
+        // A hit on a cell corner could be rounded into the cell next to it
+        const double fraction = face.along - std::floor(face.along);
+        face.valid = fraction > 1e-6 && fraction < 1 - 1e-6;
+        return face;
+    }
+
+    // The ray's hit on face, like finishRay would give it; false when the
+    // ray meets the line from behind or outside the face's cell
+    static bool intersect(const RayCamera& cam, double rayDirX, double rayDirY, const Face& face, RayHit& out) {
+        const double across = face.side == 0 ? rayDirX : rayDirY;
+        if (across == 0 || (across < 0 ? -1 : 1) != face.step) return false;
+        const double distance = (face.plane - (face.side == 0 ? cam.posX : cam.posY)) / across;
+        if (distance <= 0.1) return false;
+
+        const double along = face.side == 0 ? cam.posY + distance * rayDirY : cam.posX + distance * rayDirX;
+        const double cell = std::floor(face.along);
+        if (along < cell || along >= cell + 1) return false;
+        double wallX = along - cell;
+        if ((face.side == 0 && rayDirX > 0) || (face.side == 1 && rayDirY < 0)) wallX = 1 - wallX;
+        out = {distance, face.side, wallX};
+        return true;
+    }
+
+    // Projects last frame's hit points into this frame, like sprites, and
+    // keeps the nearest face landing on each missing column
+    void reproject(const RayCamera& cam) {
+        std::fill(m_candidate.begin(), m_candidate.end(), -1);
+        const double invDet = 1.0 / (cam.planeX * cam.dirY - cam.dirX * cam.planeY);
+        const int width = static_cast<int>(m_width);
+        for (int h = 0; h < width; h++) {
+            const Face& face = m_faces[h];
+            if (!face.valid) continue;
+            const double pointX = (face.side == 0 ? face.plane : face.along) - cam.posX;
+            const double pointY = (face.side == 0 ? face.along : face.plane) - cam.posY;
+            const double depth = invDet * (-cam.planeY * pointX + cam.planeX * pointY);
+            if (depth <= 0.1) continue;
+            const double across = invDet * (cam.dirY * pointX - cam.dirX * pointY);
+            const long x = std::lround(m_width / 2.0 * (1 + across / depth));
+            if (x < 0 || x >= width || (x & 1) == m_parity) continue;
+            if (m_candidate[x] < 0 || depth < m_depth[x]) {
+                m_candidate[x] = h;
+                m_depth[x] = depth;
+            }
+        }
+    }
+
+    double m_maxTurn;
+    double m_maxMove;
+    bool m_valid = false;
+    int m_parity = 0;
+    unsigned int m_width = 0;
+    RayCamera m_cam{};
+    std::vector<Face> m_faces;      // last frame's, by column
+    std::vector<int> m_candidate;   // reprojected face per missing column, -1 for none
+    std::vector<double> m_depth;
+    std::vector<RayHit> m_half;     // castHalf's packets before they are spread out
+
+    std::size_t m_interlacedFrames = 0;
+    std::size_t m_fullFrames = 0;
+    std::atomic<std::size_t> m_rebuilt{0};
+    std::atomic<std::size_t> m_recast{0};
+};
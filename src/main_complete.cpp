@@ -2,541 +2,530 @@
 #include <SFML/Audio.hpp>
 #include <vector>
 #include <random>
-#include <ctime>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
-#include <sstream>
 #include <iomanip>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <string>
+
+#include "engine_config.hpp"
+#include "game_assets.hpp"
+#include "game_world.hpp"
+#include "world_save.hpp"
+#include "raycast_renderer.hpp"
+#include "hud.hpp"
+#include "profiler.hpp"
+#include "demo.hpp"
+#include "audio_engine.hpp"
+#include "net_session.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 // ===========================================
 // COMPLETE DOOM-STYLE GAME
-// With Mouse Controls & Full Asset Integration
+// With Mouse Controls & Full Asset Integration. The complete edition: the
+// engine library plus demos, saves, net play and the benchmarks, over any
+// renderer backend picked at runtime.
 // ===========================================
 
-constexpr unsigned int SCREEN_WIDTH = 1280;
-constexpr unsigned int SCREEN_HEIGHT = 720;
-constexpr int MAP_WIDTH = 64;
-constexpr int MAP_HEIGHT = 64;
-
-// Movement constants (from DOOM)
-constexpr double MOVE_SPEED = 5.0;
-constexpr double STRAFE_SPEED = 4.5;
-constexpr double ROT_SPEED = 3.0;
-constexpr double MOUSE_SENSITIVITY = 0.002;
-constexpr double PLAYER_RADIUS = 0.3;
-constexpr double FRICTION = 0.90;
-
-enum class GameState { Title, Playing, Victory, GameOver };
-enum class TileType { Empty = 0, Wall = 1 };
-enum class EnemyType { Wolf, SmokeDemon, TophatOgre, RedDemon };
+// The bench target sets this so the binary runs its scenarios by default
+#ifndef ENGINE_BENCH
+#define ENGINE_BENCH 0
+#endif
 
-// Player struct
-struct Player {
-    double posX, posY;
-    double dirX, dirY;
-    double planeX, planeY;
-    double momX, momY;
-    int health;
-    int maxHealth;
-    int ammo;
-    int score;
-    int kills;
-    
-    Player(double x, double y) 
-        : posX(x), posY(y), dirX(-1), dirY(0), planeX(0), planeY(0.66),
-          momX(0), momY(0), health(100), maxHealth(100), ammo(50), score(0), kills(0) {}
-};
-
-// Enemy
-struct Enemy {
-    double x, y;
-    EnemyType type;
-    int health;
-    int maxHealth;
-    float speed;
-    double dirX, dirY;
-    bool active;
-    sf::Clock attackClock;
-    const sf::Texture* texture;
-    sf::IntRect textureRect;
-    
-    Enemy(double px, double py, EnemyType t, int hp, float spd, 
-          const sf::Texture* tex, sf::IntRect rect)
-        : x(px), y(py), type(t), health(hp), maxHealth(hp), speed(spd), 
-          dirX(0), dirY(0), active(true), texture(tex), textureRect(rect) {}
-};
+// How long a net game client looks for its host, and a host waits for
+// its players
+constexpr std::chrono::seconds JOIN_TIMEOUT{30};
+constexpr std::chrono::seconds HOST_TIMEOUT{120};
+static_assert(LockstepSession::MAX_PLAYERS == MAX_PLAYERS, "a net game's slots are the world's player slots");
 
-// Projectile
-struct Projectile {
-    double x, y, dirX, dirY;
-    float speed;
-    int damage;
-    bool fromPlayer;
-    sf::Clock lifeClock;
-    
-    Projectile(double px, double py, double dx, double dy, bool player = true)
-        : x(px), y(py), dirX(dx), dirY(dy), speed(12.0f), 
-          damage(player ? 25 : 10), fromPlayer(player) {}
-};
-
-// Blood particle
-struct BloodParticle {
-    double x, y, z, velX, velY, velZ;
-    sf::Clock lifeClock;
-    float lifetime;
-    sf::Color color;
-    
-    BloodParticle(double px, double py, double vx, double vy)
-        : x(px), y(py), z(0.5), velX(vx), velY(vy), velZ(0.5), 
-          lifetime(0.8f), color(sf::Color::Red) {}
-};
-
-// Pickup items
-struct Pickup {
-    double x, y;
-    enum Type { HealthPack, Ammo, Armor } type;
-    int value;
-    bool active;
-    sf::Clock bobClock;
-    
-    Pickup(double px, double py, Type t, int v)
-        : x(px), y(py), type(t), value(v), active(true) {}
-};
-
-// Room for dungeon generation
-struct Room {
-    int x, y, w, h;
-    int centerX() const { return x + w / 2; }
-    int centerY() const { return y + h / 2; }
-};
+enum class GameState { Loading, Title, Playing, Victory, GameOver };
 
 // ===========================================
-// COLLISION DETECTION
+// DDA BENCHMARK
 // ===========================================
 
-bool checkCollision(const std::vector<std::vector<TileType>>& map, 
-                    double x, double y, double radius) {
-    double corners[4][2] = {
-        {x - radius, y - radius}, {x + radius, y - radius},
-        {x - radius, y + radius}, {x + radius, y + radius}
-    };
+// Checks every available packet kernel against the scalar castRay on a set of
+// camera poses, then reports rays/sec per ISA on one thread. Returns non-zero
+// if any kernel disagrees with the scalar path.
+int runDdaBench(const EngineConfig& config) {
+    TileMap map(config.mapWidth, config.mapHeight);
+    std::vector<Room> rooms;
+    generateDungeon(map, rooms, config.seed);
+    RayGrid grid = map.rayGrid();
     
-    for (int i = 0; i < 4; i++) {
-        int mapX = static_cast<int>(corners[i][0]);
-        int mapY = static_cast<int>(corners[i][1]);
-        
-        if (mapX < 0 || mapX >= MAP_WIDTH || mapY < 0 || mapY >= MAP_HEIGHT) {
-            return true;
+    // 16 view directions from the centre of every room
+    std::vector<Player> poses;
+    for (const auto& room : rooms) {
+        for (int i = 0; i < 16; i++) {
+            double angle = i * (2 * 3.14159265358979 / 16) + 0.01;
+            Player pose(room.centerX() + 0.37, room.centerY() + 0.61);
+            pose.dirX = std::cos(angle);
+            pose.dirY = std::sin(angle);
+            pose.planeX = -pose.dirY * 0.66;
+            pose.planeY = pose.dirX * 0.66;
+            poses.push_back(pose);
         }
-        if (map[mapY][mapX] == TileType::Wall) {
-            return true;
-        }
-    }
-    return false;
-}
-
-void tryMoveWithSlide(Player& player, 
-                      const std::vector<std::vector<TileType>>& map,
-                      double targetX, double targetY) {
-    if (!checkCollision(map, targetX, targetY, PLAYER_RADIUS)) {
-        player.posX = targetX;
-        player.posY = targetY;
-        return;
     }
-    
-    if (!checkCollision(map, targetX, player.posY, PLAYER_RADIUS)) {
-        player.posX = targetX;
-        return;
+    if (poses.empty()) {
+        std::cerr << "No rooms generated\n";
+        return 1;
     }
     
-    if (!checkCollision(map, player.posX, targetY, PLAYER_RADIUS)) {
-        player.posY = targetY;
-        return;
+    std::vector<RayHit> reference(SCREEN_WIDTH), hits(SCREEN_WIDTH);
+    int failures = 0;
+    for (RayIsa isa : {RayIsa::Scalar, RayIsa::SSE2, RayIsa::AVX2, RayIsa::NEON}) {
+        if (!rayIsaSupported(isa)) continue;
+        
+        int mismatches = 0;
+        for (const auto& pose : poses) {
+            for (int x = 0; x < static_cast<int>(SCREEN_WIDTH); x++) reference[x] = castRay(pose, map, SCREEN_WIDTH, x);
+            castRayRange(isa, rayCamera(pose), grid, SCREEN_WIDTH, 0, SCREEN_WIDTH, hits.data());
+            for (int x = 0; x < static_cast<int>(SCREEN_WIDTH); x++) {
+                if (hits[x].perpWallDist != reference[x].perpWallDist ||
+                    hits[x].side != reference[x].side || hits[x].wallX != reference[x].wallX) {
+                    mismatches++;
+                }
+            }
+        }
+        
+        constexpr int ROUNDS = 20;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < ROUNDS; round++) {
+            for (const auto& pose : poses) {
+                castRayRange(isa, rayCamera(pose), grid, SCREEN_WIDTH, 0, SCREEN_WIDTH, hits.data());
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rays = static_cast<double>(ROUNDS) * poses.size() * SCREEN_WIDTH;
+        
+        std::cout << std::setw(7) << rayIsaName(isa) << ": "
+                  << std::fixed << std::setprecision(1) << rays / seconds / 1e6 << " Mrays/s, "
+                  << (mismatches == 0 ? "matches scalar" : "MISMATCH") << " ("
+                  << mismatches << " of " << poses.size() * SCREEN_WIDTH << " rays differ)\n";
+        if (mismatches > 0) failures++;
     }
+    return failures == 0 ? 0 : 1;
 }
 
 // ===========================================
-// PLAYER MOVEMENT
+// FLOW FIELD BENCHMARK
 // ===========================================
 
-void updatePlayerMovement(Player& player, 
-                          const std::vector<std::vector<TileType>>& map,
-                          float deltaTime,
-                          float mouseDeltaX) {
-    bool moving = false;
-    
-    // Keyboard movement
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) {
-        player.momX += player.dirX * MOVE_SPEED * deltaTime;
-        player.momY += player.dirY * MOVE_SPEED * deltaTime;
-        moving = true;
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) {
-        player.momX -= player.dirX * MOVE_SPEED * deltaTime;
-        player.momY -= player.dirY * MOVE_SPEED * deltaTime;
-        moving = true;
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
-        player.momX += player.planeX * STRAFE_SPEED * deltaTime;
-        player.momY += player.planeY * STRAFE_SPEED * deltaTime;
-        moving = true;
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
-        player.momX -= player.planeX * STRAFE_SPEED * deltaTime;
-        player.momY -= player.planeY * STRAFE_SPEED * deltaTime;
-        moving = true;
-    }
-    
-    // Apply friction
-    if (!moving) {
-        player.momX *= FRICTION;
-        player.momY *= FRICTION;
-        if (std::abs(player.momX) < 0.001) player.momX = 0;
-        if (std::abs(player.momY) < 0.001) player.momY = 0;
-    }
-    
-    // Apply momentum
-    double targetX = player.posX + player.momX * deltaTime;
-    double targetY = player.posY + player.momY * deltaTime;
-    tryMoveWithSlide(player, map, targetX, targetY);
-    
-    // Mouse rotation
-    if (std::abs(mouseDeltaX) > 0.001) {
-        double rotAngle = -mouseDeltaX * MOUSE_SENSITIVITY;
-        double oldDirX = player.dirX;
-        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
-        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
-        
-        double oldPlaneX = player.planeX;
-        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
-        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
+// At least 10,000 enemies on a 256x256 dungeon (more with --enemies and
+// --map-size). Times a whole-map BFS, then one steering step for growing
+// crowds: the field is paid for once, so cost per enemy stays flat.
+int runFlowBench(const EngineConfig& config) {
+    const int size = std::max(config.mapWidth, 256);
+    const int enemyCount = std::max(config.enemyCount, 10000);
+    
+    TileMap map(size, size);
+    std::vector<Room> rooms;
+    generateDungeon(map, rooms, config.seed);
+    if (rooms.empty()) {
+        std::cerr << "No rooms generated\n";
+        return 1;
+    }
+    
+    FlowField flow(size, size);
+    const Room& target = rooms[0];
+    
+    // Full-map rebuilds, one per room centre
+    auto start = std::chrono::steady_clock::now();
+    std::size_t builds = std::min<std::size_t>(rooms.size(), 16);
+    for (std::size_t i = 0; i < builds; i++) {
+        flow.build(map, rooms[i].centerX(), rooms[i].centerY());
+    }
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    flow.build(map, target.centerX(), target.centerY());
+    std::cout << "Map " << size << "x" << size << ": BFS " << std::fixed << std::setprecision(2)
+              << buildMs / builds << " ms per rebuild, " << flow.reachedCells() << " cells reached\n";
+    
+    // Enemies on random reachable tiles
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> coord(0, size - 1);
+    EnemyStore enemies;
+    enemies.reserve(enemyCount);
+    SpatialHash enemyIndex(size, size);
+    while (static_cast<int>(enemies.size()) < enemyCount) {
+        int x = coord(rng), y = coord(rng);
+        if (flow.distance(x, y) == FlowField::Unreached) continue;
+        enemyIndex.insert(static_cast<int>(enemies.size()), x + 0.5, y + 0.5);
+        enemies.add(x + 0.5, y + 0.5, EnemyType::Wolf, 50, 2.0f);
     }
     
-    // Arrow key rotation
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) {
-        double rotAngle = ROT_SPEED * deltaTime;
-        double oldDirX = player.dirX;
-        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
-        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
+    const double targetX = target.centerX() + 0.5;
+    const double targetY = target.centerY() + 0.5;
+    constexpr int STEPS = 120;
+    for (int crowd : {enemyCount / 10, enemyCount / 4, enemyCount / 2, enemyCount}) {
+        std::uint64_t before = 0;
+        for (int id = 0; id < crowd; id++) {
+            before += flow.distance(static_cast<int>(enemies.x[id]), static_cast<int>(enemies.y[id]));
+        }
         
-        double oldPlaneX = player.planeX;
-        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
-        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
-    }
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) {
-        double rotAngle = -ROT_SPEED * deltaTime;
-        double oldDirX = player.dirX;
-        player.dirX = player.dirX * std::cos(rotAngle) - player.dirY * std::sin(rotAngle);
-        player.dirY = oldDirX * std::sin(rotAngle) + player.dirY * std::cos(rotAngle);
+        start = std::chrono::steady_clock::now();
+        for (int step = 0; step < STEPS; step++) {
+            for (int id = 0; id < crowd; id++) {
+                moveEnemy(enemies, id, enemyIndex, flow, map, targetX, targetY, 1.0f / DEFAULT_TICK_RATE);
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
         
-        double oldPlaneX = player.planeX;
-        player.planeX = player.planeX * std::cos(rotAngle) - player.planeY * std::sin(rotAngle);
-        player.planeY = oldPlaneX * std::sin(rotAngle) + player.planeY * std::cos(rotAngle);
+        std::uint64_t after = 0;
+        for (int id = 0; id < crowd; id++) {
+            after += flow.distance(static_cast<int>(enemies.x[id]), static_cast<int>(enemies.y[id]));
+        }
+        
+        std::cout << std::setw(6) << crowd << " enemies: " << std::setprecision(1)
+                  << seconds * 1e9 / (static_cast<double>(STEPS) * crowd) << " ns per enemy step, "
+                  << std::setprecision(2) << seconds * 1e3 / STEPS << " ms per step, path length "
+                  << before / static_cast<double>(crowd) << " -> " << after / static_cast<double>(crowd) << "\n";
     }
+    return 0;
 }
 
 // ===========================================
-// DUNGEON GENERATION
+// DUNGEON GENERATION BENCHMARK
 // ===========================================
 
-void generateDungeon(std::vector<std::vector<TileType>>& map, std::vector<Room>& rooms) {
-    for (int y = 0; y < MAP_HEIGHT; y++) {
-        for (int x = 0; x < MAP_WIDTH; x++) {
-            map[y][x] = TileType::Wall;
+// FNV-1a over the map in row-major order; equal seeds and sizes must give
+// equal checksums on every platform
+std::uint64_t mapChecksum(const TileMap& map) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    for (int y = 0; y < map.height(); y++) {
+        for (int x = 0; x < map.width(); x++) {
+            hash = (hash ^ static_cast<std::uint8_t>(map.at(x, y))) * 0x100000001B3ull;
         }
     }
+    return hash;
+}
+
+// Maps per second from 64x64 up to 4096x4096, on one thread and on the
+// worker pool, and a check that both give the same map for the same seed
+int runGenBench(const EngineConfig& config) {
+    WorkerPool workers(config.workerThreads > 0 ? config.workerThreads : WorkerPool::hardwareThreads());
+    std::cout << "Seed " << config.seed << ", " << workers.size() << " worker thread(s)\n";
     
-    std::mt19937 rng(static_cast<unsigned>(std::time(nullptr)));
-    std::uniform_int_distribution<int> roomCountDist(20, 30);
-    std::uniform_int_distribution<int> roomSizeDist(5, 12);
-    
-    int numRooms = roomCountDist(rng);
-    
-    for (int i = 0; i < numRooms * 3; i++) {
-        int w = roomSizeDist(rng);
-        int h = roomSizeDist(rng);
-        int x = std::uniform_int_distribution<int>(2, MAP_WIDTH - w - 2)(rng);
-        int y = std::uniform_int_distribution<int>(2, MAP_HEIGHT - h - 2)(rng);
+    int failures = 0;
+    for (int size = 64; size <= 4096; size *= 2) {
+        TileMap map(size, size);
+        std::vector<Room> rooms;
         
-        bool overlap = false;
-        for (const auto& room : rooms) {
-            if (!(x + w + 1 < room.x || x > room.x + room.w + 1 ||
-                  y + h + 1 < room.y || y > room.y + room.h + 1)) {
-                overlap = true;
-                break;
-            }
-        }
+        generateDungeon(map, rooms, config.seed);
+        const std::uint64_t serialChecksum = mapChecksum(map);
+        const std::size_t serialRooms = rooms.size();
+        generateDungeon(map, rooms, config.seed, &workers);
+        const bool identical = mapChecksum(map) == serialChecksum && rooms.size() == serialRooms;
+        if (!identical) failures++;
         
-        if (!overlap) {
-            rooms.push_back({x, y, w, h});
-            for (int ry = y; ry < y + h; ry++) {
-                for (int rx = x; rx < x + w; rx++) {
-                    map[ry][rx] = TileType::Empty;
-                }
-            }
-            
-            if (rooms.size() >= static_cast<size_t>(numRooms)) break;
-        }
+        // Repeat for at least a quarter second, over consecutive seeds
+        auto mapsPerSecond = [&](WorkerPool* pool) {
+            int maps = 0;
+            auto start = std::chrono::steady_clock::now();
+            double seconds = 0.0;
+            do {
+                generateDungeon(map, rooms, config.seed + maps, pool);
+                maps++;
+                seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            } while (seconds < 0.25);
+            return maps / seconds;
+        };
+        const double serial = mapsPerSecond(nullptr);
+        const double parallel = mapsPerSecond(&workers);
+        
+        std::cout << std::setw(4) << size << "x" << std::left << std::setw(4) << size << std::right
+                  << " " << std::setw(7) << serialRooms << " rooms  " << std::fixed << std::setprecision(1)
+                  << std::setw(9) << serial << " maps/s serial  " << std::setw(9) << parallel
+                  << " maps/s parallel  checksum " << std::hex << serialChecksum << std::dec
+                  << (identical ? "" : "  MISMATCH") << "\n";
     }
     
-    // Connect rooms
-    for (size_t i = 1; i < rooms.size(); i++) {
-        int x1 = rooms[i-1].centerX();
-        int y1 = rooms[i-1].centerY();
-        int x2 = rooms[i].centerX();
-        int y2 = rooms[i].centerY();
-        
-        for (int x = std::min(x1, x2); x <= std::max(x1, x2); x++) {
-            if (y1 >= 0 && y1 < MAP_HEIGHT && x >= 0 && x < MAP_WIDTH) {
-                map[y1][x] = TileType::Empty;
-                if (y1 + 1 < MAP_HEIGHT) map[y1 + 1][x] = TileType::Empty;
+    // Streamed world: walk east across 32 chunks at a tile every 1.5 ms,
+    // over a hundred times running speed, and time the updates, which only
+    // copy in chunks the threads have already built. Late counts chunk
+    // crossings that found the new centre chunk missing.
+    WorldStream stream(config.seed, WorldStreamSettings{});
+    stream.fillWindow();
+    const int chunkSize = stream.chunkSize();
+    const int radius = stream.windowRadius();
+    double walkX = (radius + 0.5) * chunkSize;
+    const double walkY = walkX;
+    double worstMs = 0.0;
+    int late = 0;
+    for (int step = 0; step < 32 * chunkSize; step++) {
+        std::this_thread::sleep_for(std::chrono::microseconds(1500));
+        walkX += 1.0;
+        int shiftX = 0, shiftY = 0;
+        auto start = std::chrono::steady_clock::now();
+        stream.update(walkX, walkY, 1.0, 0.0, shiftX, shiftY);
+        worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        walkX -= shiftX;
+        if (shiftX != 0 && !stream.slot(radius, radius)) late++;
+    }
+    stream.fillWindow();
+    
+    // The window must match chunks built from scratch, and every chunk's
+    // first room must be reachable from the centre one through the doors
+    FlowField flow(stream.map().width(), stream.map().height());
+    const WorldChunk* centre = stream.slot(radius, radius);
+    flow.build(stream.map(), radius * chunkSize + centre->rooms.front().centerX(),
+               radius * chunkSize + centre->rooms.front().centerY());
+    TileMap rebuilt(chunkSize, chunkSize);
+    std::vector<Room> rebuiltRooms;
+    int reached = 0, matching = 0, slots = 0;
+    for (int sy = 0; sy <= 2 * radius; sy++) {
+        for (int sx = 0; sx <= 2 * radius; sx++) {
+            const WorldChunk* chunk = stream.slot(sx, sy);
+            if (!chunk) continue;
+            slots++;
+            generateChunk(rebuilt, chunkSize, config.seed, chunk->coord.x, chunk->coord.y, rebuiltRooms);
+            bool same = true;
+            for (int y = 0; y < chunkSize && same; y++) {
+                for (int x = 0; x < chunkSize; x++) {
+                    if (rebuilt.at(x, y) != chunk->tiles[static_cast<std::size_t>(y) * chunkSize + x]) same = false;
+                }
             }
-        }
-        
-        for (int y = std::min(y1, y2); y <= std::max(y1, y2); y++) {
-            if (y >= 0 && y < MAP_HEIGHT && x2 >= 0 && x2 < MAP_WIDTH) {
-                map[y][x2] = TileType::Empty;
-                if (x2 + 1 < MAP_WIDTH) map[y][x2 + 1] = TileType::Empty;
+            matching += same;
+            if (!chunk->rooms.empty() &&
+                flow.distance(sx * chunkSize + chunk->rooms.front().centerX(),
+                              sy * chunkSize + chunk->rooms.front().centerY()) != FlowField::Unreached) {
+                reached++;
             }
         }
     }
-    
-    std::cout << "Generated " << rooms.size() << " rooms\n";
+    const int windowChunks = (2 * radius + 1) * (2 * radius + 1);
+    std::cout << "Streaming: " << stream.generatedChunks() << " chunks generated, " << stream.cachedChunks()
+              << " of " << stream.cacheCapacity() << " cached, " << stream.evictedChunks() << " evicted, worst update "
+              << std::setprecision(3) << worstMs << " ms, " << late << " late, " << matching << "/" << windowChunks
+              << " rebuild identically, " << reached << "/" << windowChunks << " connected\n";
+    if (late != 0 || slots != windowChunks || matching != windowChunks || reached != windowChunks) failures++;
+    return failures == 0 ? 0 : 1;
 }
 
-bool findEmptySpot(const std::vector<std::vector<TileType>>& map, int& x, int& y) {
-    std::mt19937 rng(static_cast<unsigned>(std::time(nullptr)) + x + y);
-    for (int attempts = 0; attempts < 100; attempts++) {
-        x = std::uniform_int_distribution<int>(2, MAP_WIDTH - 3)(rng);
-        y = std::uniform_int_distribution<int>(2, MAP_HEIGHT - 3)(rng);
-        
-        if (map[y][x] == TileType::Empty) {
-            return true;
-        }
+// ===========================================
+// HEADLESS BENCHMARK
+// ===========================================
+
+// Peak resident set of the process so far, in KiB; 0 where the platform
+// does not report it
+std::size_t peakMemoryKiB() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
+
+// A straight 4-wide corridor the full width of the map, with the player
+// at the east end looking down it
+void carveBenchCorridor(TileMap& map, std::vector<Room>& rooms) {
+    const int top = map.height() / 2 - 2;
+    for (int y = top; y < top + 4; y++) {
+        for (int x = 1; x < map.width() - 1; x++) map.set(x, y, TileType::Empty);
     }
-    return false;
+    rooms.assign(1, Room{map.width() - 12, top, 10, 4});
 }
 
-// ===========================================
-// RAYCASTING RENDERER
-// ===========================================
+// The recorded patrol every scenario replays: walk, look around with the
+// mouse, strafe and fire in bursts. Tick n of a run is entry n % size().
+std::vector<PlayerInput> benchInputScript(bool straight) {
+    struct Segment { int ticks; PlayerInput input; };
+    PlayerInput walk, strafe, turn, turnBack, shoot;
+    walk.forward = true;
+    strafe.strafeLeft = true;
+    turn.forward = true;
+    turn.mouseDeltaX = 6.0f;
+    turnBack.turnRight = true;
+    shoot.fire = true;
+    shoot.forward = true;
+    
+    // The corridor has no room to turn, so its script only walks and fires
+    const std::vector<Segment> segments = straight
+        ? std::vector<Segment>{{240, walk}, {120, shoot}, {120, PlayerInput{}}}
+        : std::vector<Segment>{{180, walk}, {80, turn}, {60, strafe}, {120, shoot}, {90, turnBack},
+                               {120, walk}, {60, PlayerInput{}}};
+    std::vector<PlayerInput> script;
+    for (const Segment& segment : segments) script.insert(script.end(), segment.ticks, segment.input);
+    return script;
+}
 
-void renderRaycaster(sf::RenderWindow& window, 
-                     const Player& player,
-                     const std::vector<std::vector<TileType>>& map,
-                     const std::vector<Enemy>& enemies,
-                     const std::vector<Pickup>& pickups,
-                     const sf::Texture& wallTexture) {
-    
-    // Ceiling
-    sf::RectangleShape ceiling({static_cast<float>(SCREEN_WIDTH), 
-                                 static_cast<float>(SCREEN_HEIGHT / 2)});
-    ceiling.setPosition({0.f, 0.f});
-    ceiling.setFillColor(sf::Color(50, 50, 50));
-    window.draw(ceiling);
-    
-    // Floor
-    sf::RectangleShape floor({static_cast<float>(SCREEN_WIDTH), 
-                               static_cast<float>(SCREEN_HEIGHT / 2)});
-    floor.setPosition({0.f, static_cast<float>(SCREEN_HEIGHT / 2)});
-    floor.setFillColor(sf::Color(30, 30, 30));
-    window.draw(floor);
-    
-    std::vector<double> zBuffer(SCREEN_WIDTH, 1e30);
-    
-    // Raycast walls
-    for (int x = 0; x < static_cast<int>(SCREEN_WIDTH); x++) {
-        double cameraX = 2 * x / static_cast<double>(SCREEN_WIDTH) - 1;
-        double rayDirX = player.dirX + player.planeX * cameraX;
-        double rayDirY = player.dirY + player.planeY * cameraX;
-        
-        int mapX = static_cast<int>(player.posX);
-        int mapY = static_cast<int>(player.posY);
-        
-        double deltaDistX = (rayDirX == 0) ? 1e30 : std::abs(1 / rayDirX);
-        double deltaDistY = (rayDirY == 0) ? 1e30 : std::abs(1 / rayDirY);
-        
-        double sideDistX, sideDistY;
-        int stepX, stepY;
+struct BenchScenario {
+    const char* name;
+    int enemies;
+    int mapSize;
+    unsigned int width, height;
+    bool corridor;
+};
+
+// Plays each scenario for config.benchFrames frames of a fixed 60 Hz step
+// from a fixed seed, rendering the full play view into an offscreen
+// target, and reports wall-clock frame times. Everything but the timings
+// is the same on every run.
+int runBenchmarks(const EngineConfig& config) {
+    constexpr std::uint64_t BENCH_SEED = 1;
+    constexpr int BENCH_TICK_RATE = 60;
+    constexpr float BENCH_TIMESTEP = 1.0f / BENCH_TICK_RATE;
+    constexpr int WARMUP_FRAMES = 30;
+    const BenchScenario scenarios[] = {
+        {"corridor", 0, 512, SCREEN_WIDTH, SCREEN_HEIGHT, true},
+        {"default", 15, MAP_WIDTH, SCREEN_WIDTH, SCREEN_HEIGHT, false},
+        {"horde", 1000, 128, SCREEN_WIDTH, SCREEN_HEIGHT, false},
+        {"4k", 15, MAP_WIDTH, 3840, 2160, false},
+    };
+    
+    GameAssets assets;
+    if (!requestAssets(assets, config.atlasCache)) return 1;
+    assets.manager.waitAll();
+    checkAssets(assets);
+    
+    FrameProfiler& profiler = FrameProfiler::instance();
+    if (!config.profilePath.empty() && !profiler.startCapture(config.profilePath, config.profileFormat)) {
+        std::cerr << "Could not write profile to " << config.profilePath.string() << "\n";
+    }
+    std::cout << "Seed " << BENCH_SEED << ", " << config.benchFrames << " frames per scenario at "
+              << BENCH_TICK_RATE << " Hz, "
+              << renderModeName(config.renderMode) << ", "
+              << rayIsaName(config.rayIsa) << " DDA\n";
+    
+    for (const BenchScenario& scenario : scenarios) {
+        EngineConfig scenarioConfig = config;
+        scenarioConfig.seed = BENCH_SEED;
+        scenarioConfig.enemyCount = scenario.enemies;
+        scenarioConfig.mapWidth = scenario.mapSize;
+        scenarioConfig.mapHeight = scenario.corridor ? 32 : scenario.mapSize;
+        scenarioConfig.screenWidth = scenario.width;
+        scenarioConfig.screenHeight = scenario.height;
+        scenarioConfig.infinite = false;
         
-        if (rayDirX < 0) {
-            stepX = -1;
-            sideDistX = (player.posX - mapX) * deltaDistX;
-        } else {
-            stepX = 1;
-            sideDistX = (mapX + 1.0 - player.posX) * deltaDistX;
+        sf::RenderTexture target;
+        if (!target.resize({scenario.width, scenario.height})) {
+            std::cerr << scenario.name << ": could not create a " << scenario.width << "x"
+                      << scenario.height << " render target\n";
+            return 1;
         }
-        
-        if (rayDirY < 0) {
-            stepY = -1;
-            sideDistY = (player.posY - mapY) * deltaDistY;
+        RenderContext renderContext(scenarioConfig);
+        renderContext.setSurfaces(*assets.tileset);
+        std::unique_ptr<GameWorld> world;
+        if (scenario.corridor) {
+            auto map = std::make_unique<TileMap>(scenarioConfig.mapWidth, scenarioConfig.mapHeight,
+                                                 scenarioConfig.mapLayout);
+            std::vector<Room> rooms;
+            carveBenchCorridor(*map, rooms);
+            world = std::make_unique<GameWorld>(std::move(map), nullptr, rooms, assets, 0, PICKUP_COUNT,
+                                                BENCH_SEED, config.tickRate);
         } else {
-            stepY = 1;
-            sideDistY = (mapY + 1.0 - player.posY) * deltaDistY;
+            world = createWorld(scenarioConfig, assets, renderContext.workers);
         }
+        Hud hud(assets.font, assets.statusBar, {scenario.width, scenario.height});
+        const std::vector<PlayerInput> script = benchInputScript(scenario.corridor);
         
-        int side = 0;
-        bool hit = false;
-        while (!hit) {
-            if (sideDistX < sideDistY) {
-                sideDistX += deltaDistX;
-                mapX += stepX;
-                side = 0;
-            } else {
-                sideDistY += deltaDistY;
-                mapY += stepY;
-                side = 1;
+        std::vector<double> frameMs;
+        frameMs.reserve(config.benchFrames);
+        double totalSeconds = 0.0;
+        int fps = 0;
+        std::size_t tick = 0;
+        for (int frame = 0; frame < WARMUP_FRAMES + config.benchFrames; frame++) {
+            auto start = std::chrono::steady_clock::now();
+            profiler.beginFrame();
+            
+            for (int due = dueTicks(*world, BENCH_TIMESTEP); due > 0; due--) {
+                tickWorld(*world, &script[tick++ % script.size()]);
             }
+            world->cues.clear();
+            // The run measures frames, not survival
+            world->players[0].health = world->players[0].maxHealth;
             
-            if (mapX < 0 || mapX >= MAP_WIDTH || mapY < 0 || mapY >= MAP_HEIGHT) {
-                hit = true;
-            } else if (map[mapY][mapX] == TileType::Wall) {
-                hit = true;
+            target.clear();
+            drawPlayView(target, renderContext, *world, hud, fps, world->simAccumulator / world->timestep);
+            {
+                ProfileScope scope(ProfileStage::Display);
+                target.display();
             }
+            profiler.endFrame();
+            
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            fps = static_cast<int>(1.0 / std::max(seconds, 1e-6));
+            renderContext.adaptResolution(seconds * 1000.0);
+            if (frame < WARMUP_FRAMES) continue;
+            frameMs.push_back(seconds * 1000.0);
+            totalSeconds += seconds;
         }
         
-        double perpWallDist;
-        if (side == 0) {
-            perpWallDist = (mapX - player.posX + (1 - stepX) / 2) / rayDirX;
-        } else {
-            perpWallDist = (mapY - player.posY + (1 - stepY) / 2) / rayDirY;
-        }
-        
-        if (perpWallDist < 0.1) perpWallDist = 0.1;
-        zBuffer[x] = perpWallDist;
-        
-        int lineHeight = static_cast<int>(SCREEN_HEIGHT / perpWallDist);
-        int drawStart = -lineHeight / 2 + SCREEN_HEIGHT / 2;
-        int drawEnd = lineHeight / 2 + SCREEN_HEIGHT / 2;
-        
-        if (drawStart < 0) drawStart = 0;
-        if (drawEnd >= static_cast<int>(SCREEN_HEIGHT)) drawEnd = SCREEN_HEIGHT - 1;
-        
-        sf::RectangleShape wallSlice({1, static_cast<float>(drawEnd - drawStart)});
-        wallSlice.setPosition({static_cast<float>(x), static_cast<float>(drawStart)});
-        
-        // Textured walls with variation
-        int texX = static_cast<int>((side == 0 ? player.posY : player.posX) * 64) % 64;
-        sf::Color wallColor;
-        if (texX < 16) {
-            wallColor = sf::Color(120, 80, 60);
-        } else if (texX < 32) {
-            wallColor = sf::Color(100, 70, 50);
-        } else if (texX < 48) {
-            wallColor = sf::Color(110, 75, 55);
-        } else {
-            wallColor = sf::Color(90, 65, 45);
+        std::vector<double> sorted = frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&](double fraction) {
+            return sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))];
+        };
+        std::cout << std::left << std::setw(9) << scenario.name << std::right
+                  << std::setw(5) << scenario.width << "x" << std::left << std::setw(5) << scenario.height
+                  << std::right << std::setw(5) << world->enemies.size() << " enemies  "
+                  << std::fixed << std::setprecision(1) << std::setw(7) << frameMs.size() / totalSeconds
+                  << " fps  p50 " << std::setprecision(2) << percentile(0.50) << " ms  p95 " << percentile(0.95)
+                  << " ms  p99 " << percentile(0.99) << " ms  max " << sorted.back() << " ms  peak "
+                  << peakMemoryKiB() / 1024 << " MiB  end (" << world->players[0].posX << ", "
+                  << world->players[0].posY << ")";
+        if (renderContext.scene) {
+            std::cout << "  view " << renderContext.viewWidth() << "x" << renderContext.viewHeight();
         }
-        
-        if (side == 1) {
-            wallColor.r /= 1.5;
-            wallColor.g /= 1.5;
-            wallColor.b /= 1.5;
+        if (renderContext.interlace) {
+            const InterlacedCaster& interlace = *renderContext.interlace;
+            const std::size_t missing = interlace.rebuiltColumns() + interlace.recastColumns();
+            std::cout << "  rebuilt " << std::setprecision(1)
+                      << (missing ? 100.0 * interlace.rebuiltColumns() / missing : 0.0) << "%";
         }
-        
-        double fogFactor = std::min(1.0, perpWallDist / 20.0);
-        wallColor.r = static_cast<std::uint8_t>(wallColor.r * (1.0 - fogFactor * 0.7));
-        wallColor.g = static_cast<std::uint8_t>(wallColor.g * (1.0 - fogFactor * 0.7));
-        wallColor.b = static_cast<std::uint8_t>(wallColor.b * (1.0 - fogFactor * 0.7));
-        
-        wallSlice.setFillColor(wallColor);
-        window.draw(wallSlice);
+        std::cout << "\n";
     }
-    
-    // Draw pickups
-    for (const auto& pickup : pickups) {
-        if (!pickup.active) continue;
-        
-        double spriteX = pickup.x - player.posX;
-        double spriteY = pickup.y - player.posY;
-        
-        double invDet = 1.0 / (player.planeX * player.dirY - player.dirX * player.planeY);
-        double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
-        double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
-        
-        if (transformY <= 0.1) continue;
-        
-        int spriteScreenX = static_cast<int>((SCREEN_WIDTH / 2) * (1 + transformX / transformY));
-        float bob = std::sin(pickup.bobClock.getElapsedTime().asSeconds() * 3) * 10;
-        int spriteHeight = static_cast<int>(std::abs(SCREEN_HEIGHT / transformY) * 0.5);
-        int spriteWidth = spriteHeight;
-        
-        int drawStartY = -spriteHeight / 2 + SCREEN_HEIGHT / 2 + static_cast<int>(bob);
-        int drawEndY = spriteHeight / 2 + SCREEN_HEIGHT / 2 + static_cast<int>(bob);
-        int drawStartX = -spriteWidth / 2 + spriteScreenX;
-        int drawEndX = spriteWidth / 2 + spriteScreenX;
-        
-        if (drawStartY < 0) drawStartY = 0;
-        if (drawEndY >= static_cast<int>(SCREEN_HEIGHT)) drawEndY = SCREEN_HEIGHT - 1;
-        
-        for (int stripe = drawStartX; stripe < drawEndX; stripe++) {
-            if (stripe < 0 || stripe >= static_cast<int>(SCREEN_WIDTH)) continue;
-            if (transformY >= zBuffer[stripe]) continue;
-            
-            sf::RectangleShape sprite({1, static_cast<float>(drawEndY - drawStartY)});
-            sprite.setPosition({static_cast<float>(stripe), static_cast<float>(drawStartY)});
-            
-            sf::Color pickupColor;
-            switch (pickup.type) {
-                case Pickup::HealthPack: pickupColor = sf::Color::Green; break;
-                case Pickup::Ammo: pickupColor = sf::Color::Yellow; break;
-                case Pickup::Armor: pickupColor = sf::Color::Blue; break;
-            }
-            sprite.setFillColor(pickupColor);
-            window.draw(sprite);
-        }
+    profiler.stopCapture();
+    return 0;
+}
+
+// ===========================================
+// NET PLAY
+// ===========================================
+
+// The local player's camera with the inputs still in flight already
+// played on it, alpha of a tick past the last of them. Only movement is
+// predicted, by the same updatePlayerMovement the tick runs; players never
+// block one another, so it only misses a respawn, which the tick that
+// makes it puts right.
+Player predictedView(const GameWorld& world, const LockstepSession& session, float alpha) {
+    const int slot = session.slot();
+    Player previous = world.previousPlayers[slot];
+    Player current = world.players[slot];
+    for (std::uint32_t tick = session.simulated(); tick < session.localTick(); tick++) {
+        previous = current;
+        updatePlayerMovement(current, world.map, world.timestep, playerInput(session.tic(tick, slot)));
     }
-    
-    // Draw enemies
-    for (const auto& enemy : enemies) {
-        if (!enemy.active) continue;
-        
-        double spriteX = enemy.x - player.posX;
-        double spriteY = enemy.y - player.posY;
-        
-        double invDet = 1.0 / (player.planeX * player.dirY - player.dirX * player.planeY);
-        double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
-        double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
-        
-        if (transformY <= 0.1) continue;
-        
-        int spriteScreenX = static_cast<int>((SCREEN_WIDTH / 2) * (1 + transformX / transformY));
-        int spriteHeight = static_cast<int>(std::abs(SCREEN_HEIGHT / transformY));
-        int spriteWidth = spriteHeight;
-        
-        int drawStartY = -spriteHeight / 2 + SCREEN_HEIGHT / 2;
-        int drawEndY = spriteHeight / 2 + SCREEN_HEIGHT / 2;
-        int drawStartX = -spriteWidth / 2 + spriteScreenX;
-        int drawEndX = spriteWidth / 2 + spriteScreenX;
-        
-        if (drawStartY < 0) drawStartY = 0;
-        if (drawEndY >= static_cast<int>(SCREEN_HEIGHT)) drawEndY = SCREEN_HEIGHT - 1;
-        
-        for (int stripe = drawStartX; stripe < drawEndX; stripe++) {
-            if (stripe < 0 || stripe >= static_cast<int>(SCREEN_WIDTH)) continue;
-            if (transformY >= zBuffer[stripe]) continue;
-            
-            sf::RectangleShape sprite({1, static_cast<float>(drawEndY - drawStartY)});
-            sprite.setPosition({static_cast<float>(stripe), static_cast<float>(drawStartY)});
-            
-            sf::Color enemyColor;
-            switch (enemy.type) {
-                case EnemyType::Wolf: enemyColor = sf::Color(200, 50, 50); break;
-                case EnemyType::SmokeDemon: enemyColor = sf::Color(150, 0, 150); break;
-                case EnemyType::TophatOgre: enemyColor = sf::Color(50, 150, 50); break;
-                case EnemyType::RedDemon: enemyColor = sf::Color(220, 0, 0); break;
-            }
-            
-            // Health indicator
-            float healthPercent = static_cast<float>(enemy.health) / enemy.maxHealth;
-            enemyColor.r = static_cast<std::uint8_t>(enemyColor.r * healthPercent);
-            enemyColor.g = static_cast<std::uint8_t>(enemyColor.g * healthPercent);
-            enemyColor.b = static_cast<std::uint8_t>(enemyColor.b * healthPercent);
-            
-            sprite.setFillColor(enemyColor);
-            window.draw(sprite);
-        }
+    return interpolatedView(previous, current, alpha);
+}
+
+void printNetStats(const LockstepSession& session) {
+    std::cout << "Net: slot " << session.slot() << " of " << session.players() << ", " << session.simulated()
+              << " ticks, " << session.inputDelay() << " tick input delay, " << session.stalls()
+              << " tick(s) stalled, ";
+    if (session.desyncs()) {
+        std::cout << session.desyncs() << " checksum mismatch(es) from tick " << session.firstDesyncTick() << "\n";
+    } else {
+        std::cout << "checksums agree\n";
+    }
+    for (std::size_t i = 0; i < session.peers(); i++) {
+        const LockstepSession::PeerStats stats = session.peerStats(i);
+        std::cout << "  player " << stats.slot << ": rtt " << std::fixed << std::setprecision(1) << stats.rttMs
+                  << " ms (max " << stats.maxRttMs << "), up " << stats.upKbps << " kbps, down "
+                  << stats.downKbps << " kbps, " << stats.packetsSent << " packets sent, "
+                  << stats.packetsReceived << " received" << (stats.dropped ? ", dropped" : "") << "\n";
+        std::cout.unsetf(std::ios::fixed);
     }
 }
 
@@ -544,122 +533,173 @@ void renderRaycaster(sf::RenderWindow& window,
 // MAIN GAME
 // ===========================================
 
-int main() {
-    sf::RenderWindow window(sf::VideoMode({SCREEN_WIDTH, SCREEN_HEIGHT}), 
-                            "DOOM - Complete Edition");
-    window.setFramerateLimit(60);
+int main(int argc, char* argv[]) {
+    EngineConfig config = parseConfig(argc, argv);
+    if (ENGINE_BENCH) config.bench = true;
+    if (config.ddaBench) return runDdaBench(config);
+    if (config.flowBench) return runFlowBench(config);
+    if (config.genBench) return runGenBench(config);
+    if (config.bench) return runBenchmarks(config);
     
-    // Load font
-    sf::Font font;
-    if (!font.openFromFile("res/arial.ttf")) { 
-        std::cerr << "Could not load font\n"; 
-        return -1; 
+    // A demo brings the settings it was recorded under
+    Demo demo;
+    const bool playingDemo = !config.demoPath.empty();
+    const bool recording = !config.recordPath.empty();
+    if (playingDemo) {
+        if (!demo.load(config.demoPath)) {
+            std::cerr << "Could not read demo " << config.demoPath.string() << "\n";
+            return -1;
+        }
+        if (!applyDemoHeader(config, demo.header)) {
+            std::cerr << "Demo was recorded under settings this build does not support\n";
+            return -1;
+        }
     }
+    if (recording) demo.header = demoHeader(config);
     
-    // Load DOOM assets
-    sf::Texture titleTexture, statusBarTexture, victoryTexture;
-    if (!titleTexture.loadFromFile("res/doom/TITLEPIC.png")) {
-        std::cerr << "Could not load title screen\n";
-    }
-    if (!statusBarTexture.loadFromFile("res/doom/STBAR.png")) {
-        std::cerr << "Could not load status bar\n";
+    // A net game gathers its players before anything loads, and a client
+    // plays under the host's settings
+    std::unique_ptr<LockstepSession> session;
+    if (config.hostPort != 0 || !config.joinAddress.empty()) {
+        session = std::make_unique<LockstepSession>();
+        if (config.hostPort != 0) {
+            std::cout << "Hosting on port " << config.hostPort << ", waiting " << HOST_TIMEOUT.count() << " s for "
+                      << config.players - 1 << " more player(s)\n";
+            if (!session->host(config.hostPort, config.players, demoHeader(config), config.inputDelay,
+                               HOST_TIMEOUT)) {
+                std::cerr << "Could not host: " << session->endReason() << "\n";
+                return -1;
+            }
+        } else {
+            std::cout << "Joining " << config.joinAddress << "\n";
+            if (!session->join(config.joinAddress, JOIN_TIMEOUT)) {
+                std::cerr << "Could not join: " << session->endReason() << "\n";
+                return -1;
+            }
+            const DemoHeader& settings = session->settings();
+            if (settings.infinite || !applyDemoHeader(config, settings)) {
+                std::cerr << "The host plays under settings this build does not support\n";
+                session->leave();
+                return -1;
+            }
+            config.players = session->players();
+        }
+        std::cout << "Net game of " << session->players() << " players, playing slot " << session->slot() << "\n";
     }
-    if (!victoryTexture.loadFromFile("res/doom/VICTORY2.png")) {
-        std::cerr << "Could not load victory screen\n";
+    const int localSlot = session ? session->slot() : 0;
+    
+    // So does a save, which replaces generation
+    SaveFile startSave;
+    if (!config.loadPath.empty() &&
+        (!startSave.open(config.loadPath) || !applySaveHeader(config, startSave.header()))) {
+        std::cerr << "Could not read save " << config.loadPath.string() << "\n";
+        return -1;
     }
     
-    // Load enemy textures
-    sf::Texture wolfTexture, smokeDemonTexture, tophatOgreTexture, redDemonTexture, wallTexture;
-    wolfTexture.loadFromFile("res/textures/wolf.png");
-    smokeDemonTexture.loadFromFile("res/textures/smoke-demon.png");
-    tophatOgreTexture.loadFromFile("res/textures/tophat-ogre.png");
-    redDemonTexture.loadFromFile("res/textures/Demon/Red/ALBUM008_72.png");
-    wallTexture.loadFromFile("res/textures/world.png");
+    const unsigned int screenWidth = config.screenWidth;
+    const unsigned int screenHeight = config.screenHeight;
+    sf::RenderWindow window(sf::VideoMode({screenWidth, screenHeight}), 
+                            "DOOM - Complete Edition");
+    // Timedemos run one tick per frame, as fast as frames can be drawn
+    const FramePacing pacing = config.timedemo ? FramePacing::Uncapped : config.pacing;
+    window.setVerticalSyncEnabled(pacing == FramePacing::VSync);
+    window.setFramerateLimit(pacing == FramePacing::Capped ? config.frameCap : 0);
     
-    // Game state
-    GameState gameState = GameState::Title;
+    // Decoding runs in the background while the world generates; the
+    // loading screen uploads what has finished between frames
+    GameAssets assets;
+    if (!requestAssets(assets, config.atlasCache)) return -1;
+    sf::Clock loadingClock;
+    GameState gameState = GameState::Loading;
     
-    // Generate map
-    std::vector<std::vector<TileType>> worldMap(MAP_HEIGHT, std::vector<TileType>(MAP_WIDTH));
-    std::vector<Room> rooms;
-    generateDungeon(worldMap, rooms);
-    
-    // Initialize player
-    int startX = 5, startY = 5;
-    if (!rooms.empty()) {
-        startX = rooms[0].centerX();
-        startY = rooms[0].centerY();
-    }
-    Player player(startX + 0.5, startY + 0.5);
-    
-    // Spawn enemies
-    std::vector<Enemy> enemies;
-    for (int i = 0; i < 15; i++) {
-        int ex, ey;
-        if (findEmptySpot(worldMap, ex, ey)) {
-            EnemyType type = static_cast<EnemyType>(i % 4);
-            const sf::Texture* tex = &wolfTexture;
-            sf::IntRect rect({0, 0}, {128, 128});
-            int hp = 50;
-            float spd = 1.5f;
-            
-            switch (type) {
-                case EnemyType::Wolf:
-                    tex = &wolfTexture;
-                    rect = sf::IntRect({0, 0}, {128, 128});
-                    hp = 50;
-                    spd = 2.0f;
-                    break;
-                case EnemyType::SmokeDemon:
-                    tex = &smokeDemonTexture;
-                    rect = sf::IntRect({0, 0}, {160, 128});
-                    hp = 75;
-                    spd = 1.5f;
-                    break;
-                case EnemyType::TophatOgre:
-                    tex = &tophatOgreTexture;
-                    rect = sf::IntRect({0, 0}, {160, 128});
-                    hp = 100;
-                    spd = 1.2f;
-                    break;
-                case EnemyType::RedDemon:
-                    tex = &redDemonTexture;
-                    rect = sf::IntRect({0, 0}, {72, 72});
-                    hp = 150;
-                    spd = 1.0f;
-                    break;
-            }
-            
-            enemies.emplace_back(ex + 0.5, ey + 0.5, type, hp, spd, tex, rect);
-        }
+    // Voices are built now and given their effects once loading is done;
+    // declared after assets, whose buffers they play
+    std::unique_ptr<AudioEngine> audio;
+    if (config.audio) audio = std::make_unique<AudioEngine>(SFX_COUNT);
+    
+    RenderContext renderContext(config);
+    sf::Clock worldClock;
+    std::unique_ptr<GameWorld> world = createWorld(config, assets, renderContext.workers,
+                                                   startSave.isOpen() ? &startSave : nullptr);
+    if (!world) {
+        std::cerr << "Save " << config.loadPath.string() << " does not match its own level\n";
+        return -1;
     }
+    if (startSave.isOpen()) {
+        std::cout << "Loaded " << world->map.width() << "x" << world->map.height() << " level from "
+                  << config.loadPath.string() << " (seed " << world->seed << ") in "
+                  << worldClock.getElapsedTime().asMilliseconds() << " ms\n";
+        startSave.close();
+    }
+    if (!config.saveLevelPath.empty() && !saveWorld(*world, config.saveLevelPath)) {
+        std::cerr << "Could not save the level to " << config.saveLevelPath.string() << "\n";
+    }
+    const TileMap& worldMap = world->map;
+    Player& player = world->players[localSlot];
     
-    // Spawn pickups
-    std::vector<Pickup> pickups;
-    for (int i = 0; i < 10; i++) {
-        int px, py;
-        if (findEmptySpot(worldMap, px, py)) {
-            Pickup::Type type = static_cast<Pickup::Type>(i % 3);
-            int value = 0;
-            switch (type) {
-                case Pickup::HealthPack: value = 25; break;
-                case Pickup::Ammo: value = 20; break;
-                case Pickup::Armor: value = 50; break;
-            }
-            pickups.emplace_back(px + 0.5, py + 0.5, type, value);
+    // Screens and HUD are built once; text only re-lays out when it changes.
+    // The status bar and screen images are set when loading finishes.
+    Hud hud(assets.font, nullptr, {screenWidth, screenHeight});
+    auto fullScreen = [&](sf::Sprite& sprite, const sf::Texture& texture) {
+        sprite.setTexture(texture, true);
+        const sf::Vector2u size = texture.getSize();
+        if (size.x > 0 && size.y > 0) {
+            sprite.setScale({static_cast<float>(screenWidth) / size.x,
+                             static_cast<float>(screenHeight) / size.y});
         }
-    }
+    };
+    sf::Sprite titleSprite(*assets.title);
+    sf::Sprite victorySprite(*assets.victory);
+    
+    const sf::Vector2f loadingBarSize(screenWidth * 0.5f, 24.f);
+    const sf::Vector2f loadingBarPos((screenWidth - loadingBarSize.x) / 2.f, screenHeight * 0.6f);
+    sf::RectangleShape loadingFrame(loadingBarSize);
+    loadingFrame.setPosition(loadingBarPos);
+    loadingFrame.setFillColor(sf::Color::Transparent);
+    loadingFrame.setOutlineColor(sf::Color(200, 0, 0));
+    loadingFrame.setOutlineThickness(2.f);
+    sf::RectangleShape loadingFill({0.f, loadingBarSize.y});
+    loadingFill.setPosition(loadingBarPos);
+    loadingFill.setFillColor(sf::Color(200, 0, 0));
+    CachedText loadingText(assets.font, 24, sf::Color::White, {loadingBarPos.x, loadingBarPos.y - 40.f});
+    
+    sf::Text startText(assets.font, "Click or Press ENTER to Start\nESC to Quit", 32);
+    startText.setFillColor(sf::Color::Red);
+    startText.setPosition({screenWidth / 2.f - 200, screenHeight - 100.f});
+    
+    CachedText victoryText(assets.font, 48, sf::Color::Yellow, {screenWidth / 2.f - 200, screenHeight / 2.f - 100});
+    victoryText.text().setOutlineColor(sf::Color::Black);
+    victoryText.text().setOutlineThickness(3);
     
-    std::vector<Projectile> projectiles;
-    std::vector<BloodParticle> bloodParticles;
+    sf::Text gameOverText(assets.font, "GAME OVER\n\nPress ESC to exit", 64);
+    gameOverText.setFillColor(sf::Color::Black);
+    gameOverText.setPosition({screenWidth / 2.f - 250, screenHeight / 2.f - 100});
+    
+    FrameProfiler& profiler = FrameProfiler::instance();
+    ProfilerOverlay profilerOverlay(assets.font, {10.f, 10.f});
+    profilerOverlay.visible = config.profileOverlay;
+    if (!config.profilePath.empty()) {
+        if (profiler.startCapture(config.profilePath, config.profileFormat)) {
+            std::cout << "Profiling frames to " << config.profilePath.string() << "\n";
+        } else {
+            std::cerr << "Could not write profile to " << config.profilePath.string() << "\n";
+        }
+    }
     
     sf::Clock clock;
     sf::Clock fpsClock;
-    sf::Clock shootClock;
     int frameCount = 0;
+    std::size_t totalFrames = 0;
     float fps = 0;
     float mouseDeltaX = 0;
+    bool fire = false;
+    std::vector<PlayerInput> inputs(world->players.size()); // by slot, for the next tick
+    bool desyncReported = false;
+    std::size_t demoTics = 0;         // played or recorded
+    std::size_t timedemoFrames = 0;
+    sf::Clock timedemoClock;
     sf::Vector2i lastMousePos = sf::Mouse::getPosition(window);
+    const sf::Vector2i screenCentre(screenWidth / 2, screenHeight / 2);
     
     std::cout << "===========================================\n";
     std::cout << "DOOM - COMPLETE EDITION\n";
@@ -670,12 +710,28 @@ int main() {
     std::cout << "  Left Click - Shoot\n";
     std::cout << "  Arrow Keys - Rotate\n";
     std::cout << "  ESC - Quit/Menu\n";
+    std::cout << "Renderer: " << renderModeName(renderContext.mode)
+              << ", " << renderContext.workers.size() << " raycast thread(s)"
+              << ", " << rayIsaName(renderContext.rayIsa) << " DDA"
+              << (renderContext.interlace ? ", interlaced" : "") << "\n";
+    if (renderContext.scene) {
+        std::cout << "View: " << renderContext.viewWidth() << "x" << renderContext.viewHeight() << ", "
+                  << (config.upscale == UpscaleFilter::Bilinear ? "bilinear" : "nearest") << " upscale";
+        if (renderContext.resolution) std::cout << ", dynamic for " << config.targetFps << " fps";
+        std::cout << "\n";
+    }
+    std::cout << "Map: " << worldMap.width() << "x" << worldMap.height()
+              << (worldMap.layout() == TileLayout::Morton ? " morton" : " row-major")
+              << (world->stream ? " window over streamed chunks" : "") << "\n";
     std::cout << "===========================================\n";
     
     // Game loop
     while (window.isOpen()) {
+        profiler.beginFrame();
         float deltaTime = clock.restart().asSeconds();
+        sf::Clock workClock;
         frameCount++;
+        totalFrames++;
         
         if (fpsClock.getElapsedTime().asSeconds() >= 1.0f) {
             fps = frameCount / fpsClock.getElapsedTime().asSeconds();
@@ -684,14 +740,15 @@ int main() {
         }
         
         // Mouse movement
+        ProfileScope inputScope(ProfileStage::Input);
         sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-        mouseDeltaX = static_cast<float>(mousePos.x - lastMousePos.x);
+        mouseDeltaX += static_cast<float>(mousePos.x - lastMousePos.x);
         lastMousePos = mousePos;
         
         // Center mouse if in playing state
         if (gameState == GameState::Playing && window.hasFocus()) {
-            sf::Mouse::setPosition(sf::Vector2i(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2), window);
-            lastMousePos = sf::Vector2i(SCREEN_WIDTH / 2, SCREEN_HEIGHT / 2);
+            sf::Mouse::setPosition(screenCentre, window);
+            lastMousePos = screenCentre;
         }
         
         // Event handling
@@ -702,7 +759,8 @@ int main() {
             
             if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
                 if (keyPressed->code == sf::Keyboard::Key::Escape) {
-                    if (gameState == GameState::Playing) {
+                    // A net game cannot pause for one player
+                    if (gameState == GameState::Playing && !session) {
                         gameState = GameState::Title;
                         window.setMouseCursorVisible(true);
                     } else {
@@ -714,6 +772,34 @@ int main() {
                     gameState = GameState::Playing;
                     window.setMouseCursorVisible(false);
                 }
+                
+                if (keyPressed->code == sf::Keyboard::Key::F3) {
+                    profilerOverlay.visible = !profilerOverlay.visible;
+                }
+                
+                // Quick-save and quick-load; a demo or net game can be saved
+                // from, but loading would leave the tics or the peers behind
+                if (keyPressed->code == sf::Keyboard::Key::F5 && gameState == GameState::Playing) {
+                    sf::Clock saveClock;
+                    if (saveWorld(*world, config.quickSavePath)) {
+                        std::cout << "Saved to " << config.quickSavePath.string() << " in "
+                                  << saveClock.getElapsedTime().asMicroseconds() << " us\n";
+                    } else {
+                        std::cerr << "Could not save to " << config.quickSavePath.string() << "\n";
+                    }
+                }
+                if (keyPressed->code == sf::Keyboard::Key::F9 && gameState == GameState::Playing &&
+                    !playingDemo && !recording && !session) {
+                    sf::Clock loadClock;
+                    SaveFile save;
+                    if (save.open(config.quickSavePath) && restoreWorld(*world, save, &renderContext.workers)) {
+                        if (renderContext.interlace) renderContext.interlace->reset();
+                        std::cout << "Loaded " << config.quickSavePath.string() << " in "
+                                  << loadClock.getElapsedTime().asMicroseconds() << " us\n";
+                    } else {
+                        std::cerr << "Could not load " << config.quickSavePath.string() << "\n";
+                    }
+                }
             }
             
             if (const auto* mousePressed = event->getIf<sf::Event::MouseButtonPressed>()) {
@@ -721,241 +807,227 @@ int main() {
                     if (gameState == GameState::Title) {
                         gameState = GameState::Playing;
                         window.setMouseCursorVisible(false);
-                    } else if (gameState == GameState::Playing && 
-                              player.ammo > 0 && 
-                              shootClock.getElapsedTime().asSeconds() > 0.3f) {
-                        projectiles.emplace_back(player.posX, player.posY, 
-                                                player.dirX, player.dirY, true);
-                        player.ammo--;
-                        shootClock.restart();
+                    } else if (gameState == GameState::Playing) {
+                        fire = true;
                     }
                 }
             }
         }
         
-        // Update game state
-        if (gameState == GameState::Playing) {
-            // Update player
-            updatePlayerMovement(player, worldMap, deltaTime, mouseDeltaX);
-            mouseDeltaX = 0;
-            
-            // Check victory condition
-            bool allEnemiesDead = true;
-            for (const auto& enemy : enemies) {
-                if (enemy.active) {
-                    allEnemiesDead = false;
-                    break;
-                }
+        inputScope.stop();
+        
+        // Peers are answered whatever is on screen, so none waits on this
+        // one's loading screen
+        if (session) {
+            session->poll();
+            if (session->desyncs() > 0 && !desyncReported) {
+                std::cerr << "Desync: the peers' worlds differ after tick " << session->firstDesyncTick() << "\n";
+                desyncReported = true;
             }
-            if (allEnemiesDead && enemies.size() > 0) {
-                gameState = GameState::Victory;
-                window.setMouseCursorVisible(true);
+            if (session->ended() && window.isOpen()) {
+                std::cerr << "Net game over: " << session->endReason() << "\n";
+                window.close();
             }
-            
-            // Update enemies - simple AI
-            for (auto& enemy : enemies) {
-                if (!enemy.active) continue;
-                
-                double dx = player.posX - enemy.x;
-                double dy = player.posY - enemy.y;
-                double dist = std::sqrt(dx * dx + dy * dy);
-                
-                if (dist > 0.1 && dist < 15.0) {
-                    enemy.dirX = dx / dist;
-                    enemy.dirY = dy / dist;
-                    
-                    double newX = enemy.x + enemy.dirX * enemy.speed * deltaTime;
-                    double newY = enemy.y + enemy.dirY * enemy.speed * deltaTime;
-                    
-                    if (!checkCollision(worldMap, newX, newY, 0.2)) {
-                        enemy.x = newX;
-                        enemy.y = newY;
-                    }
-                    
-                    // Attack player if close
-                    if (dist < 1.5 && enemy.attackClock.getElapsedTime().asSeconds() > 1.5f) {
-                        player.health -= 10;
-                        enemy.attackClock.restart();
-                        
-                        if (player.health <= 0) {
-                            gameState = GameState::GameOver;
-                            window.setMouseCursorVisible(true);
-                        }
-                    }
+        }
+        
+        // Upload what has decoded, a few milliseconds a frame; demos skip
+        // the title once everything is in
+        if (gameState == GameState::Loading && assets.manager.pump(ASSET_UPLOAD_BUDGET)) {
+            checkAssets(assets);
+            hud.setStatusBar(assets.statusBar);
+            renderContext.setSurfaces(*assets.tileset);
+            if (!hud.hasStatusBar()) {
+                std::cerr << "Could not load status bar\n";
+            }
+            fullScreen(titleSprite, *assets.title);
+            fullScreen(victorySprite, *assets.victory);
+            std::cout << "Loaded " << assets.manager.requested() << " files in "
+                      << loadingClock.getElapsedTime().asMilliseconds() << " ms on "
+                      << assets.manager.threads() << " decode thread(s), "
+                      << assets.manager.duplicates() << " repeat request(s)\n";
+            if (audio) {
+                for (int i = 0; i < SFX_COUNT; i++) {
+                    audio->define(i, {assets.sfx[i], SFX_FILES[i].priority, SFX_FILES[i].volume});
+                }
+                if (config.music && !audio->playMusic(MUSIC_FILE, MUSIC_VOLUME)) {
+                    std::cerr << "Could not open " << MUSIC_FILE.string() << "\n";
                 }
             }
-            
-            // Update projectiles
-            for (auto it = projectiles.begin(); it != projectiles.end();) {
-                it->x += it->dirX * it->speed * deltaTime;
-                it->y += it->dirY * it->speed * deltaTime;
-                
-                int mapX = static_cast<int>(it->x);
-                int mapY = static_cast<int>(it->y);
-                
-                bool hitWall = (mapX < 0 || mapX >= MAP_WIDTH || mapY < 0 || mapY >= MAP_HEIGHT ||
-                               worldMap[mapY][mapX] == TileType::Wall);
-                
-                bool hitEnemy = false;
-                if (it->fromPlayer) {
-                    for (auto& enemy : enemies) {
-                        if (!enemy.active) continue;
-                        double dx = it->x - enemy.x;
-                        double dy = it->y - enemy.y;
-                        if (std::sqrt(dx * dx + dy * dy) < 0.5) {
-                            enemy.health -= it->damage;
-                            hitEnemy = true;
-                            
-                            // Spawn blood
-                            for (int i = 0; i < 5; i++) {
-                                double angle = (i / 5.0) * 2 * 3.14159;
-                                bloodParticles.emplace_back(enemy.x, enemy.y,
-                                    std::cos(angle) * 2, std::sin(angle) * 2);
-                            }
-                            
-                            if (enemy.health <= 0) {
-                                enemy.active = false;
-                                player.score += 100;
-                                player.kills++;
-                            }
-                            break;
-                        }
+            gameState = playingDemo || session ? GameState::Playing : GameState::Title;
+            timedemoClock.restart();
+        }
+        
+        // Update game state. Keys count as held for every tick of the frame;
+        // mouse motion and clicks go to the next tick, and carry over
+        // frames that run none. A net game samples input for a tick to
+        // come, then plays the next tick every player's input is in for; a
+        // due tick still waiting on a peer is dropped, slowing the game to
+        // the pace of the slowest.
+        if (gameState == GameState::Playing) {
+            const PlayerInput held = sampleKeyboard(0.0f, false);
+            int ticks = config.timedemo ? 1 : dueTicks(*world, deltaTime);
+            for (; ticks > 0 && gameState == GameState::Playing; ticks--) {
+                if (session) {
+                    if (session->wantsInput()) {
+                        PlayerInput local = held;
+                        local.mouseDeltaX = mouseDeltaX;
+                        local.fire = fire;
+                        mouseDeltaX = 0;
+                        fire = false;
+                        session->submit(demoTic(local));
                     }
-                }
-                
-                if (hitWall || hitEnemy || it->lifeClock.getElapsedTime().asSeconds() > 2.0f) {
-                    it = projectiles.erase(it);
+                    const DemoTic* frame = session->frame();
+                    if (!frame) break;
+                    for (std::size_t slot = 0; slot < inputs.size(); slot++) inputs[slot] = playerInput(frame[slot]);
+                } else if (playingDemo) {
+                    if (demoTics == demo.tics.size()) break;
+                    inputs[0] = playerInput(demo.tics[demoTics++]);
                 } else {
-                    ++it;
+                    PlayerInput& input = inputs[0];
+                    input = held;
+                    input.mouseDeltaX = mouseDeltaX;
+                    input.fire = fire;
+                    mouseDeltaX = 0;
+                    fire = false;
+                    if (recording) {
+                        // Play exactly what the file will hold
+                        demo.tics.push_back(demoTic(input));
+                        input = playerInput(demo.tics.back());
+                        demoTics++;
+                    }
                 }
-            }
-            
-            // Update blood particles
-            for (auto it = bloodParticles.begin(); it != bloodParticles.end();) {
-                it->velZ -= 9.8 * deltaTime;
-                it->x += it->velX * deltaTime;
-                it->y += it->velY * deltaTime;
-                it->z += it->velZ * deltaTime;
-                
-                if (it->z < 0) it->z = 0;
+                tickWorld(*world, inputs.data());
+                if (session && session->advance()) session->check(worldChecksum(*world));
                 
-                if (it->lifeClock.getElapsedTime().asSeconds() > it->lifetime) {
-                    it = bloodParticles.erase(it);
-                } else {
-                    ++it;
+                // A streamed world despawns the enemies it leaves behind, so
+                // it has no victory
+                if (!world->stream && world->allEnemiesDead() && world->enemies.size() > 0) {
+                    gameState = GameState::Victory;
+                    window.setMouseCursorVisible(true);
+                } else if (player.health <= 0) {
+                    gameState = GameState::GameOver;
+                    window.setMouseCursorVisible(true);
                 }
             }
+            if (playingDemo) mouseDeltaX = 0;
+            timedemoFrames++;
             
-            // Check pickups
-            for (auto& pickup : pickups) {
-                if (!pickup.active) continue;
-                
-                double dx = player.posX - pickup.x;
-                double dy = player.posY - pickup.y;
-                if (std::sqrt(dx * dx + dy * dy) < 0.8) {
-                    pickup.active = false;
-                    
-                    switch (pickup.type) {
-                        case Pickup::HealthPack:
-                            player.health = std::min(player.maxHealth, player.health + pickup.value);
-                            break;
-                        case Pickup::Ammo:
-                            player.ammo += pickup.value;
-                            break;
-                        case Pickup::Armor:
-                            // Could add armor system
-                            player.health = std::min(player.maxHealth, player.health + pickup.value / 2);
-                            break;
-                    }
-                }
+            // Everything the ticks cued, heard from where the player now is
+            if (audio) audio->play(world->cues, {player.posX, player.posY, player.dirX, player.dirY}, worldMap);
+        } else {
+            mouseDeltaX = 0;
+            fire = false;
+        }
+        world->cues.clear();
+        
+        // A demo ends with its tics, or with its session on a death, a
+        // victory or Esc
+        if (playingDemo && window.isOpen() && gameState != GameState::Loading &&
+            (demoTics == demo.tics.size() || gameState != GameState::Playing)) {
+            if (config.timedemo) {
+                double seconds = timedemoClock.getElapsedTime().asSeconds();
+                std::cout << "Timedemo: " << demoTics << " tics in " << timedemoFrames
+                          << " frames, " << std::fixed << std::setprecision(2) << seconds
+                          << " s, " << timedemoFrames / seconds << " fps average\n";
             }
+            window.close();
         }
         
         // Render
         window.clear();
         
-        if (gameState == GameState::Title) {
-            // Title screen
-            sf::Sprite titleSprite(titleTexture);
-            float scaleX = static_cast<float>(SCREEN_WIDTH) / titleTexture.getSize().x;
-            float scaleY = static_cast<float>(SCREEN_HEIGHT) / titleTexture.getSize().y;
-            titleSprite.setScale({scaleX, scaleY});
-            window.draw(titleSprite);
+        if (gameState == GameState::Loading) {
+            const AssetManager& manager = assets.manager;
+            loadingFill.setSize({loadingBarSize.x * manager.progress(), loadingBarSize.y});
+            loadingText.set("Loading ", manager.finished(), " / ", manager.requested());
+            window.draw(loadingFrame);
+            window.draw(loadingFill);
+            window.draw(loadingText.text());
             
-            sf::Text startText(font, "Click or Press ENTER to Start\nESC to Quit", 32);
-            startText.setFillColor(sf::Color::Red);
-            startText.setPosition({SCREEN_WIDTH / 2.f - 200, SCREEN_HEIGHT - 100.f});
+        } else if (gameState == GameState::Title) {
+            window.draw(titleSprite);
             window.draw(startText);
             
         } else if (gameState == GameState::Playing) {
-            // Render 3D view
-            renderRaycaster(window, player, worldMap, enemies, pickups, wallTexture);
-            
-            // HUD overlay
-            sf::RectangleShape hudBg({static_cast<float>(SCREEN_WIDTH), 60.f});
-            hudBg.setPosition({0.f, static_cast<float>(SCREEN_HEIGHT - 60)});
-            hudBg.setFillColor(sf::Color(0, 0, 0, 180));
-            window.draw(hudBg);
-            
-            // Health bar
-            sf::RectangleShape healthBar({200.f * (player.health / 100.f), 30.f});
-            healthBar.setPosition({20.f, static_cast<float>(SCREEN_HEIGHT - 50)});
-            healthBar.setFillColor(player.health > 50 ? sf::Color::Green : 
-                                   player.health > 25 ? sf::Color::Yellow : sf::Color::Red);
-            window.draw(healthBar);
-            
-            std::stringstream hudText;
-            hudText << "Health: " << player.health << "  "
-                    << "Ammo: " << player.ammo << "  "
-                    << "Score: " << player.score << "  "
-                    << "Kills: " << player.kills << "/" << enemies.size() << "  "
-                    << "FPS: " << static_cast<int>(fps);
-            
-            sf::Text hud(font, hudText.str(), 20);
-            hud.setFillColor(sf::Color::White);
-            hud.setPosition({240.f, static_cast<float>(SCREEN_HEIGHT - 45)});
-            window.draw(hud);
-            
-            // Crosshair
-            sf::RectangleShape crosshairH({20.f, 2.f});
-            crosshairH.setPosition({SCREEN_WIDTH / 2.f - 10, SCREEN_HEIGHT / 2.f - 1});
-            crosshairH.setFillColor(sf::Color::Green);
-            window.draw(crosshairH);
-            
-            sf::RectangleShape crosshairV({2.f, 20.f});
-            crosshairV.setPosition({SCREEN_WIDTH / 2.f - 1, SCREEN_HEIGHT / 2.f - 10});
-            crosshairV.setFillColor(sf::Color::Green);
-            window.draw(crosshairV);
+            // A timedemo draws each tick as it lands
+            const float alpha = config.timedemo ? 1.0f : world->simAccumulator / world->timestep;
+            if (session) {
+                const Player predicted = predictedView(*world, *session, alpha);
+                drawPlayView(window, renderContext, *world, hud, static_cast<int>(fps), alpha, localSlot, &predicted);
+            } else {
+                drawPlayView(window, renderContext, *world, hud, static_cast<int>(fps), alpha);
+            }
             
         } else if (gameState == GameState::Victory) {
-            sf::Sprite victorySprite(victoryTexture);
-            float scaleX = static_cast<float>(SCREEN_WIDTH) / victoryTexture.getSize().x;
-            float scaleY = static_cast<float>(SCREEN_HEIGHT) / victoryTexture.getSize().y;
-            victorySprite.setScale({scaleX, scaleY});
             window.draw(victorySprite);
-            
-            std::stringstream victoryText;
-            victoryText << "VICTORY!\n\nFinal Score: " << player.score
-                       << "\nKills: " << player.kills
-                       << "\nPress ESC to exit";
-            
-            sf::Text text(font, victoryText.str(), 48);
-            text.setFillColor(sf::Color::Yellow);
-            text.setOutlineColor(sf::Color::Black);
-            text.setOutlineThickness(3);
-            text.setPosition({SCREEN_WIDTH / 2.f - 200, SCREEN_HEIGHT / 2.f - 100});
-            window.draw(text);
+            victoryText.set("VICTORY!\n\nFinal Score: ", player.score,
+                            "\nKills: ", player.kills,
+                            "\nPress ESC to exit");
+            window.draw(victoryText.text());
             
         } else if (gameState == GameState::GameOver) {
             window.clear(sf::Color::Red);
-            
-            sf::Text gameOverText(font, "GAME OVER\n\nPress ESC to exit", 64);
-            gameOverText.setFillColor(sf::Color::Black);
-            gameOverText.setPosition({SCREEN_WIDTH / 2.f - 250, SCREEN_HEIGHT / 2.f - 100});
             window.draw(gameOverText);
         }
         
-        window.display();
+        profilerOverlay.update(profiler);
+        profilerOverlay.draw(window);
+        
+        // Dynamic resolution judges the frame's own work; the wait in
+        // display() is pacing, and under vsync would hide any headroom
+        if (gameState == GameState::Playing) {
+            renderContext.adaptResolution(workClock.getElapsedTime().asSeconds() * 1000.0);
+        }
+        {
+            ProfileScope scope(ProfileStage::Display);
+            window.display();
+        }
+        profiler.endFrame();
+    }
+    profiler.stopCapture();
+    if (session) session->leave();
+    
+    if (recording) {
+        if (demo.save(config.recordPath)) {
+            std::cout << "Recorded " << demo.tics.size() << " tics to " << config.recordPath.string() << "\n";
+        } else {
+            std::cerr << "Could not write demo to " << config.recordPath.string() << "\n";
+        }
+    }
+    if (recording || playingDemo) {
+        std::cout << "Demo: " << demoTics << " tics, world checksum " << std::hex << worldChecksum(*world)
+                  << std::dec << "\n";
+    }
+    if (session) printNetStats(*session);
+    if (world->stream) {
+        const WorldStream& stream = *world->stream;
+        std::cout << "World stream: " << stream.generatedChunks() << " chunks generated, "
+                  << stream.cachedChunks() << " of " << stream.cacheCapacity() << " cached, "
+                  << stream.evictedChunks() << " evicted\n";
+    }
+    if (renderContext.interlace) {
+        const InterlacedCaster& interlace = *renderContext.interlace;
+        std::cout << "Interlacing: " << interlace.interlacedFrames() << " frames interlaced, "
+                  << interlace.fullFrames() << " cast in full; " << interlace.rebuiltColumns()
+                  << " columns rebuilt, " << interlace.recastColumns() << " cast after all\n";
+    }
+    if (renderContext.resolution) {
+        std::cout << "Dynamic resolution: " << renderContext.resolution->changes() << " changes, ending at "
+                  << renderContext.viewWidth() << "x" << renderContext.viewHeight() << "\n";
+    }
+    std::cout << "HUD: " << hud.textRebuilds() << " text and " << hud.batchRebuilds() << " batch rebuilds over "
+              << totalFrames << " frames\n";
+    const ParticlePool& particles = world->particles;
+    const ProjectileStore& projectiles = world->projectiles;
+    std::cout << "Particle pool: peak " << particles.pressure.peak << " of " << particles.pressure.capacity
+              << ", " << particles.pressure.dropped << " dropped\n";
+    std::cout << "Projectile pool: peak " << projectiles.pressure.peak << " of " << projectiles.pressure.capacity
+              << ", " << projectiles.pressure.dropped << " dropped\n";
+    if (audio) {
+        std::cout << "Audio: " << audio->started() << " sounds on " << audio->voices() << " voices, "
+                  << audio->stolen() << " stolen, " << audio->dropped() << " dropped, "
+                  << audio->culled() << " inaudible or missing; cue queue peak " << world->cues.pressure.peak
+                  << " of " << world->cues.pressure.capacity << "\n";
     }
     
     return 0;
@@ -1,637 +1,569 @@
 #include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
-#include <vector>
-#include <random>
-#include <ctime>
-#include <optional>
-#include <cmath>
 #include <algorithm>
-#include <string>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <vector>
 
-//gaeme entity states (call them back again)
-enum class GameState { Loading, Playing, GameOver };
-enum class TileType { Grass, Trees, Water };
-enum class EnemyType { Wolf, SmokeDemon, TophatOgre, RedDemon };
-
-//player data for all the actions (no enemy logic here )
-struct Player {
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
-    sf::Vector2f facingDirection = {0, -1};
-    int health = 100;
-    sf::Clock damageClock;
-
-    Player(const sf::Texture& texture) : sprite(texture) {}
+#include "audio_engine.hpp"
+#include "cellular_automaton.hpp"
+#include "dungeon_gen.hpp"
+#include "engine_config.hpp"
+#include "game_assets.hpp"
+#include "hud.hpp"
+#include "tile_map.hpp"
+#include "worker_pool.hpp"
+
+// ===========================================
+// PROCEDURAL ADVENTURE
+// A forest seen from above that wraps at its edges: grass to walk on,
+// trees and the odd pool of water around it. Walk it with WASD, shoot
+// with Space and outlast the enemies that keep walking out of the woods.
+// The forest grows on the engine's cellular automaton and every sprite is
+// a frame of the engine's atlas, but the movement, spawning and damage
+// rules are this front end's own, stepped by frame time in screen pixels
+// rather than by the engine's ticks.
+// ===========================================
+
+const int WORLD_WIDTH = 200;
+const int WORLD_HEIGHT = 200;
+
+// Screen pixels per map tile, 16-pixel tiles at 3x
+constexpr float TILE_SIZE = 48.0f;
+
+// Tiles of res/textures/world.png, by pixel
+const sf::Vector2i GRASS_TEXEL{0, 0};
+const sf::Vector2i TREES_TEXEL{16 * 5, 0};
+const sf::Vector2i WATER_TEXEL{16 * 10, 16 * 20};
+constexpr int TEXEL_SIZE = 16;
+
+// The character's frame of res/textures/character.png. Sprites are drawn
+// at a whole number of screen pixels per source pixel.
+const sf::IntRect PLAYER_FRAME{{64, 240}, {16, 24}};
+constexpr float PLAYER_SCALE = 4.0f;
+constexpr float SHOT_SCALE = 2.0f;
+constexpr float BLOOD_SCALE = 2.0f;
+
+// Rules, in screen pixels and seconds
+constexpr int PLAYER_HEALTH = 100;
+constexpr float PLAYER_SPEED = 150.0f;     // doubled while Enter is held
+constexpr float SHOT_SPEED = 300.0f;
+constexpr float SHOT_COOLDOWN = 0.5f;
+constexpr int SHOT_DAMAGE = 25;
+constexpr int CONTACT_DAMAGE = 25;         // then the player flashes, untouchable
+constexpr float INVINCIBILITY_TIME = 1.0f;
+constexpr float SPAWN_INTERVAL = 2.0f;     // one enemy each, while fewer than MAX_ENEMIES
+constexpr std::size_t MAX_ENEMIES = 20;
+constexpr int BLOOD_PER_HIT = 3;
+constexpr float LOADING_TIME = 3.0f;       // the loading screen shows at least this long
+
+// Per EnemyType: health, speed and drawn scale. A kill scores 10 more for
+// each type down the list.
+struct EnemyKind {
+    int health;
+    float speed;
+    float scale;
 };
-
-struct Bullet {
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
-    
-    Bullet(const sf::Texture& texture) : sprite(texture) {
-        sprite.setScale({2.0f, 2.0f});
-        sprite.setOrigin({(float)texture.getSize().x / 2.f, (float)texture.getSize().y / 2.f});
-    }
+constexpr std::array<EnemyKind, ENEMY_TYPES> ENEMY_KINDS{{
+    {30, 120.0f, 2.0f},  // Wolf
+    {50, 80.0f, 2.5f},   // SmokeDemon
+    {70, 60.0f, 2.0f},   // TophatOgre
+    {100, 50.0f, 3.0f},  // Demon, in red
+}};
+
+const EnemyKind& kindOf(EnemyType type) { return ENEMY_KINDS[static_cast<int>(type)]; }
+
+// Loading screen layers, back to front, scrolling faster towards the front
+struct ParallaxFile {
+    const char* path;
+    float speed;
 };
+constexpr std::array<ParallaxFile, 5> PARALLAX_FILES{{
+    {"res/textures/parallax-mountain-bg.png", 0.1f},
+    {"res/textures/parallax-mountain-montain-far.png", 0.2f},
+    {"res/textures/parallax-mountain-mountains.png", 0.4f},
+    {"res/textures/parallax-mountain-trees.png", 0.6f},
+    {"res/textures/parallax-mountain-foreground-trees.png", 0.8f},
+}};
+constexpr float PARALLAX_SCALE = 2.0f;
+constexpr float PARALLAX_RATE = 30.0f;     // pixels a second at speed 1
 
+enum class GameState { Loading, Playing, GameOver };
+
+// Positions are in screen pixels of the unwrapped plane; the forest
+// repeats across it every WORLD_WIDTH x WORLD_HEIGHT tiles
 struct Enemy {
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
+    sf::Vector2f position;
     EnemyType type;
     int health;
-    float speed;
-    
-    Enemy(const sf::Texture& texture, EnemyType t, int hp, float spd) 
-        : sprite(texture), type(t), health(hp), speed(spd) {}
+    float age; // seconds since it spawned, for its walk
+};
+
+struct Shot {
+    sf::Vector2f position, velocity;
+    float age;
 };
 
-struct BloodParticle {
-    sf::Sprite sprite;
-    sf::Vector2f velocity;
-    sf::Clock lifeClock;
-    float lifetime;
-    int frameIndex;
-    
-    BloodParticle(const sf::Texture& texture) : sprite(texture), lifetime(0.5f), frameIndex(0) {}
+struct Blood {
+    sf::Vector2f position, velocity;
+    float age, lifetime;
 };
 
-//loading screen data's 
-struct ParallaxLayer {
-    sf::Sprite sprite;
-    float scrollSpeed;
-    float offset;
-    
-    ParallaxLayer(const sf::Texture& texture, float speed) : sprite(texture), scrollSpeed(speed), offset(0.0f) {
-        sprite.setScale({2.0f, 2.0f}); 
+// What the view keeps between frames. The forest marks its water here as
+// it grows, since the map only knows what blocks.
+struct TopDownView {
+    BitCellGrid water{0, 0};       // live where a blocking tile is water
+    std::vector<sf::Vertex> tiles; // refilled every frame, kept for its capacity
+};
+
+/*Cellular automata is used to create natural clusters of trees and grass.
+
+For 5 simulation steps:
+
+Count the number of neighboring tree tiles (tiles off the map count as trees).
+
+If more than 4 neighbors are Trees → current tile becomes Trees.
+
+If fewer than 4 neighbors are Trees → current tile becomes Grass.
+
+This smooths the world and forms clusters instead of random noise
+
+Each step adds up the neighbours of 64 cells at once from the packed bits
+and splits the rows across threads (see cellular_automaton.hpp).
+
+Trees and water are walls of the map; the view tells them apart.
+*/
+void generateWorld(TileMap& map, BitCellGrid& water, std::uint64_t seed, WorkerPool* workers) {
+    const int worldWidth = map.width();
+    const int worldHeight = map.height();
+    DungeonRng rng(seed);
+    int initialTreeChance = 45;
+
+    // Generate base pattern, one bit per tree cell
+    BitCellGrid trees(worldWidth, worldHeight);
+    for (int y = 0; y < worldHeight; ++y) {
+        for (int x = 0; x < worldWidth; ++x) {
+            // Use a combination of noise and patterns for more natural distribution
+            int noise = rng.range(0, 100);
+            int patternNoise = ((x * 7 + y * 11) % 100);
+            int combinedNoise = (noise + patternNoise) / 2;
+
+            trees.set(x, y, combinedNoise <= initialTreeChance);
+        }
+    }
+
+    int simulationSteps = 5;
+    for (int i = 0; i < simulationSteps; ++i) {
+        trees.step(4, workers);
+    }
+
+    water = BitCellGrid(worldWidth, worldHeight);
+    for (int y = 0; y < worldHeight; ++y) {
+        for (int x = 0; x < worldWidth; ++x) {
+            int waterChance = ((x * 13 + y * 17) % 100);
+            const bool pool = !trees.alive(x, y) && waterChance < 3; // 3% chance for water
+            water.set(x, y, pool);
+            map.set(x, y, trees.alive(x, y) || pool ? TileType::Wall : TileType::Empty);
+        }
+    }
+}
+
+// Tile under a pixel of the unwrapped plane
+bool isGrass(const TileMap& map, sf::Vector2f position) {
+    const int x = static_cast<int>(std::floor(position.x / TILE_SIZE));
+    const int y = static_cast<int>(std::floor(position.y / TILE_SIZE));
+    return !map.isWall(((x % map.width()) + map.width()) % map.width(),
+                       ((y % map.height()) + map.height()) % map.height());
+}
+
+// Centre of a random grass tile, or of the map when none turns up
+sf::Vector2f findValidSpawn(const TileMap& map, DungeonRng& rng) {
+    int x, y;
+    if (!findEmptySpot(map, rng, x, y)) {
+        x = map.width() / 2;
+        y = map.height() / 2;
+    }
+    return sf::Vector2f(x + 0.5f, y + 0.5f) * TILE_SIZE;
+}
+
+// Two triangles over the pixel square at position, sampling texels
+void appendQuad(std::vector<sf::Vertex>& vertices, sf::Vector2f position, sf::Vector2f size,
+                sf::FloatRect texels, sf::Color color = sf::Color::White) {
+    const sf::Vector2f corners[4] = {position, {position.x + size.x, position.y},
+                                     position + size, {position.x, position.y + size.y}};
+    const sf::Vector2f uv[4] = {texels.position, {texels.position.x + texels.size.x, texels.position.y},
+                                texels.position + texels.size, {texels.position.x, texels.position.y + texels.size.y}};
+    for (int corner : {0, 1, 2, 0, 2, 3}) vertices.push_back({corners[corner], color, uv[corner]});
+}
+
+// The enemy's walk, in its type's first look
+const AtlasFrame* enemyFrame(const GameAssets& assets, const Enemy& enemy) {
+    const EnemyArt* look = assets.enemyLook(enemy.type, 0);
+    return look ? look->walk.frameAt(enemy.age) : nullptr;
+}
+
+// Screen pixels of the square an atlas frame is placed in, drawn at
+// scale: its group's largest side, in source pixels, times scale
+float frameSide(const AtlasFrame* frame, float scale) {
+    if (!frame || frame->box.size.y <= 0) return TILE_SIZE;
+    return scale * static_cast<float>(frame->rect.size.y) / frame->box.size.y;
+}
+
+// What the frame covers of the side-pixel square centred at centre, for
+// hits; the whole square for a frame that did not load
+sf::FloatRect frameBounds(const AtlasFrame* frame, sf::Vector2f centre, float side) {
+    const sf::Vector2f corner = centre - sf::Vector2f(side, side) / 2.f;
+    if (!frame || !frame->page) return sf::FloatRect(corner, {side, side});
+    return sf::FloatRect(corner + frame->box.position * side, frame->box.size * side);
+}
+
+// Atlas frames batched per page; a frame from another page draws what is
+// queued first, which the few entities of a view rarely cause
+struct FrameBatch {
+    sf::RenderTarget& target;
+    const sf::Texture* page = nullptr;
+    std::vector<sf::Vertex> vertices;
+
+    // Frame placed in the side-pixel square centred at centre, as the
+    // raycaster places it in its billboard
+    void add(const AtlasFrame* frame, sf::Vector2f centre, float side, sf::Color color = sf::Color::White) {
+        if (!frame || !frame->page) return;
+        if (frame->page != page) flush();
+        page = frame->page;
+        const sf::Vector2f corner = centre - sf::Vector2f(side, side) / 2.f;
+        appendQuad(vertices, corner + frame->box.position * side, frame->box.size * side,
+                   sf::FloatRect(sf::Vector2f(frame->rect.position), sf::Vector2f(frame->rect.size)), color);
+    }
+
+    void flush() {
+        if (!vertices.empty()) target.draw(vertices.data(), vertices.size(), sf::PrimitiveType::Triangles, page);
+        vertices.clear();
     }
 };
 
-// --- Helper Functions (Prototypes) ---
-sf::Vector2f findValidSpawn(int, int, float, const std::vector<std::vector<TileType>>&);
-void generateWorld(int, int, std::vector<std::vector<TileType>>&);
-int countTreeNeighbors(int, int, int, int, const std::vector<std::vector<TileType>>&);
-
-int main() {
-    //make sfml draw the window (add more options ig?)
-    const unsigned int WINDOW_WIDTH = 1280;
-    const unsigned int WINDOW_HEIGHT = 720;
-    const int WORLD_WIDTH = 200;
-    const int WORLD_HEIGHT = 200;
-    const float SPRITE_SCALE = 3.0f; 
-    const float TILE_SIZE = 16.0f * SPRITE_SCALE;
-    const float PLAYER_SCALE = 4.0f;  // Larger player sprite 
-
-    sf::RenderWindow window(sf::VideoMode({WINDOW_WIDTH, WINDOW_HEIGHT}), "Procedural Adventure");
-    window.setFramerateLimit(60);
-
-    
-    sf::Font font;
-    if (!font.openFromFile("res/arial.ttf")) { std::cerr << "Could not load font\n"; return -1; }
-    
-    // Player and world textures
-    sf::Texture playerTexture, overworldTexture; 
-    if (!playerTexture.loadFromFile("res/textures/character.png")) { std::cerr << "Could not load character.png\n"; return -1; }
-    if (!overworldTexture.loadFromFile("res/textures/world.png")) { std::cerr << "Could not load world.png\n"; return -1; }
-    
-    // Enemy textures
-    sf::Texture wolfTexture, smokeDemonTexture, tophatOgreTexture, redDemonTexture;
-    if (!wolfTexture.loadFromFile("res/textures/wolf.png")) { std::cerr << "Could not load wolf.png\n"; return -1; }
-    if (!smokeDemonTexture.loadFromFile("res/textures/smoke-demon.png")) { std::cerr << "Could not load smoke-demon.png\n"; return -1; }
-    if (!tophatOgreTexture.loadFromFile("res/textures/tophat-ogre.png")) { std::cerr << "Could not load tophat-ogre.png\n"; return -1; }
-    if (!redDemonTexture.loadFromFile("res/textures/Demon/Red/ALBUM008_72.png")) { std::cerr << "Could not load red demon\n"; return -1; }
-    
-    // Blood effect textures
-    sf::Texture bloodTextures[4];
-    if (!bloodTextures[0].loadFromFile("res/textures/Blood/BLUDA0.png")) { std::cerr << "Could not load blood 0\n"; return -1; }
-    if (!bloodTextures[1].loadFromFile("res/textures/Blood/BLUDB0.png")) { std::cerr << "Could not load blood 1\n"; return -1; }
-    if (!bloodTextures[2].loadFromFile("res/textures/Blood/BLUDC0.png")) { std::cerr << "Could not load blood 2\n"; return -1; }
-    if (!bloodTextures[3].loadFromFile("res/textures/Blood/BLUDD0.png")) { std::cerr << "Could not load blood 3\n"; return -1; }
-    
-    // Projectile texture
-    sf::Texture projectileTexture;
-    if (!projectileTexture.loadFromFile("res/textures/Player Projectiles/WIDBALL.cells/000.PNG")) { std::cerr << "Could not load projectile\n"; return -1; }
-    
-    // the mountain for bg 
-    sf::Texture mountainBg, mountainFar, mountainMid, mountainTrees, mountainForeground;
-    if (!mountainBg.loadFromFile("res/textures/parallax-mountain-bg.png")) { std::cerr << "Could not load mountain background\n"; return -1; }
-    if (!mountainFar.loadFromFile("res/textures/parallax-mountain-montain-far.png")) { std::cerr << "Could not load mountain far\n"; return -1; }
-    if (!mountainMid.loadFromFile("res/textures/parallax-mountain-mountains.png")) { std::cerr << "Could not load mountain mid\n"; return -1; }
-    if (!mountainTrees.loadFromFile("res/textures/parallax-mountain-trees.png")) { std::cerr << "Could not load mountain trees\n"; return -1; }
-    if (!mountainForeground.loadFromFile("res/textures/parallax-mountain-foreground-trees.png")) { std::cerr << "Could not load mountain foreground\n"; return -1; }
-    
-    playerTexture.setSmooth(false);
-    overworldTexture.setSmooth(false);
-    wolfTexture.setSmooth(false);
-    smokeDemonTexture.setSmooth(false);
-    tophatOgreTexture.setSmooth(false);
-    redDemonTexture.setSmooth(false);
-    for (int i = 0; i < 4; i++) bloodTextures[i].setSmooth(false);
-    projectileTexture.setSmooth(false);
-    mountainBg.setSmooth(true);
-    mountainFar.setSmooth(true);
-    mountainMid.setSmooth(true);
-    mountainTrees.setSmooth(true);
-    mountainForeground.setSmooth(true);
-
-    sf::IntRect grassRect({0, 0}, {16, 16});
-    sf::IntRect treesRect({16 * 5, 0}, {16, 16});
-    sf::IntRect waterRect({16 * 10, 16 * 20}, {16, 16});
-    
-    std::vector<std::vector<TileType>> grid;
-    generateWorld(WORLD_WIDTH, WORLD_HEIGHT, grid);
-    
-    sf::Music music;
-    if (!music.openFromFile("res/sfx/music.ogg")) { std::cerr << "Could not load music.ogg\n"; return -1; }
-    music.setVolume(50);
-    
-    //loader for the L screen 
-    std::vector<ParallaxLayer> parallaxLayers;
-    parallaxLayers.emplace_back(mountainBg, 0.1f);        // Background - slowest
-    parallaxLayers.emplace_back(mountainFar, 0.2f);       // Far mountains
-    parallaxLayers.emplace_back(mountainMid, 0.4f);       // Mid mountains
-    parallaxLayers.emplace_back(mountainTrees, 0.6f);     // Trees
-    parallaxLayers.emplace_back(mountainForeground, 0.8f); // Foreground - fastest
-    
-    // Position layers to cover the screen
-    for (auto& layer : parallaxLayers) {
-        layer.sprite.setPosition({0, WINDOW_HEIGHT - layer.sprite.getGlobalBounds().size.y});
+// The forest's tiles under the view, in one call, repeating the map past
+// its edges
+void drawForest(TopDownView& context, sf::RenderTarget& target, const TileMap& map, const sf::Texture* tileset) {
+    const sf::View& view = target.getView();
+    const int startX = static_cast<int>(std::floor((view.getCenter().x - view.getSize().x / 2) / TILE_SIZE)) - 1;
+    const int endX = static_cast<int>(std::floor((view.getCenter().x + view.getSize().x / 2) / TILE_SIZE)) + 2;
+    const int startY = static_cast<int>(std::floor((view.getCenter().y - view.getSize().y / 2) / TILE_SIZE)) - 1;
+    const int endY = static_cast<int>(std::floor((view.getCenter().y + view.getSize().y / 2) / TILE_SIZE)) + 2;
+
+    std::vector<sf::Vertex>& tiles = context.tiles;
+    tiles.clear();
+    for (int y = startY; y < endY; y++) {
+        const int wrappedY = ((y % map.height()) + map.height()) % map.height();
+        for (int x = startX; x < endX; x++) {
+            const int wrappedX = ((x % map.width()) + map.width()) % map.width();
+            const sf::Vector2i texel = !map.isWall(wrappedX, wrappedY)       ? GRASS_TEXEL
+                                       : context.water.alive(wrappedX, wrappedY) ? WATER_TEXEL
+                                                                                 : TREES_TEXEL;
+            appendQuad(tiles, sf::Vector2f(static_cast<float>(x), static_cast<float>(y)) * TILE_SIZE,
+                       {TILE_SIZE, TILE_SIZE},
+                       sf::FloatRect(sf::Vector2f(texel), sf::Vector2f(TEXEL_SIZE, TEXEL_SIZE)));
+        }
     }
-    
-    // Loading screen variables
-    float loadingProgress = 0.0f;
-    sf::Clock loadingClock;
-    const float loadingDuration = 3.0f; 
-    GameState gameState = GameState::Loading;
-    
-    // Use one frame definition for player
-    sf::IntRect playerFrameRect({64, 240}, {16, 24});
-
-    // player data setup for drawing 
-    Player player(playerTexture); 
-    player.sprite.setTextureRect(playerFrameRect); 
-    player.sprite.setScale({PLAYER_SCALE, PLAYER_SCALE});  // Larger player sprite
-    player.sprite.setOrigin({(float)playerFrameRect.size.x / 2.f, (float)playerFrameRect.size.y / 2.f});
-    float playerSpeed = 150.0f;
-    const sf::Time invincibilityDuration = sf::seconds(1.0f);
-    
-    
-    std::vector<Bullet> bullets;
-    std::vector<Enemy> enemies;
-    std::vector<BloodParticle> bloodParticles;
-    float bulletSpeed = 300.0f;
-    int score = 0;
-    sf::Clock shootClock, enemySpawnClock;
-    const sf::Time enemySpawnCooldown = sf::seconds(2.0f);
-    const int maxEnemies = 20;
-    
-    // Random number generator for enemy variety
-    std::mt19937 rng(static_cast<unsigned int>(time(0)));
-    std::uniform_int_distribution<int> enemyTypeDist(0, 3);
-
-    // --- UI Elements ---
-    sf::Text scoreText(font, "Score: 0", 24);
-    sf::Text gameOverText(font, "GAME OVER", 96);
-    sf::Text finalScoreText(font, "", 48);
-    sf::Text exitText(font, "Press any key to exit", 24);
+    if (tileset && !tiles.empty()) target.draw(tiles.data(), tiles.size(), sf::PrimitiveType::Triangles, tileset);
+}
+
+int main(int argc, char* argv[]) {
+    const EngineConfig config = parseConfig(argc, argv);
+    const auto screenWidth = static_cast<float>(config.screenWidth);
+    const auto screenHeight = static_cast<float>(config.screenHeight);
+    sf::RenderWindow window(sf::VideoMode({config.screenWidth, config.screenHeight}), "Procedural Adventure");
+    window.setVerticalSyncEnabled(config.pacing == FramePacing::VSync);
+    window.setFramerateLimit(config.pacing == FramePacing::Capped ? config.frameCap : 0);
+
+    // The character joins the engine's frames in the atlas, which is then
+    // cached apart from the raycasters' so neither repacks the other's
+    GameAssets assets;
+    const int playerFrame = assets.sprites.add(assets.sprites.group(SpriteAtlas::Anchor::Centre),
+                                               "res/textures/character.png", PLAYER_FRAME);
+    if (!requestAssets(assets, config.atlasCache.empty() ? config.atlasCache : config.atlasCache / "topdown")) {
+        return -1;
+    }
+    std::unique_ptr<AudioEngine> audio;
+    if (config.audio) audio = std::make_unique<AudioEngine>(SFX_COUNT);
+
+    // The loading screen's layers load up front, so they show while the
+    // rest decodes
+    std::array<sf::Texture, PARALLAX_FILES.size()> parallaxTextures;
+    std::vector<sf::Sprite> parallax;
+    std::vector<float> parallaxOffsets;
+    for (std::size_t i = 0; i < PARALLAX_FILES.size(); i++) {
+        if (!parallaxTextures[i].loadFromFile(PARALLAX_FILES[i].path)) {
+            std::cerr << "Could not load " << PARALLAX_FILES[i].path << "\n";
+            continue;
+        }
+        parallaxTextures[i].setSmooth(true);
+        sf::Sprite& layer = parallax.emplace_back(parallaxTextures[i]);
+        layer.setScale({PARALLAX_SCALE, PARALLAX_SCALE});
+        layer.setPosition({0, screenHeight - layer.getGlobalBounds().size.y});
+        parallaxOffsets.push_back(0.0f);
+    }
+
+    WorkerPool workers(config.workerThreads > 0 ? config.workerThreads : WorkerPool::hardwareThreads());
+    TileMap map(WORLD_WIDTH, WORLD_HEIGHT, config.mapLayout);
+    TopDownView forest;
+    generateWorld(map, forest.water, config.seed, &workers);
+    std::cout << "Grew a " << WORLD_WIDTH << "x" << WORLD_HEIGHT << " forest from seed " << config.seed << "\n";
+    DungeonRng rng(mixSeed(config.seed, 2));
+
+    sf::Text loadingTitle(assets.font, "PROCEDURAL ADVENTURE", 48);
+    loadingTitle.setStyle(sf::Text::Bold);
+    const sf::FloatRect titleBounds = loadingTitle.getLocalBounds();
+    loadingTitle.setOrigin({titleBounds.size.x / 2.f, titleBounds.size.y / 2.f});
+    loadingTitle.setPosition({screenWidth / 2.f, screenHeight / 2.f});
+
+    CachedText scoreText(assets.font, 24, sf::Color::White, {10.f, 10.f});
     sf::RectangleShape healthBarBack({150.f, 15.f});
     sf::RectangleShape healthBarFront = healthBarBack;
-    healthBarBack.setFillColor(sf::Color(50,50,50,200));
+    healthBarBack.setFillColor(sf::Color(50, 50, 50, 200));
     healthBarFront.setFillColor(sf::Color::Red);
-    sf::RectangleShape gameOverOverlay({(float)WINDOW_WIDTH, (float)WINDOW_HEIGHT});
-    gameOverOverlay.setFillColor(sf::Color(0,0,0,150));
-    
-    // --- Loading Screen UI ---
-    sf::Text loadingTitle(font, "PROCEDURAL ADVENTURE", 48);
-    
-    // Style loading screen elements
-    loadingTitle.setFillColor(sf::Color::White);
-    loadingTitle.setStyle(sf::Text::Bold);
-    
-    // Center loading screen elements
-    sf::FloatRect titleBounds = loadingTitle.getLocalBounds();
-    loadingTitle.setOrigin({titleBounds.size.x / 2.f, titleBounds.size.y / 2.f});
-    loadingTitle.setPosition({WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f});
+    healthBarBack.setPosition({10.f, 40.f});
+    healthBarFront.setPosition({10.f, 40.f});
+    sf::RectangleShape gameOverOverlay({screenWidth, screenHeight});
+    gameOverOverlay.setFillColor(sf::Color(0, 0, 0, 150));
+    sf::Text gameOverText(assets.font, "GAME OVER", 96);
+    CachedText finalScoreText(assets.font, 48, sf::Color::White, {});
+    sf::Text exitText(assets.font, "Press any key to exit", 24);
+    auto centre = [&](sf::Text& text, float offsetY) {
+        const sf::FloatRect bounds = text.getLocalBounds();
+        text.setOrigin({bounds.size.x / 2.f, bounds.size.y / 2.f});
+        text.setPosition({screenWidth / 2.f, screenHeight / 2.f + offsetY});
+    };
+    centre(gameOverText, -50.f);
+    centre(exitText, 120.f);
 
+    GameState gameState = GameState::Loading;
+    sf::Vector2f playerPosition;
+    sf::Vector2f facing{0.f, -1.f};
+    int health = PLAYER_HEALTH;
+    int score = 0;
+    float sinceDamage = INVINCIBILITY_TIME;
+    float sinceShot = SHOT_COOLDOWN;
+    float sinceSpawn = 0;
+    std::vector<Enemy> enemies;
+    std::vector<Shot> shots;
+    std::vector<Blood> blood;
+    sf::View camera(sf::FloatRect({0.f, 0.f}, {screenWidth, screenHeight}));
 
-    auto resetGame = [&]() {
-        player.health = 100;
-        player.sprite.setPosition(findValidSpawn(WORLD_WIDTH, WORLD_HEIGHT, TILE_SIZE, grid));
-        player.damageClock.restart();
-        enemies.clear();
-        bullets.clear();
-        bloodParticles.clear();
+    auto startGame = [&]() {
+        playerPosition = findValidSpawn(map, rng);
+        health = PLAYER_HEALTH;
         score = 0;
-        shootClock.restart();
-        enemySpawnClock.restart();
-        music.play();
+        sinceDamage = INVINCIBILITY_TIME;
+        sinceShot = SHOT_COOLDOWN;
+        sinceSpawn = 0;
+        enemies.clear();
+        shots.clear();
+        blood.clear();
+        if (audio && config.music && !audio->playMusic(MUSIC_FILE, MUSIC_VOLUME)) {
+            std::cerr << "Could not open " << MUSIC_FILE.string() << "\n";
+        }
         gameState = GameState::Playing;
     };
-    
-    sf::View view(sf::FloatRect({0.f, 0.f}, {(float)WINDOW_WIDTH, (float)WINDOW_HEIGHT}));
 
-    //game loop for drawing
+    sf::Clock loadingClock;
     sf::Clock deltaClock;
     while (window.isOpen()) {
-        float dt = deltaClock.restart().asSeconds();
-        while (const auto event = window.pollEvent()) { 
+        const float dt = deltaClock.restart().asSeconds();
+        while (const auto event = window.pollEvent()) {
             if (event->is<sf::Event::Closed>()) window.close();
-            if (gameState == GameState::GameOver && event->is<sf::Event::KeyPressed>()) {
-                window.close();
-            }
+            if (gameState == GameState::GameOver && event->is<sf::Event::KeyPressed>()) window.close();
         }
-        
-        
+
         if (gameState == GameState::Loading) {
-            loadingProgress = std::min(1.0f, loadingClock.getElapsedTime().asSeconds() / loadingDuration);
-            
-            
-            for (auto& layer : parallaxLayers) {
-                layer.offset += layer.scrollSpeed * dt * 30.0f; 
-                float layerWidth = layer.sprite.getGlobalBounds().size.x;
-                if (layer.offset >= layerWidth) {
-                    layer.offset = 0.0f;
-                }
-                layer.sprite.setPosition({-layer.offset, layer.sprite.getPosition().y});
+            // Upload what has decoded, a few milliseconds a frame, under
+            // the scrolling mountains
+            const bool loaded = assets.manager.pump(ASSET_UPLOAD_BUDGET);
+            const float progress = std::min(1.0f, loadingClock.getElapsedTime().asSeconds() / LOADING_TIME);
+            for (std::size_t i = 0; i < parallax.size(); i++) {
+                const float width = parallax[i].getGlobalBounds().size.x;
+                parallaxOffsets[i] += PARALLAX_FILES[i].speed * dt * PARALLAX_RATE;
+                if (parallaxOffsets[i] >= width) parallaxOffsets[i] = 0.0f;
             }
-            
-            // Add subtle fade-in effect for text
-            float fadeAlpha = std::min(255.0f, loadingProgress * 255.0f * 2.0f);
-            unsigned char alpha = static_cast<unsigned char>(fadeAlpha);
-            loadingTitle.setFillColor(sf::Color(255, 255, 255, alpha));
-            
-            
-            if (loadingProgress >= 1.0f) {
-                gameState = GameState::Playing;
-                resetGame();
+            const auto fadeIn = static_cast<std::uint8_t>(std::min(1.0f, progress * 2) * 255);
+            loadingTitle.setFillColor(sf::Color(255, 255, 255, fadeIn));
+            if (loaded && progress >= 1.0f) {
+                checkAssets(assets);
+                if (audio) {
+                    for (int i = 0; i < SFX_COUNT; i++) {
+                        audio->define(i, {assets.sfx[i], SFX_FILES[i].priority, SFX_FILES[i].volume});
+                    }
+                }
+                startGame();
             }
         }
-        
-        if (gameState == GameState::Playing && music.getStatus() == sf::SoundSource::Status::Stopped) { 
-            music.play(); 
-        }
 
-        //ALLLLL THE CONTROLSSSSS 
+        const AtlasFrame* playerLook = &assets.sprites.frame(playerFrame);
+        const float playerSide = frameSide(playerLook, PLAYER_SCALE);
         if (gameState == GameState::Playing) {
-            
-            player.velocity = {0.f, 0.f};
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) player.velocity.y -= 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) player.velocity.y += 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) player.velocity.x -= 1;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right) || sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) player.velocity.x += 1;
-            
-            sf::Vector2f moveDir = {0.f, 0.f};
-            if(player.velocity.x != 0 || player.velocity.y != 0){
-                float length = std::sqrt(player.velocity.x * player.velocity.x + player.velocity.y * player.velocity.y);
-                moveDir = sf::Vector2f(player.velocity.x/length, player.velocity.y/length);
-                player.facingDirection = moveDir; 
+            using Key = sf::Keyboard::Key;
+            auto held = [](Key arrow, Key letter) {
+                return sf::Keyboard::isKeyPressed(arrow) || sf::Keyboard::isKeyPressed(letter);
+            };
+            sf::Vector2f move;
+            if (held(Key::Up, Key::W)) move.y -= 1;
+            if (held(Key::Down, Key::S)) move.y += 1;
+            if (held(Key::Left, Key::A)) move.x -= 1;
+            if (held(Key::Right, Key::D)) move.x += 1;
+            if (move.x != 0 || move.y != 0) {
+                facing = move / std::sqrt(move.x * move.x + move.y * move.y);
+                const float speed = PLAYER_SPEED * (sf::Keyboard::isKeyPressed(Key::Enter) ? 2.0f : 1.0f);
+                playerPosition += facing * speed * dt;
             }
-            float currentSpeed = playerSpeed;
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Enter)) { currentSpeed *= 2.0f; }
-            player.sprite.move(moveDir * currentSpeed * dt);
-            
-            //kabbom shoot yall
-            if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space) && shootClock.getElapsedTime() >= sf::seconds(0.5f)) {
-                Bullet newBullet(projectileTexture);
-                newBullet.sprite.setPosition(player.sprite.getPosition());
-                newBullet.velocity = player.facingDirection * bulletSpeed;
-                bullets.push_back(newBullet);
-                shootClock.restart();
+
+            sinceShot += dt;
+            if (sf::Keyboard::isKeyPressed(Key::Space) && sinceShot >= SHOT_COOLDOWN) {
+                shots.push_back({playerPosition, facing * SHOT_SPEED, 0.0f});
+                sinceShot = 0;
             }
-            
-            //enemy :3
-            if (enemies.size() < maxEnemies && enemySpawnClock.getElapsedTime() >= enemySpawnCooldown) {
-                enemySpawnClock.restart();
-                
-                // Randomly select enemy type
-                int typeRoll = enemyTypeDist(rng);
-                EnemyType type = static_cast<EnemyType>(typeRoll);
-                
-                const sf::Texture* enemyTex;
-                sf::IntRect spriteRect;
-                int health;
-                float speed;
-                float scale = 2.0f;
-                
-                switch(type) {
-                    case EnemyType::Wolf:
-                        enemyTex = &wolfTexture;
-                        // Wolf spritesheet: 1024x384, appears to be 8x3 grid = 128x128 per sprite
-                        spriteRect = sf::IntRect({0, 0}, {128, 128});
-                        health = 30;
-                        speed = 120.0f;
-                        scale = 2.0f;
-                        break;
-                    case EnemyType::SmokeDemon:
-                        enemyTex = &smokeDemonTexture;
-                        // Smoke Demon: 960x512, appears to be 6x4 grid = 160x128 per sprite
-                        spriteRect = sf::IntRect({0, 0}, {160, 128});
-                        health = 50;
-                        speed = 80.0f;
-                        scale = 2.5f;
-                        break;
-                    case EnemyType::TophatOgre:
-                        enemyTex = &tophatOgreTexture;
-                        // Tophat Ogre: 960x512, appears to be 6x4 grid = 160x128 per sprite
-                        spriteRect = sf::IntRect({0, 0}, {160, 128});
-                        health = 70;
-                        speed = 60.0f;
-                        scale = 2.0f;
-                        break;
-                    case EnemyType::RedDemon:
-                        enemyTex = &redDemonTexture;
-                        // Red Demon: single sprite (not a sheet)
-                        spriteRect = sf::IntRect({0, 0}, {(int)redDemonTexture.getSize().x, (int)redDemonTexture.getSize().y});
-                        health = 100;
-                        speed = 50.0f;
-                        scale = 3.0f;
-                        break;
-                }
-                
-                Enemy enemy(*enemyTex, type, health, speed);
-                enemy.sprite.setTextureRect(spriteRect);
-                enemy.sprite.setScale({scale, scale});
-                enemy.sprite.setOrigin({(float)spriteRect.size.x / 2.f, (float)spriteRect.size.y / 2.f});
-                enemy.sprite.setPosition(findValidSpawn(WORLD_WIDTH, WORLD_HEIGHT, TILE_SIZE, grid));
-                enemies.push_back(enemy);
+
+            // One enemy of a random type every SPAWN_INTERVAL on any grass,
+            // up to MAX_ENEMIES
+            sinceSpawn += dt;
+            if (enemies.size() < MAX_ENEMIES && sinceSpawn >= SPAWN_INTERVAL) {
+                sinceSpawn = 0;
+                const auto type = static_cast<EnemyType>(rng.range(0, ENEMY_TYPES - 1));
+                enemies.push_back({findValidSpawn(map, rng), type, kindOf(type).health, 0.0f});
             }
 
-            // Updates & Collision.
-            for (auto& enemy : enemies) {
-                sf::Vector2f dirToPlayer = player.sprite.getPosition() - enemy.sprite.getPosition();
-                float dist = std::sqrt(dirToPlayer.x * dirToPlayer.x + dirToPlayer.y * dirToPlayer.y);
-                if (dist > 0) { 
-                    enemy.sprite.move({dirToPlayer.x/dist * enemy.speed * dt, dirToPlayer.y/dist * enemy.speed * dt});
-                }
+            // Enemies walk straight at the player, through anything
+            for (Enemy& enemy : enemies) {
+                enemy.age += dt;
+                const sf::Vector2f toPlayer = playerPosition - enemy.position;
+                const float distance = std::sqrt(toPlayer.x * toPlayer.x + toPlayer.y * toPlayer.y);
+                if (distance > 0) enemy.position += toPlayer / distance * kindOf(enemy.type).speed * dt;
             }
-            
-            for (auto& bullet : bullets) bullet.sprite.move(bullet.velocity * dt);
-            
-            // Bullet collision with terrain and enemies
-            bullets.erase(std::remove_if(bullets.begin(), bullets.end(), [&](Bullet& b) {
-                sf::Vector2i tileCoords((int)b.sprite.getPosition().x / TILE_SIZE, (int)b.sprite.getPosition().y / TILE_SIZE);
-                
-                int wrappedX = ((tileCoords.x % WORLD_WIDTH) + WORLD_WIDTH) % WORLD_WIDTH;
-                int wrappedY = ((tileCoords.y % WORLD_HEIGHT) + WORLD_HEIGHT) % WORLD_HEIGHT;
-                if(grid[wrappedY][wrappedX] != TileType::Grass) return true;
-
-                for (auto& enemy : enemies) {
-                    if (enemy.health > 0 && b.sprite.getGlobalBounds().findIntersection(enemy.sprite.getGlobalBounds()).has_value()) {
-                        enemy.health -= 25;
-                        
-                        // Spawn blood particles
-                        for (int i = 0; i < 3; i++) {
-                            BloodParticle blood(bloodTextures[0]);
-                            blood.sprite.setOrigin({(float)bloodTextures[0].getSize().x / 2.f, (float)bloodTextures[0].getSize().y / 2.f});
-                            blood.sprite.setPosition(enemy.sprite.getPosition());
-                            blood.sprite.setScale({2.0f, 2.0f});
-                            
-                            std::uniform_real_distribution<float> angleDist(0.0f, 6.28318f);
-                            std::uniform_real_distribution<float> speedDist(50.0f, 150.0f);
-                            float angle = angleDist(rng);
-                            float particleSpeed = speedDist(rng);
-                            blood.velocity = {std::cos(angle) * particleSpeed, std::sin(angle) * particleSpeed};
-                            blood.lifetime = std::uniform_real_distribution<float>(0.3f, 0.6f)(rng);
-                            bloodParticles.push_back(blood);
-                        }
-                        
-                        if (enemy.health <= 0) {
-                            score += 10 + static_cast<int>(enemy.type) * 10; // More points for tougher enemies
-                        }
-                        return true;
+            auto enemyBounds = [&](const Enemy& enemy) {
+                const AtlasFrame* frame = enemyFrame(assets, enemy);
+                return frameBounds(frame, enemy.position,
+                                   frameSide(frame, kindOf(enemy.type).scale));
+            };
+
+            // A shot stops at the first tree or water it reaches, or the
+            // first enemy it touches, spraying blood
+            const AtlasFrame* shotFrame = assets.effects.shot.frameAt(0.0f);
+            const float shotSide = frameSide(shotFrame, SHOT_SCALE);
+            shots.erase(std::remove_if(shots.begin(), shots.end(), [&](Shot& shot) {
+                shot.position += shot.velocity * dt;
+                shot.age += dt;
+                if (!isGrass(map, shot.position)) return true;
+                const sf::FloatRect bounds = frameBounds(shotFrame, shot.position, shotSide);
+                for (Enemy& enemy : enemies) {
+                    if (enemy.health <= 0 || !bounds.findIntersection(enemyBounds(enemy))) continue;
+                    enemy.health -= SHOT_DAMAGE;
+                    for (int i = 0; i < BLOOD_PER_HIT; i++) {
+                        const float angle = rng.range(0, 628) / 100.0f;
+                        const float speed = static_cast<float>(rng.range(50, 150));
+                        blood.push_back({enemy.position, sf::Vector2f(std::cos(angle), std::sin(angle)) * speed, 0.0f,
+                                         rng.range(30, 60) / 100.0f});
                     }
+                    if (enemy.health <= 0) score += 10 + static_cast<int>(enemy.type) * 10;
+                    return true;
                 }
                 return false;
-            }), bullets.end());
-            
-            // Update blood particles
-            for (auto& blood : bloodParticles) {
-                blood.sprite.move(blood.velocity * dt);
-                blood.velocity *= 0.95f; // Friction
-                
-                // Animate through blood frames
-                float elapsed = blood.lifeClock.getElapsedTime().asSeconds();
-                blood.frameIndex = std::min(3, static_cast<int>(elapsed / (blood.lifetime / 4.0f)));
-                blood.sprite.setTexture(bloodTextures[blood.frameIndex]);
-                
-                // Fade out
-                float alpha = std::max(0.0f, 1.0f - (elapsed / blood.lifetime));
-                blood.sprite.setColor(sf::Color(255, 255, 255, static_cast<std::uint8_t>(alpha * 255)));
+            }), shots.end());
+            enemies.erase(std::remove_if(enemies.begin(), enemies.end(),
+                                         [](const Enemy& enemy) { return enemy.health <= 0; }),
+                          enemies.end());
+
+            // Blood slows as it flies and runs through its frames over its life
+            for (Blood& drop : blood) {
+                drop.position += drop.velocity * dt;
+                drop.velocity *= 0.95f;
+                drop.age += dt;
             }
-            
-            // Remove expired blood particles
-            bloodParticles.erase(std::remove_if(bloodParticles.begin(), bloodParticles.end(), 
-                [](const BloodParticle& b) { return b.lifeClock.getElapsedTime().asSeconds() >= b.lifetime; }), 
-                bloodParticles.end());
-            
-            enemies.erase(std::remove_if(enemies.begin(), enemies.end(), [](const Enemy& e){ return e.health <= 0; }), enemies.end());
-
-            bool isInvincible = player.damageClock.getElapsedTime() < invincibilityDuration;
-            if (!isInvincible) {
-                for (auto& enemy : enemies) {
-                    if (player.sprite.getGlobalBounds().findIntersection(enemy.sprite.getGlobalBounds()).has_value()) {
-                        player.health -= 25;
-                        player.damageClock.restart();
-                        sf::Vector2f dir = player.sprite.getPosition() - enemy.sprite.getPosition();
-                        float len = std::sqrt(dir.x*dir.x + dir.y*dir.y);
-                        if (len > 0) enemy.sprite.move(-dir/len * TILE_SIZE);
-
-                        if(player.health <= 0) {
-                            player.health = 0;
-                            gameState = GameState::GameOver;
-                            music.stop();
-                            finalScoreText.setString("Final Score: " + std::to_string(score));
-                            sf::FloatRect textBounds = finalScoreText.getLocalBounds();
-                            finalScoreText.setOrigin({textBounds.size.x / 2.f, textBounds.size.y / 2.f});
-                            finalScoreText.setPosition({WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f + 50});
-                            textBounds = gameOverText.getLocalBounds();
-                            gameOverText.setOrigin({textBounds.size.x / 2.f, textBounds.size.y / 2.f});
-                            gameOverText.setPosition({WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f - 50});
-                            textBounds = exitText.getLocalBounds();
-                            exitText.setOrigin({textBounds.size.x / 2.f, textBounds.size.y / 2.f});
-                            exitText.setPosition({WINDOW_WIDTH / 2.f, WINDOW_HEIGHT / 2.f + 120});
-                        }
-                        break; 
+            blood.erase(std::remove_if(blood.begin(), blood.end(),
+                                       [](const Blood& drop) { return drop.age >= drop.lifetime; }),
+                        blood.end());
+
+            // The first enemy touching the player hurts it and is knocked a tile
+            // back, then nothing can for INVINCIBILITY_TIME
+            sinceDamage += dt;
+            if (sinceDamage >= INVINCIBILITY_TIME) {
+                const sf::FloatRect playerBounds = frameBounds(playerLook, playerPosition, playerSide);
+                for (Enemy& enemy : enemies) {
+                    if (!playerBounds.findIntersection(enemyBounds(enemy))) continue;
+                    health = std::max(0, health - CONTACT_DAMAGE);
+                    sinceDamage = 0;
+                    const sf::Vector2f away = playerPosition - enemy.position;
+                    const float distance = std::sqrt(away.x * away.x + away.y * away.y);
+                    if (distance > 0) enemy.position -= away / distance * TILE_SIZE;
+                    if (health == 0) {
+                        gameState = GameState::GameOver;
+                        if (audio) audio->stopMusic();
+                        finalScoreText.set("Final Score: ", score);
+                        centre(finalScoreText.text(), 50.f);
                     }
+                    break;
                 }
             }
-
-            if (isInvincible) {
-                bool flash = static_cast<int>(player.damageClock.getElapsedTime().asMilliseconds() / 100) % 2 == 0;
-                player.sprite.setColor(flash ? sf::Color(255, 255, 255, 100) : sf::Color::White);
-            } else {
-                player.sprite.setColor(sf::Color::White);
-            }
-
-            scoreText.setString("Score: " + std::to_string(score));
-            healthBarFront.setSize({(float)player.health/100.f * 150.f, 15.f});
+            scoreText.set("Score: ", score);
+            healthBarFront.setSize({static_cast<float>(health) / PLAYER_HEALTH * 150.f, 15.f});
         }
 
-        
         window.clear(sf::Color(116, 182, 53));
-        
-        // --- Loading Screen Drawing ---
         if (gameState == GameState::Loading) {
             window.setView(window.getDefaultView());
-            
-            // Draw parallax layers
-            for (const auto& layer : parallaxLayers) {
-                // Draw multiple copies for seamless scrolling
-                float layerWidth = layer.sprite.getGlobalBounds().size.x;
-                int copiesNeeded = static_cast<int>(WINDOW_WIDTH / layerWidth) + 2;
-                
-                for (int i = 0; i < copiesNeeded; ++i) {
-                    sf::Sprite copy = layer.sprite;
-                    copy.setPosition({layer.sprite.getPosition().x + (i * layerWidth), layer.sprite.getPosition().y});
-                    window.draw(copy);
+            for (std::size_t i = 0; i < parallax.size(); i++) {
+                // Copies side by side, for seamless scrolling
+                sf::Sprite& layer = parallax[i];
+                const float width = layer.getGlobalBounds().size.x;
+                const float y = layer.getPosition().y;
+                for (int copy = 0; copy < static_cast<int>(screenWidth / width) + 2; copy++) {
+                    layer.setPosition({copy * width - parallaxOffsets[i], y});
+                    window.draw(layer);
                 }
             }
-            
-            // Draw loading screen UI
             window.draw(loadingTitle);
         } else {
-            // --- Game Drawing ---
-            view.setCenter(player.sprite.getPosition());
-            window.setView(view);
-
-            sf::Sprite tileSprite(overworldTexture);
-            tileSprite.setScale({SPRITE_SCALE, SPRITE_SCALE});
-            
-            // Calculate visible tile range with extra padding for seamless rendering
-            int startX = (int)((view.getCenter().x - view.getSize().x / 2) / TILE_SIZE) - 2;
-            int endX = (int)((view.getCenter().x + view.getSize().x / 2) / TILE_SIZE) + 4;
-            int startY = (int)((view.getCenter().y - view.getSize().y / 2) / TILE_SIZE) - 2;
-            int endY = (int)((view.getCenter().y + view.getSize().y / 2) / TILE_SIZE) + 4;
-
-            for (int y = startY; y < endY; ++y) {
-                for (int x = startX; x < endX; ++x) {
-                    // Use modulo to wrap coordinates, creating infinite world effect
-                    int wrappedX = ((x % WORLD_WIDTH) + WORLD_WIDTH) % WORLD_WIDTH;
-                    int wrappedY = ((y % WORLD_HEIGHT) + WORLD_HEIGHT) % WORLD_HEIGHT;
-                    
-                    switch (grid[wrappedY][wrappedX]) {
-                        case TileType::Grass: tileSprite.setTextureRect(grassRect); break;
-                        case TileType::Trees: tileSprite.setTextureRect(treesRect); break;
-                        case TileType::Water: tileSprite.setTextureRect(waterRect); break;
-                    }
-                    tileSprite.setPosition({(float)x * TILE_SIZE, (float)y * TILE_SIZE});
-                    window.draw(tileSprite);
-                }
+            camera.setCenter(playerPosition);
+            window.setView(camera);
+            drawForest(forest, window, map, assets.wall);
+
+            FrameBatch frames{window};
+            for (const Shot& shot : shots) {
+                const AtlasFrame* frame = assets.effects.shot.frameAt(shot.age);
+                frames.add(frame, shot.position, frameSide(frame, SHOT_SCALE));
+            }
+            const std::vector<int>& bloodFrames = assets.effects.blood.frames;
+            for (const Blood& drop : blood) {
+                if (bloodFrames.empty()) break;
+                const auto index = std::min(bloodFrames.size() - 1,
+                                            static_cast<std::size_t>(drop.age / drop.lifetime * bloodFrames.size()));
+                const AtlasFrame* frame = &assets.sprites.frame(bloodFrames[index]);
+                const auto fade = static_cast<std::uint8_t>(std::max(0.0f, 1.0f - drop.age / drop.lifetime) * 255);
+                frames.add(frame, drop.position, frameSide(frame, BLOOD_SCALE), sf::Color(255, 255, 255, fade));
+            }
+            for (const Enemy& enemy : enemies) {
+                const AtlasFrame* frame = enemyFrame(assets, enemy);
+                frames.add(frame, enemy.position, frameSide(frame, kindOf(enemy.type).scale));
             }
-            
-            for (const auto& bullet : bullets) window.draw(bullet.sprite);
-            for (const auto& blood : bloodParticles) window.draw(blood.sprite);
-            for (const auto& enemy : enemies) window.draw(enemy.sprite);
-            window.draw(player.sprite);
-            
+            // Flashing every 100 ms while untouchable
+            const bool flash = sinceDamage < INVINCIBILITY_TIME && static_cast<int>(sinceDamage * 10) % 2 == 0;
+            frames.add(playerLook, playerPosition, playerSide,
+                       flash ? sf::Color(255, 255, 255, 100) : sf::Color::White);
+            frames.flush();
+
             window.setView(window.getDefaultView());
-            scoreText.setPosition({10, 10});
-            healthBarBack.setPosition({10, 40});
-            healthBarFront.setPosition({10, 40});
-            window.draw(scoreText);
+            window.draw(scoreText.text());
             window.draw(healthBarBack);
             window.draw(healthBarFront);
-
-            if (gameState == GameState::GameOver) { 
+            if (gameState == GameState::GameOver) {
                 window.draw(gameOverOverlay);
                 window.draw(gameOverText);
-                window.draw(finalScoreText);
+                window.draw(finalScoreText.text());
                 window.draw(exitText);
             }
         }
         window.display();
     }
-    return 0;
-}
-
-//  ALL THESE ARE THE MAIN DS FOCUSED FUNCTIONS 
-
-
 
-sf::Vector2f findValidSpawn(int worldWidth, int worldHeight, float tileSize, const std::vector<std::vector<TileType>>& grid){
-    std::mt19937 rng(static_cast<unsigned int>(time(0)));
-    while(true){
-        int x = std::uniform_int_distribution<int>(0, worldWidth - 1)(rng);
-        int y = std::uniform_int_distribution<int>(0, worldHeight - 1)(rng);
-        if(grid[y][x] == TileType::Grass){
-            return {(float)x * tileSize + tileSize / 2, (float)y * tileSize + tileSize / 2};
-        }
-    }
-}
-void generateWorld(int worldWidth, int worldHeight, std::vector<std::vector<TileType>>& grid) {
-    std::mt19937 rng(static_cast<unsigned int>(time(0)));
-    std::uniform_int_distribution<int> noiseDist(0, 100);
-    grid.assign(worldHeight, std::vector<TileType>(worldWidth, TileType::Trees));
-    int initialTreeChance = 45;
-    
-    // Generate base pattern
-    for (int y = 0; y < worldHeight; ++y) {
-        for (int x = 0; x < worldWidth; ++x) {
-            // Use a combination of noise and patterns for more natural distribution
-            int noise = noiseDist(rng);
-            int patternNoise = ((x * 7 + y * 11) % 100);
-            int combinedNoise = (noise + patternNoise) / 2;
-            
-            if (combinedNoise > initialTreeChance) {
-                grid[y][x] = TileType::Grass;
-            }
-        }
-    }
-    
-
-/*Cellular automata is used to create natural clusters of trees and grass.
-
-For 5 simulation steps:
-
-Count the number of neighboring tree tiles (countTreeNeighbors).
-
-If more than 4 neighbors are Trees → current tile becomes Trees.
-
-If fewer than 4 neighbors are Trees → current tile becomes Grass.
-
-This smooths the world and forms clusters instead of random noise 
-
-*/
-
-
-/* Cellular automata are grid-based simulations where each cell’s state (like grass, trees, or water) changes over time based on simple rules and the states of its neighbors*/
-    int simulationSteps = 5;
-    for (int i = 0; i < simulationSteps; ++i) {
-        std::vector<std::vector<TileType>> nextGrid = grid;
-        for (int y = 0; y < worldHeight; ++y) {
-            for (int x = 0; x < worldWidth; ++x) {
-                int neighbors = countTreeNeighbors(x, y, worldWidth, worldHeight, grid);
-                if (neighbors > 4) nextGrid[y][x] = TileType::Trees;
-                else if (neighbors < 4) nextGrid[y][x] = TileType::Grass;
-            }
-        }
-        grid = nextGrid;
-    }
-    
-   
-    for (int y = 0; y < worldHeight; ++y) {
-        for (int x = 0; x < worldWidth; ++x) {
-            if (grid[y][x] == TileType::Grass) {
-                int waterChance = ((x * 13 + y * 17) % 100);
-                if (waterChance < 3) { // 3% chance for water
-                    grid[y][x] = TileType::Water;
-                }
-            }
-        }
-    }
-}
-
-
-/*Used to smooth the map and form realistic tree/grass clusters.*/
-int countTreeNeighbors(int x, int y, int width, int height, const std::vector<std::vector<TileType>>& grid) {
-    int treeCount = 0;
-    for (int ny = y - 1; ny <= y + 1; ++ny) {
-        for (int nx = x - 1; nx <= x + 1; ++nx) {
-            if (nx == x && ny == y) continue;
-            if (nx < 0 || nx >= width || ny < 0 || ny >= height || grid[ny][nx] == TileType::Trees) {
-                treeCount++;
-            }
-        }
-    }
-    return treeCount;
+    std::cout << "Final score " << score << "\n";
+    return 0;
 }
@@ -0,0 +1,638 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "demo.hpp"
+
+// ===========================================
+// LOCKSTEP SESSIONS
+// Up to four players run the same deterministic simulation and trade only
+// their inputs, as DOOM's network games did. Every tick plays one DemoTic
+// per player, so peers that see the same tics stay in step, and a session
+// costs a few bytes per player per tick however much is alive in the world.
+//
+// Peers form a star around the host. Each player sends its tics to the
+// host, which gathers one from every player into a frame per tick and
+// sends the frames on to everyone, its own included. A tic plays
+// inputDelay ticks after it was sampled, long enough on a LAN for it to
+// reach every peer first; the game predicts its own player over the gap.
+// Each side resends whatever the other has not acknowledged, a few ticks
+// to a packet, so a lost datagram costs only the next one's extra bytes.
+//
+// Packets carry send times and their echoes, for round-trip times, and
+// every CHECK_INTERVAL ticks a world checksum, which every peer compares
+// with its own to catch a desync on the tick it shows.
+//
+// Little-endian layout, every packet starting "DN", u8 protocol, u8 type:
+//   Hello    nothing more
+//   Welcome  u8 slot, u8 players, u8 input delay, u16 tick rate, u64 seed,
+//            i32 map width, i32 map height, i32 enemy count, u8 flags
+//   Tics     u32 stamp, u32 echo, u16 held, u32 ack, u32 first, u8 count,
+//            u8 has check, [u32 check tick, u64 checksum], then count
+//            ticks of 3-byte tics: one per tick to the host, one per
+//            player per tick from it
+//   Leave    nothing more
+// ===========================================
+
+class LockstepSession {
+public:
+    static constexpr int MAX_PLAYERS = 4;
+    static constexpr unsigned short DEFAULT_PORT = 5029;
+    static constexpr std::uint8_t PROTOCOL = 1;
+    static constexpr std::uint32_t BUFFER_TICKS = 256;     // tics kept, far more than are ever in flight
+    static constexpr std::uint32_t LEAD_SLACK = 4;         // ticks local input may run past the delay
+    static constexpr std::uint32_t MAX_TICKS_PER_PACKET = 16;
+    static constexpr std::uint32_t CHECK_INTERVAL = 64;    // ticks between checksums
+    static constexpr int CHECK_SENDS = 4;                  // packets each checksum rides on
+    static constexpr std::size_t UDP_OVERHEAD = 28;        // IPv4 and UDP headers, counted in the totals
+    static constexpr std::chrono::milliseconds RESEND_INTERVAL{50};
+    static constexpr std::chrono::milliseconds KEEPALIVE_INTERVAL{250};
+    static constexpr std::chrono::seconds TIMEOUT{10};     // silence before a peer counts as gone
+
+    enum class Role { Host, Client };
+
+    // What a session measured of one peer. Rates are per second of session.
+    struct PeerStats {
+        int slot;
+        double rttMs;    // smoothed, 0 until measured
+        double maxRttMs;
+        double upKbps;   // to the peer, headers included
+        double downKbps;
+        std::uint64_t packetsSent, packetsReceived;
+        bool dropped;
+    };
+
+    LockstepSession() : m_tics(BUFFER_TICKS) {}
+    LockstepSession(const LockstepSession&) = delete;
+    LockstepSession& operator=(const LockstepSession&) = delete;
+
+    // Serves a game of players on port, blocking until every other player
+    // has joined or timeout passes. False, with endReason() saying why,
+    // when the port cannot be bound or the game does not fill in time;
+    // anyone who did join is then told the game is off.
+    bool host(unsigned short port, int players, const DemoHeader& settings, int inputDelay,
+              std::chrono::seconds timeout) {
+        m_role = Role::Host;
+        m_slot = 0;
+        m_players = std::clamp(players, 2, MAX_PLAYERS);
+        m_settings = settings;
+        m_inputDelay = static_cast<std::uint32_t>(std::max(1, inputDelay));
+        if (m_socket.bind(port) != sf::Socket::Status::Done) {
+            m_endReason = "could not bind port " + std::to_string(port);
+            return false;
+        }
+        m_socket.setBlocking(false);
+
+        const Clock::time_point deadline = Clock::now() + timeout;
+        while (static_cast<int>(m_peers.size()) < m_players - 1) {
+            if (Clock::now() >= deadline) {
+                m_endReason = std::to_string(m_peers.size()) + " of " + std::to_string(m_players - 1) +
+                              " player(s) joined in time";
+                leave();
+                return false;
+            }
+            Datagram datagram;
+            if (!receive(datagram)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            if (datagram.type == Type::Hello && !find(datagram.address, datagram.port)) {
+                Peer peer(datagram.address, datagram.port);
+                peer.slot = static_cast<int>(m_peers.size()) + 1;
+                m_peers.push_back(peer);
+            }
+        }
+        start();
+        for (Peer& peer : m_peers) {
+            peer.lastHeard = Clock::now();
+            sendWelcome(peer);
+        }
+        return true;
+    }
+
+    // Joins the game served at "address[:port]", blocking until the host
+    // starts it or timeout passes. False, with endReason() saying why,
+    // when the host cannot be found, does not answer or is full.
+    bool join(const std::string& where, std::chrono::seconds timeout) {
+        m_role = Role::Client;
+        const std::size_t colon = where.rfind(':');
+        int port = DEFAULT_PORT;
+        if (colon != std::string::npos) port = std::atoi(where.c_str() + colon + 1);
+        if (port <= 0 || port > 65535) {
+            m_endReason = "bad port in " + where;
+            return false;
+        }
+        const std::optional<sf::IpAddress> address = sf::IpAddress::resolve(where.substr(0, colon));
+        if (!address) {
+            m_endReason = "could not resolve " + where.substr(0, colon);
+            return false;
+        }
+        if (m_socket.bind(sf::Socket::AnyPort) != sf::Socket::Status::Done) {
+            m_endReason = "could not bind a port";
+            return false;
+        }
+        m_socket.setBlocking(false);
+        m_peers.assign(1, Peer(*address, static_cast<unsigned short>(port)));
+        Peer& host = m_peers.front();
+
+        const Clock::time_point deadline = Clock::now() + timeout;
+        while (Clock::now() < deadline) {
+            if (Clock::now() - host.lastSent >= KEEPALIVE_INTERVAL) sendHeader(host, Type::Hello);
+            Datagram datagram;
+            if (!receive(datagram)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                continue;
+            }
+            if (!(datagram.address == host.address) || datagram.port != host.port) continue;
+            if (datagram.type == Type::Leave) {
+                m_endReason = "the game is full, has started or was called off";
+                return false;
+            }
+            if (datagram.type == Type::Welcome && readWelcome(datagram)) {
+                start();
+                host.lastHeard = Clock::now();
+                host.started = true;
+                return true;
+            }
+        }
+        m_endReason = "no answer from " + where;
+        return false;
+    }
+
+    Role role() const { return m_role; }
+    int slot() const { return m_slot; }
+    int players() const { return m_players; }
+    std::uint32_t inputDelay() const { return m_inputDelay; }
+
+    // The settings the host plays under; a joined client takes them
+    const DemoHeader& settings() const { return m_settings; }
+
+    // Reads every waiting packet and sends what peers are owed; call once
+    // a frame, whatever the game is showing
+    void poll() {
+        Datagram datagram;
+        while (receive(datagram)) handle(datagram);
+
+        const Clock::time_point now = Clock::now();
+        for (Peer& peer : m_peers) {
+            if (peer.dropped) continue;
+            if (now - peer.lastHeard > TIMEOUT) {
+                drop(peer);
+                continue;
+            }
+            if (m_role == Role::Host && !peer.started) {
+                if (now - peer.lastSent >= RESEND_INTERVAL) sendWelcome(peer);
+                continue;
+            }
+            flush(peer);
+        }
+    }
+
+    // True while local input may be sampled for the next tick
+    bool wantsInput() const { return !ended() && m_localTick < m_simTick + m_inputDelay + LEAD_SLACK; }
+
+    // The local player's tic for the next tick it has none for, which plays
+    // inputDelay or more ticks from now
+    void submit(const DemoTic& tic) {
+        m_tics[m_localTick % BUFFER_TICKS][m_slot] = tic;
+        m_localTick++;
+        if (m_role == Role::Host) {
+            m_received[0] = m_localTick;
+            completeFrames();
+        }
+        for (Peer& peer : m_peers) {
+            if (!peer.dropped && peer.started) flush(peer);
+        }
+    }
+
+    // One tic per player for the next tick to simulate, or null, counted
+    // as a stall, while some player's is still on its way
+    const DemoTic* frame() {
+        if (m_simTick == m_complete) {
+            m_stalls++;
+            return nullptr;
+        }
+        return m_tics[m_simTick % BUFFER_TICKS].data();
+    }
+
+    // Moves past the frame just played. True when the world's checksum
+    // after it is due, see check().
+    bool advance() {
+        m_simTick++;
+        return m_simTick % CHECK_INTERVAL == 0;
+    }
+
+    // The world's checksum after the tick just played, for the peers to
+    // compare with theirs
+    void check(std::uint64_t checksum) {
+        m_checks[(m_simTick / CHECK_INTERVAL) % m_checks.size()] = {m_simTick, checksum, true};
+        for (Peer& peer : m_peers) {
+            if (peer.pending.valid && peer.pending.tick == m_simTick) compare(peer, peer.pending);
+            peer.checkSends = CHECK_SENDS;
+        }
+    }
+
+    // Ticks simulated, and ticks the local player has input for; the tics
+    // between are in flight and are what prediction replays
+    std::uint32_t simulated() const { return m_simTick; }
+    std::uint32_t localTick() const { return m_localTick; }
+    const DemoTic& tic(std::uint32_t tick, int slot) const { return m_tics[tick % BUFFER_TICKS][slot]; }
+
+    // Tells every peer the local player is going, so nobody waits out the
+    // timeout. A host leaving ends the game.
+    void leave() {
+        for (Peer& peer : m_peers) {
+            if (peer.dropped) continue;
+            // Three times, as nothing acknowledges it
+            for (int i = 0; i < 3; i++) sendHeader(peer, Type::Leave);
+        }
+        if (m_endReason.empty()) m_endReason = "left the game";
+    }
+
+    // A client's session ends when the host leaves or falls silent; a
+    // host's plays on, dropped players standing idle
+    bool ended() const { return !m_endReason.empty(); }
+    const std::string& endReason() const { return m_endReason; }
+
+    std::size_t stalls() const { return m_stalls; }
+    std::size_t desyncs() const { return m_desyncs; }
+    std::uint32_t firstDesyncTick() const { return m_firstDesync; }
+
+    std::size_t peers() const { return m_peers.size(); }
+    PeerStats peerStats(std::size_t i) const {
+        const Peer& peer = m_peers[i];
+        const double seconds = std::max(1e-3, std::chrono::duration<double>(Clock::now() - m_start).count());
+        return {peer.slot, peer.rttMs, peer.maxRttMs, peer.bytesSent * 8 / seconds / 1000,
+                peer.bytesReceived * 8 / seconds / 1000, peer.packetsSent, peer.packetsReceived, peer.dropped};
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Type : std::uint8_t { Hello = 1, Welcome, Tics, Leave };
+
+    struct Check {
+        std::uint32_t tick = 0;
+        std::uint64_t checksum = 0;
+        bool valid = false;
+    };
+
+    struct Peer {
+        sf::IpAddress address;
+        unsigned short port;
+        int slot = 0;
+        bool started = false;     // has sent tics, so has its welcome
+        bool dropped = false;
+        std::uint32_t acked;      // what it has: frames, when it is a client; our tics, when it is the host
+        std::uint32_t sentUpTo = 0; // the end of what the last packet carried
+        Clock::time_point lastHeard{}, lastSent{};
+        std::uint32_t echo = 0;   // its last stamp, sent back to it
+        Clock::time_point echoHeardAt{};
+        double rttMs = 0.0, maxRttMs = 0.0;
+        std::uint64_t bytesSent = 0, bytesReceived = 0;
+        std::uint64_t packetsSent = 0, packetsReceived = 0;
+        Check pending;            // its checksum for a tick not simulated here yet
+        std::uint32_t compared = 0; // last tick checked against it
+        int checkSends = 0;       // packets our checksum still rides on
+
+        Peer(const sf::IpAddress& from, unsigned short fromPort) : address(from), port(fromPort), acked(0) {}
+    };
+
+    struct Datagram {
+        std::array<std::uint8_t, 1024> bytes;
+        std::size_t size = 0, at = 0;
+        bool valid = true;
+        Type type = Type::Hello;
+        sf::IpAddress address = sf::IpAddress::Any;
+        unsigned short port = 0;
+
+        // Zero past the end, marking the datagram short
+        std::uint64_t get(int count) {
+            if (at + count > size) {
+                valid = false;
+                at = size;
+                return 0;
+            }
+            std::uint64_t value = 0;
+            for (int i = 0; i < count; i++) value |= static_cast<std::uint64_t>(bytes[at++]) << (8 * i);
+            return value;
+        }
+    };
+
+    // The first inputDelay ticks play empty tics everywhere, so the first
+    // real ones have that long to arrive
+    void start() {
+        m_start = Clock::now();
+        m_simTick = 0;
+        m_localTick = m_complete = m_inputDelay;
+        m_received.fill(m_inputDelay);
+        for (std::uint32_t tick = 0; tick < m_inputDelay; tick++) m_tics[tick].fill(DemoTic{});
+        for (Peer& peer : m_peers) peer.acked = m_inputDelay;
+    }
+
+    Peer* find(const sf::IpAddress& address, unsigned short port) {
+        for (Peer& peer : m_peers) {
+            if (peer.address == address && peer.port == port) return &peer;
+        }
+        return nullptr;
+    }
+
+    std::uint32_t millisecondsSinceStart(Clock::time_point when) const {
+        return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(when - m_start).count());
+    }
+
+    // The host has a frame once every player's tic is in; dropped players
+    // play empty ones
+    void completeFrames() {
+        for (;;) {
+            for (const Peer& peer : m_peers) {
+                if (peer.dropped && m_received[peer.slot] <= m_complete) {
+                    m_tics[m_complete % BUFFER_TICKS][peer.slot] = DemoTic{};
+                    m_received[peer.slot] = m_complete + 1;
+                }
+            }
+            for (int slot = 0; slot < m_players; slot++) {
+                if (m_received[slot] <= m_complete) return;
+            }
+            m_complete++;
+        }
+    }
+
+    void drop(Peer& peer) {
+        peer.dropped = true;
+        if (m_role == Role::Client) {
+            if (m_endReason.empty()) m_endReason = "lost the host";
+        } else {
+            completeFrames();
+        }
+    }
+
+    // A check from peer for a tick this side has simulated
+    void compare(Peer& peer, const Check& theirs) {
+        peer.pending.valid = false;
+        const Check& ours = m_checks[(theirs.tick / CHECK_INTERVAL) % m_checks.size()];
+        if (!ours.valid || ours.tick != theirs.tick || theirs.tick <= peer.compared) return;
+        peer.compared = theirs.tick;
+        if (ours.checksum != theirs.checksum) {
+            if (m_desyncs == 0) m_firstDesync = theirs.tick;
+            m_desyncs++;
+        }
+    }
+
+    bool receive(Datagram& datagram) {
+        std::optional<sf::IpAddress> address;
+        datagram.size = datagram.at = 0;
+        datagram.valid = true;
+        if (m_socket.receive(datagram.bytes.data(), datagram.bytes.size(), datagram.size, address, datagram.port) !=
+                sf::Socket::Status::Done ||
+            !address) {
+            return false;
+        }
+        datagram.address = *address;
+        if (Peer* peer = find(datagram.address, datagram.port)) {
+            peer->bytesReceived += datagram.size + UDP_OVERHEAD;
+            peer->packetsReceived++;
+        }
+        // Anything else is dropped unread, as a datagram of no type
+        if (datagram.get(1) != 'D' || datagram.get(1) != 'N' || datagram.get(1) != PROTOCOL) {
+            datagram.type = Type{};
+            return true;
+        }
+        datagram.type = static_cast<Type>(datagram.get(1));
+        return true;
+    }
+
+    void handle(Datagram& datagram) {
+        Peer* peer = find(datagram.address, datagram.port);
+        if (!peer) {
+            // Too late to join; a client ignores strangers
+            if (m_role == Role::Host && datagram.type == Type::Hello) {
+                Peer stranger(datagram.address, datagram.port);
+                sendHeader(stranger, Type::Leave);
+            }
+            return;
+        }
+        if (peer->dropped || datagram.type == Type{}) return;
+        peer->lastHeard = Clock::now();
+
+        switch (datagram.type) {
+            case Type::Hello:
+                // Its welcome was lost
+                if (m_role == Role::Host) sendWelcome(*peer);
+                break;
+            case Type::Leave:
+                if (m_role == Role::Client) m_endReason = "the host left";
+                drop(*peer);
+                break;
+            case Type::Tics:
+                readTics(*peer, datagram);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void readTics(Peer& peer, Datagram& datagram) {
+        const std::uint32_t stamp = static_cast<std::uint32_t>(datagram.get(4));
+        const std::uint32_t echo = static_cast<std::uint32_t>(datagram.get(4));
+        const std::uint32_t held = static_cast<std::uint32_t>(datagram.get(2));
+        const std::uint32_t ack = static_cast<std::uint32_t>(datagram.get(4));
+        const std::uint32_t first = static_cast<std::uint32_t>(datagram.get(4));
+        const std::uint32_t count = static_cast<std::uint32_t>(datagram.get(1));
+        Check check;
+        check.valid = datagram.get(1) != 0;
+        if (check.valid) {
+            check.tick = static_cast<std::uint32_t>(datagram.get(4));
+            check.checksum = datagram.get(8);
+        }
+        const int perTick = m_role == Role::Host ? 1 : m_players;
+        if (!datagram.valid || datagram.size - datagram.at < static_cast<std::size_t>(count) * perTick * 3) return;
+
+        const Clock::time_point now = Clock::now();
+        peer.started = true;
+        peer.echo = stamp;
+        peer.echoHeardAt = now;
+        if (echo != 0) {
+            // Stamps are a millisecond late, so none is 0
+            const double rtt = static_cast<double>(millisecondsSinceStart(now)) + 1 - echo - held;
+            if (rtt >= 0) {
+                peer.rttMs = peer.rttMs == 0.0 ? rtt : peer.rttMs + (rtt - peer.rttMs) / 8;
+                peer.maxRttMs = std::max(peer.maxRttMs, rtt);
+            }
+        }
+        peer.acked = std::max(peer.acked, ack);
+
+        // Runs start at or before what is missing; only the rest is new
+        for (std::uint32_t tick = first; tick < first + count; tick++) {
+            DemoTic tics[MAX_PLAYERS];
+            for (int i = 0; i < perTick; i++) {
+                tics[i].buttons = static_cast<std::uint8_t>(datagram.get(1));
+                tics[i].mouseDeltaX = static_cast<std::int16_t>(static_cast<std::uint16_t>(datagram.get(2)));
+            }
+            if (m_role == Role::Host) {
+                std::uint32_t& next = m_received[peer.slot];
+                if (tick != next || tick >= m_simTick + BUFFER_TICKS / 2) continue;
+                m_tics[tick % BUFFER_TICKS][peer.slot] = tics[0];
+                next++;
+            } else {
+                if (tick != m_complete || tick >= m_simTick + BUFFER_TICKS / 2) continue;
+                std::copy(tics, tics + m_players, m_tics[tick % BUFFER_TICKS].begin());
+                m_complete++;
+            }
+        }
+        if (m_role == Role::Host) completeFrames();
+
+        if (check.valid) {
+            if (check.tick <= m_simTick) {
+                compare(peer, check);
+            } else {
+                peer.pending = check;
+            }
+        }
+    }
+
+    bool readWelcome(Datagram& datagram) {
+        const int slot = static_cast<int>(datagram.get(1));
+        const int players = static_cast<int>(datagram.get(1));
+        const std::uint32_t delay = static_cast<std::uint32_t>(datagram.get(1));
+        DemoHeader settings;
+        settings.tickRate = static_cast<std::uint16_t>(datagram.get(2));
+        settings.seed = datagram.get(8);
+        settings.mapWidth = static_cast<std::int32_t>(datagram.get(4));
+        settings.mapHeight = static_cast<std::int32_t>(datagram.get(4));
+        settings.enemyCount = static_cast<std::int32_t>(datagram.get(4));
+        const std::uint64_t flags = datagram.get(1);
+        settings.infinite = (flags & 1) != 0;
+        settings.morton = (flags & 2) != 0;
+        if (!datagram.valid || players < 2 || players > MAX_PLAYERS || slot < 1 || slot >= players || delay == 0 ||
+            delay >= BUFFER_TICKS / 4) {
+            return false;
+        }
+        m_slot = slot;
+        m_players = players;
+        m_inputDelay = delay;
+        m_settings = settings;
+        return true;
+    }
+
+    void beginPacket(Type type) {
+        m_packet.clear();
+        m_packet.push_back('D');
+        m_packet.push_back('N');
+        m_packet.push_back(PROTOCOL);
+        m_packet.push_back(static_cast<std::uint8_t>(type));
+    }
+
+    void put(std::uint64_t value, int size) {
+        for (int i = 0; i < size; i++) m_packet.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    void send(Peer& peer) {
+        if (m_socket.send(m_packet.data(), m_packet.size(), peer.address, peer.port) != sf::Socket::Status::Done) {
+            return;
+        }
+        peer.lastSent = Clock::now();
+        peer.bytesSent += m_packet.size() + UDP_OVERHEAD;
+        peer.packetsSent++;
+    }
+
+    void sendHeader(Peer& peer, Type type) {
+        beginPacket(type);
+        send(peer);
+    }
+
+    void sendWelcome(Peer& peer) {
+        beginPacket(Type::Welcome);
+        put(static_cast<std::uint64_t>(peer.slot), 1);
+        put(static_cast<std::uint64_t>(m_players), 1);
+        put(m_inputDelay, 1);
+        put(m_settings.tickRate, 2);
+        put(m_settings.seed, 8);
+        put(static_cast<std::uint32_t>(m_settings.mapWidth), 4);
+        put(static_cast<std::uint32_t>(m_settings.mapHeight), 4);
+        put(static_cast<std::uint32_t>(m_settings.enemyCount), 4);
+        put((m_settings.infinite ? 1u : 0u) | (m_settings.morton ? 2u : 0u), 1);
+        send(peer);
+    }
+
+    // Sends peer what it lacks when there is news, again when it is
+    // still behind after RESEND_INTERVAL, and a keepalive otherwise
+    void flush(Peer& peer) {
+        // A client owes the host its tics, the host owes clients frames
+        const std::uint32_t end = m_role == Role::Host ? m_complete : m_localTick;
+        const Clock::time_point now = Clock::now();
+        const bool news = end > peer.sentUpTo || peer.checkSends > 0;
+        const bool behind = peer.acked < end && now - peer.lastSent >= RESEND_INTERVAL;
+        if (!news && !behind && now - peer.lastSent < KEEPALIVE_INTERVAL) return;
+
+        // A peer too far behind for the buffer cannot be caught up
+        if (peer.acked + BUFFER_TICKS / 2 < end) {
+            drop(peer);
+            return;
+        }
+        const std::uint32_t first = std::min(peer.acked, end);
+        const std::uint32_t count = std::min(end - first, MAX_TICKS_PER_PACKET);
+
+        beginPacket(Type::Tics);
+        put(millisecondsSinceStart(now) + 1, 4); // never 0, which means no echo
+        put(peer.echo, 4);
+        put(peer.echo ? std::min<std::int64_t>(65535, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                          now - peer.echoHeardAt).count())
+                      : 0,
+            2);
+        put(m_role == Role::Host ? m_received[peer.slot] : m_complete, 4);
+        put(first, 4);
+        put(count, 1);
+        const Check& check = m_checks[(m_simTick / CHECK_INTERVAL) % m_checks.size()];
+        const bool withCheck = peer.checkSends > 0 && check.valid;
+        put(withCheck ? 1 : 0, 1);
+        if (withCheck) {
+            put(check.tick, 4);
+            put(check.checksum, 8);
+            peer.checkSends--;
+        }
+        for (std::uint32_t tick = first; tick < first + count; tick++) {
+            const auto& tics = m_tics[tick % BUFFER_TICKS];
+            const int begin = m_role == Role::Host ? 0 : m_slot;
+            const int stop = m_role == Role::Host ? m_players : m_slot + 1;
+            for (int slot = begin; slot < stop; slot++) {
+                put(tics[slot].buttons, 1);
+                put(static_cast<std::uint16_t>(tics[slot].mouseDeltaX), 2);
+            }
+        }
+        peer.sentUpTo = std::max(peer.sentUpTo, first + count);
+        send(peer);
+    }
+
+    Role m_role = Role::Host;
+    sf::UdpSocket m_socket;
+    std::vector<Peer> m_peers; // clients, in slot order, for the host; the host, for a client
+    int m_slot = 0;
+    int m_players = 1;
+    std::uint32_t m_inputDelay = 1;
+    DemoHeader m_settings;
+    Clock::time_point m_start{};
+
+    std::vector<std::array<DemoTic, MAX_PLAYERS>> m_tics; // by tick modulo BUFFER_TICKS, then slot
+    std::array<std::uint32_t, MAX_PLAYERS> m_received{}; // the host's next missing tick by slot
+    std::uint32_t m_complete = 0;  // ticks with every player's tic
+    std::uint32_t m_simTick = 0;
+    std::uint32_t m_localTick = 0;
+    std::array<Check, 8> m_checks{};  // the latest, by tick / CHECK_INTERVAL
+    std::vector<std::uint8_t> m_packet;
+
+    std::string m_endReason;
+    std::size_t m_stalls = 0;
+    std::size_t m_desyncs = 0;
+    std::uint32_t m_firstDesync = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include "entity_store.hpp"
+#include "sprite_atlas.hpp"
+
+// ===========================================
+// PARTICLE POOL
+// Fixed-capacity, preallocated particle storage with flipbook animation.
+// Spawns past capacity are dropped and counted, and a kill swaps the last
+// live particle into the hole, so live particles are always the dense
+// prefix [0, count()) and no frame allocates.
+// ===========================================
+
+// Flipbook over frames of the sprite atlas. Frames are asked for up front,
+// all in one scale group, and checked with complete() once the atlas is
+// built.
+struct SpriteAnimation {
+    const SpriteAtlas* atlas = nullptr;
+    std::vector<int> frames; // atlas frame ids
+    float frameRate = 10.0f;
+    bool looping = false;
+
+    // Every image in a .cells directory, in file name order (000.PNG, ...)
+    bool requestCells(SpriteAtlas& sprites, int group, const std::filesystem::path& directory) {
+        std::vector<std::filesystem::path> cells;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.is_regular_file()) cells.push_back(entry.path());
+        }
+        std::sort(cells.begin(), cells.end());
+        return requestFrames(sprites, group, cells);
+    }
+
+    bool requestFrames(SpriteAtlas& sprites, int group, const std::vector<std::filesystem::path>& framePaths) {
+        atlas = &sprites;
+        frames.clear();
+        for (const auto& path : framePaths) frames.push_back(sprites.add(group, path));
+        return !frames.empty();
+    }
+
+    // Areas of one sheet, in order
+    bool requestAreas(SpriteAtlas& sprites, int group, const std::filesystem::path& path,
+                      const std::vector<sf::IntRect>& areas) {
+        atlas = &sprites;
+        frames.clear();
+        for (const sf::IntRect& area : areas) frames.push_back(sprites.add(group, path, area));
+        return !frames.empty();
+    }
+
+    // After the atlas is built: a flipbook missing any frame is dropped entirely
+    bool complete() {
+        for (int frame : frames) {
+            if (!atlas->frame(frame).page) {
+                frames.clear();
+                break;
+            }
+        }
+        return !frames.empty();
+    }
+
+    float duration() const { return frames.size() / frameRate; }
+
+    // Frame shown age seconds after the effect started, or nullptr
+    const AtlasFrame* frameAt(float age) const {
+        if (frames.empty()) return nullptr;
+        auto frame = static_cast<std::size_t>(std::max(age, 0.0f) * frameRate);
+        frame = looping ? frame % frames.size() : std::min(frame, frames.size() - 1);
+        return &atlas->frame(frames[frame]);
+    }
+};
+
+// One column per field. z is height in tiles above the floor, and
+// prevX / prevY / prevZ hold the position at the start of the current
+// simulation tick, for drawing between ticks.
+struct ParticlePool {
+    std::vector<double> x, y, z;
+    std::vector<double> prevX, prevY, prevZ;
+    std::vector<double> velX, velY, velZ;
+    std::vector<double> gravity;      // vertical acceleration, tiles/s^2
+    std::vector<float> timeLeft;
+    std::vector<float> lifetime;
+    std::vector<float> size;          // billboard side in tiles
+    std::vector<const SpriteAnimation*> animation;
+    PoolPressure pressure;
+
+    explicit ParticlePool(std::size_t capacity) {
+        pressure.capacity = capacity;
+        reserveColumns(capacity, x, y, z, prevX, prevY, prevZ, velX, velY, velZ,
+                       gravity, timeLeft, lifetime, size, animation);
+    }
+
+    std::size_t count() const { return x.size(); }
+
+    // A lifetime of 0 runs the animation once
+    bool spawn(const SpriteAnimation* anim, double px, double py, double pz,
+               double vx, double vy, double vz, double g, float side, float life = 0.0f) {
+        if (!pressure.admit(count())) return false;
+        if (life <= 0.0f) life = anim ? anim->duration() : 0.0f;
+        x.push_back(px); y.push_back(py); z.push_back(pz);
+        prevX.push_back(px); prevY.push_back(py); prevZ.push_back(pz);
+        velX.push_back(vx); velY.push_back(vy); velZ.push_back(vz);
+        gravity.push_back(g);
+        timeLeft.push_back(life);
+        lifetime.push_back(life);
+        size.push_back(side);
+        animation.push_back(anim);
+        return true;
+    }
+
+    void kill(std::size_t i) {
+        swapRemove(i, x, y, z, prevX, prevY, prevZ, velX, velY, velZ,
+                   gravity, timeLeft, lifetime, size, animation);
+    }
+
+    void clear() {
+        clearColumns(x, y, z, prevX, prevY, prevZ, velX, velY, velZ,
+                     gravity, timeLeft, lifetime, size, animation);
+    }
+
+    // Called at the start of each tick
+    void snapshot() {
+        prevX = x;
+        prevY = y;
+        prevZ = z;
+    }
+
+    void update(float dt) {
+        const std::size_t n = count();
+        integrate(velZ.data(), gravity.data(), n, dt);
+        integrate(x.data(), velX.data(), n, dt);
+        integrate(y.data(), velY.data(), n, dt);
+        integrate(z.data(), velZ.data(), n, dt);
+        clampBelow(z.data(), n, 0.0);
+        tickTimers(timeLeft.data(), n, dt);
+
+        // Backwards, so the row swapped into i has already been checked
+        for (std::size_t i = n; i-- > 0;) {
+            if (timeLeft[i] <= 0.0f) kill(i);
+        }
+    }
+
+    const AtlasFrame* frame(std::size_t i) const {
+        return animation[i] ? animation[i]->frameAt(lifetime[i] - timeLeft[i]) : nullptr;
+    }
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+// ===========================================
+// FRAME PROFILER
+// Scoped timers for the stages of a frame. The main thread adds each
+// stage's time into the current frame's sample. At the end of a frame the
+// sample goes into a recent-history window, which feeds the overlay, and
+// into a lock-free single-producer ring. While a capture is running, a
+// writer thread drains that ring to CSV or Chrome trace JSON, so disk I/O
+// never runs on the frame.
+//
+// Build with ENGINE_PROFILER=0 and every class below becomes empty and
+// inline, so the instrumented code compiles to nothing.
+// ===========================================
+
+#ifndef ENGINE_PROFILER
+#define ENGINE_PROFILER 1
+#endif
+
+enum class ProfileStage {
+    Input,       // events and mouse warping
+    Player,      // movement and pickups
+    Stream,      // world streaming and recentring
+    Enemies,
+    Projectiles,
+    Particles,
+    Walls,       // raycast and wall draw
+    Sprites,     // billboards and sprite draw
+    Hud,
+    Display,     // window.display(), including any vsync wait
+    Count
+};
+
+constexpr int PROFILE_STAGE_COUNT = static_cast<int>(ProfileStage::Count);
+
+inline const char* profileStageName(ProfileStage stage) {
+    static const char* const names[PROFILE_STAGE_COUNT] = {
+        "Input", "Player", "Stream", "Enemies", "Projectiles",
+        "Particles", "Walls", "Sprites", "Hud", "Display"
+    };
+    return names[static_cast<int>(stage)];
+}
+
+enum class ProfileFormat { Csv, ChromeTrace };
+
+// One frame; times are nanoseconds, starts relative to the frame start
+struct FrameSample {
+    std::uint64_t frame = 0;
+    std::int64_t startNs = 0;                            // since the profiler started
+    std::int64_t frameNs = 0;
+    std::array<std::int64_t, PROFILE_STAGE_COUNT> stageNs{};
+    std::array<std::int64_t, PROFILE_STAGE_COUNT> stageStartNs{}; // first entry, -1 if never entered
+};
+
+// Averages over the recent history, in microseconds
+struct ProfileSummary {
+    std::size_t frames = 0;
+    double frameAverageUs = 0;
+    double frameP50Us = 0;
+    double frameP99Us = 0;
+    std::array<double, PROFILE_STAGE_COUNT> stageAverageUs{};
+};
+
+// Fixed-capacity queue for exactly one producer thread and one consumer
+// thread; push fails instead of blocking when the ring is full
+template <typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    bool push(const T& value) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) return false;
+        m_items[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& value) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return false;
+        value = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+    std::array<T, Capacity> m_items{};
+};
+
+#if ENGINE_PROFILER
+
+class FrameProfiler {
+public:
+    static constexpr std::size_t HISTORY = 240;
+
+    static FrameProfiler& instance() {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+
+    ~FrameProfiler() { stopCapture(); }
+
+    static std::int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void beginFrame() {
+        m_frameStart = now();
+        m_current = FrameSample{};
+        m_current.frame = m_frameCount;
+        m_current.startNs = m_frameStart - m_epoch;
+        m_current.stageStartNs.fill(-1);
+    }
+
+    // Stages entered several times in a frame (one per simulation step)
+    // add up; their start is the first entry
+    void record(ProfileStage stage, std::int64_t start, std::int64_t end) {
+        const int i = static_cast<int>(stage);
+        m_current.stageNs[i] += end - start;
+        if (m_current.stageStartNs[i] < 0) m_current.stageStartNs[i] = start - m_frameStart;
+    }
+
+    void endFrame() {
+        m_current.frameNs = now() - m_frameStart;
+        m_history[m_frameCount % HISTORY] = m_current;
+        m_frameCount++;
+        if (m_capturing && !m_ring.push(m_current)) m_dropped++;
+    }
+
+    // Streams every following frame to path until stopCapture
+    bool startCapture(const std::filesystem::path& path, ProfileFormat format) {
+        stopCapture();
+        m_out.open(path);
+        if (!m_out) return false;
+        m_out << std::fixed << std::setprecision(3);
+        m_format = format;
+        if (format == ProfileFormat::Csv) {
+            m_out << "frame,start_ms,frame_us";
+            for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+                m_out << "," << profileStageName(static_cast<ProfileStage>(i)) << "_us";
+            }
+            m_out << "\n";
+        } else {
+            m_out << "{\"traceEvents\":[\n";
+        }
+        m_firstEvent = true;
+        m_stopWriter.store(false);
+        m_capturing = true;
+        m_writer = std::thread([this] { writerLoop(); });
+        return true;
+    }
+
+    void stopCapture() {
+        if (!m_capturing) return;
+        m_capturing = false;
+        m_stopWriter.store(true);
+        m_writer.join();
+        if (m_format == ProfileFormat::ChromeTrace) m_out << "\n]}\n";
+        m_out.close();
+    }
+
+    bool capturing() const { return m_capturing; }
+
+    // Frames the writer fell too far behind to take
+    std::size_t droppedSamples() const { return m_dropped; }
+
+    ProfileSummary summary() const {
+        ProfileSummary result;
+        result.frames = static_cast<std::size_t>(std::min<std::uint64_t>(m_frameCount, HISTORY));
+        if (result.frames == 0) return result;
+
+        std::array<double, HISTORY> frameUs;
+        double total = 0;
+        for (std::size_t i = 0; i < result.frames; i++) {
+            const FrameSample& sample = m_history[i];
+            frameUs[i] = sample.frameNs / 1000.0;
+            total += frameUs[i];
+            for (int s = 0; s < PROFILE_STAGE_COUNT; s++) result.stageAverageUs[s] += sample.stageNs[s] / 1000.0;
+        }
+        for (double& stage : result.stageAverageUs) stage /= result.frames;
+        result.frameAverageUs = total / result.frames;
+
+        auto percentile = [&](double fraction) {
+            auto nth = frameUs.begin() + static_cast<std::ptrdiff_t>(fraction * (result.frames - 1));
+            std::nth_element(frameUs.begin(), nth, frameUs.begin() + result.frames);
+            return *nth;
+        };
+        result.frameP50Us = percentile(0.50);
+        result.frameP99Us = percentile(0.99);
+        return result;
+    }
+
+private:
+    FrameProfiler() : m_epoch(now()) {}
+
+    void writerLoop() {
+        FrameSample sample;
+        while (true) {
+            const bool stopping = m_stopWriter.load();
+            while (m_ring.pop(sample)) write(sample);
+            if (stopping) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    void write(const FrameSample& sample) {
+        if (m_format == ProfileFormat::Csv) {
+            m_out << sample.frame << "," << sample.startNs / 1e6 << "," << sample.frameNs / 1000;
+            for (std::int64_t ns : sample.stageNs) m_out << "," << ns / 1000;
+            m_out << "\n";
+            return;
+        }
+        // Complete events in microseconds: the frame, then each stage entered
+        writeEvent("Frame", sample.startNs, sample.frameNs);
+        for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+            if (sample.stageStartNs[i] < 0) continue;
+            writeEvent(profileStageName(static_cast<ProfileStage>(i)),
+                       sample.startNs + sample.stageStartNs[i], sample.stageNs[i]);
+        }
+    }
+
+    void writeEvent(const char* name, std::int64_t startNs, std::int64_t durationNs) {
+        m_out << (m_firstEvent ? "" : ",\n") << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+              << startNs / 1000.0 << ",\"dur\":" << durationNs / 1000.0 << "}";
+        m_firstEvent = false;
+    }
+
+    std::int64_t m_epoch;
+    std::int64_t m_frameStart = 0;
+    std::uint64_t m_frameCount = 0;
+    FrameSample m_current;
+    std::array<FrameSample, HISTORY> m_history{};
+
+    SpscRing<FrameSample, 1024> m_ring;
+    std::atomic<bool> m_stopWriter{false};
+    bool m_capturing = false;
+    std::size_t m_dropped = 0;
+    std::thread m_writer;
+    std::ofstream m_out;       // writer thread only while capturing
+    ProfileFormat m_format = ProfileFormat::Csv;
+    bool m_firstEvent = true;
+};
+
+// Times from construction to stop() or destruction into one stage
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : m_stage(stage), m_start(FrameProfiler::now()) {}
+    ~ProfileScope() { stop(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    void stop() {
+        if (m_stopped) return;
+        FrameProfiler::instance().record(m_stage, m_start, FrameProfiler::now());
+        m_stopped = true;
+    }
+
+private:
+    ProfileStage m_stage;
+    std::int64_t m_start;
+    bool m_stopped = false;
+};
+
+#else
+
+// Profiling compiled out: same interface, no work
+class FrameProfiler {
+public:
+    static FrameProfiler& instance() {
+        static FrameProfiler profiler;
+        return profiler;
+    }
+    void beginFrame() {}
+    void endFrame() {}
+    bool startCapture(const std::filesystem::path&, ProfileFormat) { return false; }
+    void stopCapture() {}
+    bool capturing() const { return false; }
+    std::size_t droppedSamples() const { return 0; }
+    ProfileSummary summary() const { return {}; }
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage) {}
+    void stop() {}
+};
+
+#endif
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define RAY_PACKET_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define RAY_PACKET_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(RAY_PACKET_X86) && (defined(__GNUC__) || defined(__clang__))
+#define RAY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define RAY_TARGET_AVX2
+#endif
+
+// ===========================================
+// PACKET RAY TRAVERSAL
+// Traces 4 adjacent screen columns at once: the DDA side distances step as
+// one SIMD packet with per-lane masks, lanes drop out as they hit, and the
+// packet exits when every lane has hit. All math stays in double precision
+// and uses exactly the scalar operations, so hits match the scalar DDA bit
+// for bit.
+// ===========================================
+
+// Camera state the raycaster needs from the player
+struct RayCamera {
+    double posX, posY;
+    double dirX, dirY;
+    double planeX, planeY;
+};
+
+// Row-major wall mask, nonzero = solid, with rows stride bytes apart.
+// Anything outside the grid counts as solid. The AVX2 kernel gathers 32 bits
+// per lookup, so solid must stay readable for RAY_GRID_PADDING bytes past
+// the last cell.
+constexpr std::size_t RAY_GRID_PADDING = 3;
+
+struct RayGrid {
+    const std::uint8_t* solid;
+    int width;
+    int height;
+    int stride;
+
+    bool blocks(int x, int y) const {
+        return x < 0 || x >= width || y < 0 || y >= height ||
+               solid[static_cast<std::ptrdiff_t>(y) * stride + x] != 0;
+    }
+};
+
+// Result of one DDA ray
+struct RayHit {
+    double perpWallDist;
+    int side;
+    double wallX; // where along the wall face, 0 to 1, texture left to right
+};
+
+enum class RayIsa { Scalar, SSE2, AVX2, NEON };
+
+constexpr int RAY_PACKET_WIDTH = 4;
+
+inline const char* rayIsaName(RayIsa isa) {
+    switch (isa) {
+        case RayIsa::Scalar: return "scalar";
+        case RayIsa::SSE2: return "sse2";
+        case RayIsa::AVX2: return "avx2";
+        case RayIsa::NEON: return "neon";
+    }
+    return "?";
+}
+
+// Direction of the ray through screen column x. Shared by every path so all
+// of them start from identical inputs.
+inline void rayDirection(const RayCamera& cam, unsigned int screenWidth, int x,
+                         double& rayDirX, double& rayDirY) {
+    double cameraX = 2 * x / static_cast<double>(screenWidth) - 1;
+    rayDirX = cam.dirX + cam.planeX * cameraX;
+    rayDirY = cam.dirY + cam.planeY * cameraX;
+}
+
+// Distance and texture coordinate once the DDA has stopped on a wall cell
+inline RayHit finishRay(const RayCamera& cam, int mapX, int mapY, int stepX, int stepY,
+                        int side, double rayDirX, double rayDirY) {
+    double perpWallDist;
+    if (side == 0) {
+        perpWallDist = (mapX - cam.posX + (1 - stepX) / 2) / rayDirX;
+    } else {
+        perpWallDist = (mapY - cam.posY + (1 - stepY) / 2) / rayDirY;
+    }
+
+    // Hit point along the face, mirrored on the faces seen from their far
+    // side so every wall reads left to right from the front
+    double wallX = side == 0 ? cam.posY + perpWallDist * rayDirY : cam.posX + perpWallDist * rayDirX;
+    wallX -= std::floor(wallX);
+    if ((side == 0 && rayDirX > 0) || (side == 1 && rayDirY < 0)) wallX = 1 - wallX;
+
+    if (perpWallDist < 0.1) perpWallDist = 0.1;
+
+    return {perpWallDist, side, wallX};
+}
+
+// Per-lane state shared by the vector kernels: ray directions and integer
+// steps on the way in, final cell and side on the way out
+struct RayPacketLanes {
+    alignas(32) double rayDirX[RAY_PACKET_WIDTH];
+    alignas(32) double rayDirY[RAY_PACKET_WIDTH];
+    alignas(32) double mapX[RAY_PACKET_WIDTH];
+    alignas(32) double mapY[RAY_PACKET_WIDTH];
+    alignas(32) double side[RAY_PACKET_WIDTH];
+    int stepX[RAY_PACKET_WIDTH];
+    int stepY[RAY_PACKET_WIDTH];
+
+    void init(const RayCamera& cam, unsigned int screenWidth, int x0) {
+        for (int i = 0; i < RAY_PACKET_WIDTH; i++) {
+            rayDirection(cam, screenWidth, x0 + i, rayDirX[i], rayDirY[i]);
+            stepX[i] = rayDirX[i] < 0 ? -1 : 1;
+            stepY[i] = rayDirY[i] < 0 ? -1 : 1;
+        }
+    }
+
+    // Map cells are whole numbers carried in doubles, so the casts are exact
+    void finish(const RayCamera& cam, RayHit* out) const {
+        for (int i = 0; i < RAY_PACKET_WIDTH; i++) {
+            out[i] = finishRay(cam, static_cast<int>(mapX[i]), static_cast<int>(mapY[i]),
+                               stepX[i], stepY[i], static_cast<int>(side[i]), rayDirX[i], rayDirY[i]);
+        }
+    }
+};
+
+// Lanes whose cell (already known to be inside the grid when the bit is set
+// in inside) is solid, plus every lane outside it. Used by the kernels that
+// have no gather instruction.
+inline int solidLanes(const RayGrid& grid, const double* mapX, const double* mapY, int inside) {
+    int solid = 0;
+    for (int i = 0; i < RAY_PACKET_WIDTH; i++) {
+        std::size_t cell = static_cast<std::size_t>(mapY[i]) * grid.stride + static_cast<std::size_t>(mapX[i]);
+        bool blocked = !((inside >> i) & 1) || grid.solid[(inside >> i) & 1 ? cell : 0] != 0;
+        solid |= static_cast<int>(blocked) << i;
+    }
+    return solid;
+}
+
+// Reference DDA for a single column
+inline RayHit castRayScalar(const RayCamera& cam, const RayGrid& grid, unsigned int screenWidth, int x) {
+    double rayDirX, rayDirY;
+    rayDirection(cam, screenWidth, x, rayDirX, rayDirY);
+
+    int mapX = static_cast<int>(cam.posX);
+    int mapY = static_cast<int>(cam.posY);
+
+    double deltaDistX = (rayDirX == 0) ? 1e30 : std::abs(1 / rayDirX);
+    double deltaDistY = (rayDirY == 0) ? 1e30 : std::abs(1 / rayDirY);
+
+    int stepX = rayDirX < 0 ? -1 : 1;
+    int stepY = rayDirY < 0 ? -1 : 1;
+    double sideDistX = rayDirX < 0 ? (cam.posX - mapX) * deltaDistX : (mapX + 1.0 - cam.posX) * deltaDistX;
+    double sideDistY = rayDirY < 0 ? (cam.posY - mapY) * deltaDistY : (mapY + 1.0 - cam.posY) * deltaDistY;
+
+    int side = 0;
+    do {
+        if (sideDistX < sideDistY) {
+            sideDistX += deltaDistX;
+            mapX += stepX;
+            side = 0;
+        } else {
+            sideDistY += deltaDistY;
+            mapY += stepY;
+            side = 1;
+        }
+    } while (!grid.blocks(mapX, mapY));
+
+    return finishRay(cam, mapX, mapY, stepX, stepY, side, rayDirX, rayDirY);
+}
+
+#ifdef RAY_PACKET_X86
+
+// SSE2 holds 2 doubles per register, so the 4-lane packet is a lo/hi pair.
+// Stepping and bounds tests are vector ops; the cell lookups are scalar.
+inline void castRayPacketSSE2(const RayCamera& cam, const RayGrid& grid, unsigned int screenWidth,
+                              int x0, RayHit* out) {
+    RayPacketLanes lanes;
+    lanes.init(cam, screenWidth, x0);
+
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d huge = _mm_set1_pd(1e30);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    const __m128d width = _mm_set1_pd(grid.width);
+    const __m128d height = _mm_set1_pd(grid.height);
+    const __m128d posX = _mm_set1_pd(cam.posX);
+    const __m128d posY = _mm_set1_pd(cam.posY);
+    const __m128d startX = _mm_set1_pd(static_cast<double>(static_cast<int>(cam.posX)));
+    const __m128d startY = _mm_set1_pd(static_cast<double>(static_cast<int>(cam.posY)));
+
+    auto select = [](__m128d mask, __m128d ifSet, __m128d ifClear) {
+        return _mm_or_pd(_mm_and_pd(mask, ifSet), _mm_andnot_pd(mask, ifClear));
+    };
+    auto laneMask = [](int bits) {
+        return _mm_castsi128_pd(_mm_set_epi64x(-static_cast<long long>((bits >> 1) & 1),
+                                               -static_cast<long long>(bits & 1)));
+    };
+
+    __m128d deltaX[2], deltaY[2], sideX[2], sideY[2], stepX[2], stepY[2], mapX[2], mapY[2], side[2];
+    for (int h = 0; h < 2; h++) {
+        __m128d dirX = _mm_load_pd(lanes.rayDirX + 2 * h);
+        __m128d dirY = _mm_load_pd(lanes.rayDirY + 2 * h);
+        __m128d negX = _mm_cmplt_pd(dirX, zero);
+        __m128d negY = _mm_cmplt_pd(dirY, zero);
+        deltaX[h] = select(_mm_cmpeq_pd(dirX, zero), huge, _mm_andnot_pd(signMask, _mm_div_pd(one, dirX)));
+        deltaY[h] = select(_mm_cmpeq_pd(dirY, zero), huge, _mm_andnot_pd(signMask, _mm_div_pd(one, dirY)));
+        sideX[h] = select(negX, _mm_mul_pd(_mm_sub_pd(posX, startX), deltaX[h]),
+                          _mm_mul_pd(_mm_sub_pd(_mm_add_pd(startX, one), posX), deltaX[h]));
+        sideY[h] = select(negY, _mm_mul_pd(_mm_sub_pd(posY, startY), deltaY[h]),
+                          _mm_mul_pd(_mm_sub_pd(_mm_add_pd(startY, one), posY), deltaY[h]));
+        stepX[h] = _mm_or_pd(one, _mm_and_pd(negX, signMask));
+        stepY[h] = _mm_or_pd(one, _mm_and_pd(negY, signMask));
+        mapX[h] = startX;
+        mapY[h] = startY;
+        side[h] = zero;
+    }
+
+    int active = 0xF;
+    while (active) {
+        int inside = 0;
+        for (int h = 0; h < 2; h++) {
+            __m128d live = laneMask(active >> (2 * h));
+            __m128d lt = _mm_cmplt_pd(sideX[h], sideY[h]);
+            __m128d takeX = _mm_and_pd(lt, live);
+            __m128d takeY = _mm_andnot_pd(lt, live);
+            sideX[h] = select(takeX, _mm_add_pd(sideX[h], deltaX[h]), sideX[h]);
+            sideY[h] = select(takeY, _mm_add_pd(sideY[h], deltaY[h]), sideY[h]);
+            mapX[h] = select(takeX, _mm_add_pd(mapX[h], stepX[h]), mapX[h]);
+            mapY[h] = select(takeY, _mm_add_pd(mapY[h], stepY[h]), mapY[h]);
+            side[h] = select(takeX, zero, select(takeY, one, side[h]));
+
+            __m128d in = _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(mapX[h], zero), _mm_cmplt_pd(mapX[h], width)),
+                                    _mm_and_pd(_mm_cmpge_pd(mapY[h], zero), _mm_cmplt_pd(mapY[h], height)));
+            inside |= _mm_movemask_pd(in) << (2 * h);
+            _mm_store_pd(lanes.mapX + 2 * h, mapX[h]);
+            _mm_store_pd(lanes.mapY + 2 * h, mapY[h]);
+        }
+        active &= ~solidLanes(grid, lanes.mapX, lanes.mapY, inside);
+    }
+
+    for (int h = 0; h < 2; h++) _mm_store_pd(lanes.side + 2 * h, side[h]);
+    lanes.finish(cam, out);
+}
+
+// One 4-wide register per quantity; cell lookups are a masked gather, so the
+// whole step, including the hit test, runs without per-lane branches.
+RAY_TARGET_AVX2
+inline void castRayPacketAVX2(const RayCamera& cam, const RayGrid& grid, unsigned int screenWidth,
+                              int x0, RayHit* out) {
+    RayPacketLanes lanes;
+    lanes.init(cam, screenWidth, x0);
+
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d huge = _mm256_set1_pd(1e30);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    const __m256d width = _mm256_set1_pd(grid.width);
+    const __m256d height = _mm256_set1_pd(grid.height);
+    const __m256d stride = _mm256_set1_pd(grid.stride);
+    const __m256d posX = _mm256_set1_pd(cam.posX);
+    const __m256d posY = _mm256_set1_pd(cam.posY);
+    const __m256d startX = _mm256_set1_pd(static_cast<double>(static_cast<int>(cam.posX)));
+    const __m256d startY = _mm256_set1_pd(static_cast<double>(static_cast<int>(cam.posY)));
+    const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const int* cells = reinterpret_cast<const int*>(grid.solid);
+
+    __m256d dirX = _mm256_load_pd(lanes.rayDirX);
+    __m256d dirY = _mm256_load_pd(lanes.rayDirY);
+    __m256d negX = _mm256_cmp_pd(dirX, zero, _CMP_LT_OQ);
+    __m256d negY = _mm256_cmp_pd(dirY, zero, _CMP_LT_OQ);
+    __m256d deltaX = _mm256_blendv_pd(_mm256_andnot_pd(signMask, _mm256_div_pd(one, dirX)), huge,
+                                      _mm256_cmp_pd(dirX, zero, _CMP_EQ_OQ));
+    __m256d deltaY = _mm256_blendv_pd(_mm256_andnot_pd(signMask, _mm256_div_pd(one, dirY)), huge,
+                                      _mm256_cmp_pd(dirY, zero, _CMP_EQ_OQ));
+    __m256d sideX = _mm256_blendv_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(startX, one), posX), deltaX),
+                                     _mm256_mul_pd(_mm256_sub_pd(posX, startX), deltaX), negX);
+    __m256d sideY = _mm256_blendv_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_add_pd(startY, one), posY), deltaY),
+                                     _mm256_mul_pd(_mm256_sub_pd(posY, startY), deltaY), negY);
+    __m256d stepX = _mm256_or_pd(one, _mm256_and_pd(negX, signMask));
+    __m256d stepY = _mm256_or_pd(one, _mm256_and_pd(negY, signMask));
+    __m256d mapX = startX;
+    __m256d mapY = startY;
+    __m256d side = zero;
+    __m256d live = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    do {
+        __m256d lt = _mm256_cmp_pd(sideX, sideY, _CMP_LT_OQ);
+        __m256d takeX = _mm256_and_pd(lt, live);
+        __m256d takeY = _mm256_andnot_pd(lt, live);
+        sideX = _mm256_blendv_pd(sideX, _mm256_add_pd(sideX, deltaX), takeX);
+        sideY = _mm256_blendv_pd(sideY, _mm256_add_pd(sideY, deltaY), takeY);
+        mapX = _mm256_blendv_pd(mapX, _mm256_add_pd(mapX, stepX), takeX);
+        mapY = _mm256_blendv_pd(mapY, _mm256_add_pd(mapY, stepY), takeY);
+        side = _mm256_blendv_pd(_mm256_blendv_pd(side, one, takeY), zero, takeX);
+
+        __m256d inside = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(mapX, zero, _CMP_GE_OQ), _mm256_cmp_pd(mapX, width, _CMP_LT_OQ)),
+            _mm256_and_pd(_mm256_cmp_pd(mapY, zero, _CMP_GE_OQ), _mm256_cmp_pd(mapY, height, _CMP_LT_OQ)));
+        __m256d probe = _mm256_and_pd(inside, live);
+
+        // Cell index y * stride + x, exact in double for any grid that fits in memory
+        __m128i index = _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_mul_pd(mapY, stride), mapX));
+        __m128i probe32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_castpd_si256(probe), lowHalves));
+        __m128i cell = _mm_mask_i32gather_epi32(_mm_setzero_si128(), cells, index, probe32, 1);
+        __m128i solid32 = _mm_cmpgt_epi32(_mm_and_si128(cell, byteMask), _mm_setzero_si128());
+        __m256d solid = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(solid32));
+
+        __m256d hit = _mm256_or_pd(_mm256_andnot_pd(inside, live), _mm256_and_pd(solid, live));
+        live = _mm256_andnot_pd(hit, live);
+    } while (_mm256_movemask_pd(live) != 0);
+
+    _mm256_store_pd(lanes.mapX, mapX);
+    _mm256_store_pd(lanes.mapY, mapY);
+    _mm256_store_pd(lanes.side, side);
+    lanes.finish(cam, out);
+}
+
+#endif // RAY_PACKET_X86
+
+#ifdef RAY_PACKET_NEON
+
+// Same structure as the SSE2 kernel on 2-wide float64x2_t registers
+inline void castRayPacketNEON(const RayCamera& cam, const RayGrid& grid, unsigned int screenWidth,
+                              int x0, RayHit* out) {
+    RayPacketLanes lanes;
+    lanes.init(cam, screenWidth, x0);
+
+    const float64x2_t zero = vdupq_n_f64(0.0);
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t minusOne = vdupq_n_f64(-1.0);
+    const float64x2_t huge = vdupq_n_f64(1e30);
+    const float64x2_t width = vdupq_n_f64(grid.width);
+    const float64x2_t height = vdupq_n_f64(grid.height);
+    const float64x2_t posX = vdupq_n_f64(cam.posX);
+    const float64x2_t posY = vdupq_n_f64(cam.posY);
+    const float64x2_t startX = vdupq_n_f64(static_cast<double>(static_cast<int>(cam.posX)));
+    const float64x2_t startY = vdupq_n_f64(static_cast<double>(static_cast<int>(cam.posY)));
+
+    auto laneMask = [](int bits) {
+        const uint64_t lanesSet[2] = {(bits & 1) ? ~0ull : 0ull, (bits & 2) ? ~0ull : 0ull};
+        return vld1q_u64(lanesSet);
+    };
+    auto maskBits = [](uint64x2_t mask) {
+        return static_cast<int>((vgetq_lane_u64(mask, 0) & 1) | ((vgetq_lane_u64(mask, 1) & 1) << 1));
+    };
+
+    float64x2_t deltaX[2], deltaY[2], sideX[2], sideY[2], stepX[2], stepY[2], mapX[2], mapY[2], side[2];
+    for (int h = 0; h < 2; h++) {
+        float64x2_t dirX = vld1q_f64(lanes.rayDirX + 2 * h);
+        float64x2_t dirY = vld1q_f64(lanes.rayDirY + 2 * h);
+        uint64x2_t negX = vcltq_f64(dirX, zero);
+        uint64x2_t negY = vcltq_f64(dirY, zero);
+        deltaX[h] = vbslq_f64(vceqq_f64(dirX, zero), huge, vabsq_f64(vdivq_f64(one, dirX)));
+        deltaY[h] = vbslq_f64(vceqq_f64(dirY, zero), huge, vabsq_f64(vdivq_f64(one, dirY)));
+        sideX[h] = vbslq_f64(negX, vmulq_f64(vsubq_f64(posX, startX), deltaX[h]),
+                             vmulq_f64(vsubq_f64(vaddq_f64(startX, one), posX), deltaX[h]));
+        sideY[h] = vbslq_f64(negY, vmulq_f64(vsubq_f64(posY, startY), deltaY[h]),
+                             vmulq_f64(vsubq_f64(vaddq_f64(startY, one), posY), deltaY[h]));
+        stepX[h] = vbslq_f64(negX, minusOne, one);
+        stepY[h] = vbslq_f64(negY, minusOne, one);
+        mapX[h] = startX;
+        mapY[h] = startY;
+        side[h] = zero;
+    }
+
+    int active = 0xF;
+    while (active) {
+        int inside = 0;
+        for (int h = 0; h < 2; h++) {
+            uint64x2_t live = laneMask(active >> (2 * h));
+            uint64x2_t lt = vcltq_f64(sideX[h], sideY[h]);
+            uint64x2_t takeX = vandq_u64(lt, live);
+            uint64x2_t takeY = vbicq_u64(live, lt);
+            sideX[h] = vbslq_f64(takeX, vaddq_f64(sideX[h], deltaX[h]), sideX[h]);
+            sideY[h] = vbslq_f64(takeY, vaddq_f64(sideY[h], deltaY[h]), sideY[h]);
+            mapX[h] = vbslq_f64(takeX, vaddq_f64(mapX[h], stepX[h]), mapX[h]);
+            mapY[h] = vbslq_f64(takeY, vaddq_f64(mapY[h], stepY[h]), mapY[h]);
+            side[h] = vbslq_f64(takeX, zero, vbslq_f64(takeY, one, side[h]));
+
+            uint64x2_t in = vandq_u64(vandq_u64(vcgeq_f64(mapX[h], zero), vcltq_f64(mapX[h], width)),
+                                      vandq_u64(vcgeq_f64(mapY[h], zero), vcltq_f64(mapY[h], height)));
+            inside |= maskBits(in) << (2 * h);
+            vst1q_f64(lanes.mapX + 2 * h, mapX[h]);
+            vst1q_f64(lanes.mapY + 2 * h, mapY[h]);
+        }
+        active &= ~solidLanes(grid, lanes.mapX, lanes.mapY, inside);
+    }
+
+    for (int h = 0; h < 2; h++) vst1q_f64(lanes.side + 2 * h, side[h]);
+    lanes.finish(cam, out);
+}
+
+#endif // RAY_PACKET_NEON
+
+inline bool rayIsaSupported(RayIsa isa) {
+    switch (isa) {
+        case RayIsa::Scalar:
+            return true;
+#ifdef RAY_PACKET_X86
+        case RayIsa::SSE2:
+            return true;
+        case RayIsa::AVX2: {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+            bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5));
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+#endif
+#ifdef RAY_PACKET_NEON
+        case RayIsa::NEON:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+inline RayIsa bestRayIsa() {
+    if (rayIsaSupported(RayIsa::AVX2)) return RayIsa::AVX2;
+    if (rayIsaSupported(RayIsa::SSE2)) return RayIsa::SSE2;
+    if (rayIsaSupported(RayIsa::NEON)) return RayIsa::NEON;
+    return RayIsa::Scalar;
+}
+
+// Casts columns [begin, end) into out[0 .. end - begin) with the chosen ISA,
+// which must be supported. Full packets go through the SIMD kernel and any
+// ragged tail through the scalar DDA.
+inline void castRayRange(RayIsa isa, const RayCamera& cam, const RayGrid& grid,
+                         unsigned int screenWidth, int begin, int end, RayHit* out) {
+    int x = begin;
+    if (isa != RayIsa::Scalar) {
+        for (; x + RAY_PACKET_WIDTH <= end; x += RAY_PACKET_WIDTH) {
+            RayHit* packet = out + (x - begin);
+            switch (isa) {
+#ifdef RAY_PACKET_X86
+                case RayIsa::SSE2: castRayPacketSSE2(cam, grid, screenWidth, x, packet); break;
+                case RayIsa::AVX2: castRayPacketAVX2(cam, grid, screenWidth, x, packet); break;
+#endif
+#ifdef RAY_PACKET_NEON
+                case RayIsa::NEON: castRayPacketNEON(cam, grid, screenWidth, x, packet); break;
+#endif
+                default:
+                    for (int i = 0; i < RAY_PACKET_WIDTH; i++) {
+                        packet[i] = castRayScalar(cam, grid, screenWidth, x + i);
+                    }
+                    break;
+            }
+        }
+    }
+    for (; x < end; x++) {
+        out[x - begin] = castRayScalar(cam, grid, screenWidth, x);
+    }
+}
@@ -0,0 +1,730 @@
+#include "raycast_renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "profiler.hpp"
+
+// Writes an axis-aligned quad as two triangles into out[0..5]. texRect is in
+// texture pixels and is ignored when the batch is drawn without a texture.
+void writeQuad(sf::Vertex* out, float x, float y, float w, float h, sf::Color color,
+               sf::FloatRect texRect = {}) {
+    float u0 = texRect.position.x;
+    float v0 = texRect.position.y;
+    float u1 = u0 + texRect.size.x;
+    float v1 = v0 + texRect.size.y;
+    
+    sf::Vertex topLeft{{x, y}, color, {u0, v0}};
+    sf::Vertex topRight{{x + w, y}, color, {u1, v0}};
+    sf::Vertex bottomLeft{{x, y + h}, color, {u0, v1}};
+    sf::Vertex bottomRight{{x + w, y + h}, color, {u1, v1}};
+    
+    out[0] = topLeft;
+    out[1] = topRight;
+    out[2] = bottomLeft;
+    out[3] = topRight;
+    out[4] = bottomRight;
+    out[5] = bottomLeft;
+}
+
+sf::Vector2u renderSize(const EngineConfig& config) {
+    auto scaled = [&](unsigned int size) {
+        return std::max(1u, static_cast<unsigned int>(std::lround(size * static_cast<double>(config.renderScale))));
+    };
+    return {scaled(config.screenWidth), scaled(config.screenHeight)};
+}
+
+void gatherVisible(VisibleEntities& out, const GameWorld& world, const Player& view, int viewer) {
+    out.enemies.clear();
+    out.pickups.clear();
+    out.projectiles.clear();
+    out.particles.clear();
+    out.players.clear();
+    const RoomVisibility* visibility = world.visibility.get();
+    const int from = visibility ? visibility->regionAt(view.posX, view.posY) : RoomVisibility::None;
+    
+    if (from == RoomVisibility::None) {
+        for (std::size_t i = 0; i < world.enemies.size(); i++) {
+            if (world.enemies.active[i]) out.enemies.push_back(static_cast<int>(i));
+        }
+        for (std::size_t i = 0; i < world.pickups.size(); i++) {
+            if (world.pickups.active[i]) out.pickups.push_back(static_cast<int>(i));
+        }
+    } else {
+        // A region's bounds can overlap another's, so keep only the rows
+        // standing in the region itself
+        for (int region : visibility->visibleFrom(from)) {
+            const RoomVisibility::Bounds& b = visibility->bounds(region);
+            world.enemyIndex.forEachInTiles(b.minX, b.minY, b.maxX, b.maxY, [&](int id) {
+                if (visibility->regionAt(world.enemies.x[id], world.enemies.y[id]) == region) out.enemies.push_back(id);
+            });
+            world.pickupIndex.forEachInTiles(b.minX, b.minY, b.maxX, b.maxY, [&](int id) {
+                if (visibility->regionAt(world.pickups.x[id], world.pickups.y[id]) == region) out.pickups.push_back(id);
+            });
+        }
+    }
+    
+    auto seen = [&](double x, double y) {
+        return !visibility || visibility->visible(from, visibility->regionAt(x, y));
+    };
+    for (int id : world.enemies.dying) {
+        if (seen(world.enemies.x[id], world.enemies.y[id])) out.enemies.push_back(id);
+    }
+    for (std::size_t i = 0; i < world.projectiles.size(); i++) {
+        if (seen(world.projectiles.x[i], world.projectiles.y[i])) out.projectiles.push_back(static_cast<int>(i));
+    }
+    for (std::size_t i = 0; i < world.particles.count(); i++) {
+        if (seen(world.particles.x[i], world.particles.y[i])) out.particles.push_back(static_cast<int>(i));
+    }
+    for (std::size_t slot = 0; slot < world.players.size(); slot++) {
+        const Player& player = world.players[slot];
+        if (static_cast<int>(slot) != viewer && seen(player.posX, player.posY)) out.players.push_back(static_cast<int>(slot));
+    }
+}
+
+RenderContext::RenderContext(const EngineConfig& config)
+    : output(config.screenWidth, config.screenHeight), mode(config.renderMode),
+      batches(renderSize(config).x, renderSize(config).y),
+      workers(config.workerThreads > 0 ? config.workerThreads : WorkerPool::hardwareThreads()),
+      rayIsa(config.rayIsa), hits(renderSize(config).x) {
+    const sf::Vector2u size = renderSize(config);
+    if (mode == RenderMode::Software) framebuffer = std::make_unique<Framebuffer>(size.x, size.y);
+    if (mode == RenderMode::Shapes) wallSlices.resize(size.x);
+    if (config.targetFps > 0) {
+        resolution = std::make_unique<ResolutionController>(size.x, size.y, 1000.0 / config.targetFps);
+    }
+    if (config.interlace) interlace = std::make_unique<InterlacedCaster>(INTERLACE_MAX_TURN);
+    if (size != output || resolution) {
+        scene = std::make_unique<sf::RenderTexture>();
+        if (scene->resize(size)) {
+            scene->setSmooth(config.upscale == UpscaleFilter::Bilinear);
+        } else {
+            std::cerr << "Could not create a " << size.x << "x" << size.y << " render target, drawing at "
+                      << output.x << "x" << output.y << "\n";
+            scene.reset();
+            resolution.reset();
+            batches = RenderBatches(output.x, output.y);
+            hits.resize(output.x);
+            if (framebuffer) framebuffer = std::make_unique<Framebuffer>(output.x, output.y);
+            if (mode == RenderMode::Shapes) wallSlices.resize(output.x);
+        }
+    }
+    setSurfaces(sf::Image());
+}
+
+void RenderContext::setSurfaces(const sf::Image& tileset) {
+    colormap = Colormap();
+    wallTexels = IndexedColumns::fromImage(tileset, surfaceTile(WALL_TILE), colormap, sf::Color(120, 80, 60));
+    floorTexels = IndexedColumns::fromImage(tileset, surfaceTile(FLOOR_TILE), colormap, sf::Color(30, 30, 30));
+    ceilingTexels = IndexedColumns::fromImage(tileset, surfaceTile(CEILING_TILE), colormap, sf::Color(50, 50, 50));
+    colormap.build();
+}
+
+// Emits one quad per run of adjacent columns where the sprite is in front of
+// the wall and not behind a nearer opaque sprite, so occlusion stays per
+// column without a draw call per column
+void appendSpriteRuns(std::vector<sf::Vertex>& vertices, const std::vector<double>& zBuffer,
+                      const ColumnCoverage& coverage, const SpriteItem& sprite) {
+    if (sprite.width <= 0 || sprite.bottom <= sprite.top) return;
+    
+    int startX = std::max(sprite.left, 0);
+    int endX = std::min(sprite.left + sprite.width, static_cast<int>(zBuffer.size()));
+    float texPerColumn = sprite.texRect.size.x / sprite.width;
+    auto shown = [&](int x) {
+        return sprite.depth < zBuffer[x] && !coverage.covered(x, sprite.top, sprite.bottom, sprite.depth);
+    };
+    
+    int stripe = startX;
+    while (stripe < endX) {
+        // Skip hidden columns, then extend the run while shown
+        if (!shown(stripe)) {
+            stripe++;
+            continue;
+        }
+        int runStart = stripe;
+        while (stripe < endX && shown(stripe)) stripe++;
+        
+        sf::FloatRect runTex({sprite.texRect.position.x + (runStart - sprite.left) * texPerColumn,
+                              sprite.texRect.position.y},
+                             {(stripe - runStart) * texPerColumn, sprite.texRect.size.y});
+        std::size_t base = vertices.size();
+        vertices.resize(base + 6);
+        writeQuad(&vertices[base], static_cast<float>(runStart), static_cast<float>(sprite.top),
+                  static_cast<float>(stripe - runStart), static_cast<float>(sprite.bottom - sprite.top),
+                  sprite.color, runTex);
+    }
+}
+
+// Adds frame, placed in its box of a square side pixels wide whose top
+// left corner is at (left, top) in the view, clipped to the view's rows.
+// An opaque frame hides what its core covers from sprites behind it.
+void addFrame(RenderBatches& batches, const AtlasFrame& frame, double left, double top, double side,
+              double depth, sf::Color color, bool opaque, double squaredDistance) {
+    const double frameLeft = left + frame.box.position.x * side;
+    const double frameTop = top + frame.box.position.y * side;
+    const int screenLeft = static_cast<int>(std::floor(frameLeft));
+    const int width = static_cast<int>(std::floor(frameLeft + frame.box.size.x * side)) - screenLeft;
+    const int spriteTop = static_cast<int>(std::floor(frameTop));
+    const int spriteBottom = static_cast<int>(std::floor(frameTop + frame.box.size.y * side));
+    const int drawStartY = std::max(spriteTop, 0);
+    const int drawEndY = std::min(spriteBottom, static_cast<int>(batches.height) - 1);
+    if (width <= 0 || drawEndY <= drawStartY) return;
+    
+    // Sample only the rows that survive vertical clipping
+    const sf::IntRect& rect = frame.rect;
+    const double down = static_cast<double>(spriteBottom - spriteTop) / rect.size.y;
+    const float texPerRow = static_cast<float>(1 / down);
+    sf::FloatRect texRect({static_cast<float>(rect.position.x), rect.position.y + (drawStartY - spriteTop) * texPerRow},
+                          {static_cast<float>(rect.size.x), (drawEndY - drawStartY) * texPerRow});
+    
+    // The core scaled to the screen, rounded inwards so it never claims a
+    // pixel the frame leaves partly transparent
+    sf::IntRect hidden;
+    const sf::IntRect& core = frame.core;
+    if (opaque && core.size.x > 0 && core.size.y > 0) {
+        const double across = static_cast<double>(width) / rect.size.x;
+        const int coreLeft = screenLeft + static_cast<int>(std::ceil(core.position.x * across));
+        const int coreRight = screenLeft + static_cast<int>(std::floor((core.position.x + core.size.x) * across));
+        const int coreTop = std::max(drawStartY, spriteTop + static_cast<int>(std::ceil(core.position.y * down)));
+        const int coreBottom = std::min(drawEndY, spriteTop + static_cast<int>(
+                                                      std::floor((core.position.y + core.size.y) * down)));
+        if (coreRight > coreLeft && coreBottom > coreTop) {
+            hidden = sf::IntRect({coreLeft, coreTop}, {coreRight - coreLeft, coreBottom - coreTop});
+        }
+    }
+    
+    batches.addSprite({frame.page, color, texRect, depth, screenLeft, width, drawStartY, drawEndY, hidden},
+                      squaredDistance);
+}
+
+// Square world-space billboard, side tiles wide, centred at height z
+// (0 = floor, 1 = ceiling), with frame placed in it
+void addBillboard(RenderBatches& batches, const Player& player, double invDet,
+                  double x, double y, double z, double side, const AtlasFrame* frame) {
+    if (!frame || !frame->page) return;
+    
+    double spriteX = x - player.posX;
+    double spriteY = y - player.posY;
+    
+    double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
+    double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
+    
+    if (transformY <= 0.1) return;
+    
+    double scale = batches.height / transformY;
+    double size = side * scale;
+    if (size < 1) return;
+    
+    double screenX = (batches.width / 2) * (1 + transformX / transformY);
+    double top = batches.height / 2 + (0.5 - z) * scale - size / 2;
+    
+    // Flipbook frames are mostly soft edges, so they hide nothing
+    addFrame(batches, *frame, screenX - size / 2, top, size, transformY, sf::Color::White, false,
+             spriteX * spriteX + spriteY * spriteY);
+}
+
+// Sorts the frame's sprites and walks them near to far once, dropping the
+// columns hidden behind walls or behind the opaque part of a nearer
+// sprite. What survives is in spriteRuns, for drawing far to near so its
+// edges blend over what lies behind.
+void cullSprites(RenderBatches& batches) {
+    radixSortEntries(batches.spriteOrder, batches.sortScratch);
+    
+    batches.coverage.reset(batches.width);
+    batches.spriteRuns.clear();
+    for (std::uint64_t entry : batches.spriteOrder) {
+        SpriteItem& sprite = batches.sprites[static_cast<std::uint32_t>(entry)];
+        sprite.firstVertex = batches.spriteRuns.size();
+        appendSpriteRuns(batches.spriteRuns, batches.zBuffer, batches.coverage, sprite);
+        sprite.vertexCount = batches.spriteRuns.size() - sprite.firstVertex;
+        batches.coverage.cover(sprite.opaque, sprite.depth);
+    }
+}
+
+// Draws what cullSprites kept in one call per run of sprites sharing a
+// texture
+void drawSprites(sf::RenderTarget& target, RenderBatches& batches) {
+    cullSprites(batches);
+    
+    std::vector<sf::Vertex>& vertices = batches.spriteVertices;
+    vertices.clear();
+    batches.spriteDraws.clear();
+    for (auto it = batches.spriteOrder.rbegin(); it != batches.spriteOrder.rend(); ++it) {
+        const SpriteItem& sprite = batches.sprites[static_cast<std::uint32_t>(*it)];
+        if (sprite.vertexCount == 0) continue;
+        if (batches.spriteDraws.empty() || batches.spriteDraws.back().texture != sprite.texture) {
+            batches.spriteDraws.push_back({sprite.texture, vertices.size(), 0});
+        }
+        vertices.insert(vertices.end(), batches.spriteRuns.begin() + sprite.firstVertex,
+                        batches.spriteRuns.begin() + sprite.firstVertex + sprite.vertexCount);
+        batches.spriteDraws.back().count += sprite.vertexCount;
+    }
+    for (const SpriteDraw& draw : batches.spriteDraws) {
+        target.draw(&vertices[draw.first], draw.count, sf::PrimitiveType::Triangles,
+                    sf::RenderStates(draw.texture));
+    }
+}
+
+RayCamera rayCamera(const Player& player) {
+    return {player.posX, player.posY, player.dirX, player.dirY, player.planeX, player.planeY};
+}
+
+RayHit castRay(const Player& player, const TileMap& map, int screenWidth, int x) {
+    RayCamera cam = rayCamera(player);
+    double rayDirX, rayDirY;
+    rayDirection(cam, screenWidth, x, rayDirX, rayDirY);
+    
+    int mapX = static_cast<int>(player.posX);
+    int mapY = static_cast<int>(player.posY);
+    
+    double deltaDistX = (rayDirX == 0) ? 1e30 : std::abs(1 / rayDirX);
+    double deltaDistY = (rayDirY == 0) ? 1e30 : std::abs(1 / rayDirY);
+    
+    double sideDistX, sideDistY;
+    int stepX, stepY;
+    
+    if (rayDirX < 0) {
+        stepX = -1;
+        sideDistX = (player.posX - mapX) * deltaDistX;
+    } else {
+        stepX = 1;
+        sideDistX = (mapX + 1.0 - player.posX) * deltaDistX;
+    }
+    
+    if (rayDirY < 0) {
+        stepY = -1;
+        sideDistY = (player.posY - mapY) * deltaDistY;
+    } else {
+        stepY = 1;
+        sideDistY = (mapY + 1.0 - player.posY) * deltaDistY;
+    }
+    
+    int side = 0;
+    bool hit = false;
+    while (!hit) {
+        if (sideDistX < sideDistY) {
+            sideDistX += deltaDistX;
+            mapX += stepX;
+            side = 0;
+        } else {
+            sideDistY += deltaDistY;
+            mapY += stepY;
+            side = 1;
+        }
+        
+        hit = map.isWall(mapX, mapY);
+    }
+    
+    return finishRay(cam, mapX, mapY, stepX, stepY, side, rayDirX, rayDirY);
+}
+
+Player interpolatedView(const Player& previous, const Player& current, float alpha) {
+    Player view = current;
+    view.posX = interpolate(previous.posX, current.posX, alpha);
+    view.posY = interpolate(previous.posY, current.posY, alpha);
+    
+    const double from = std::atan2(previous.dirY, previous.dirX);
+    const double turn = std::remainder(std::atan2(current.dirY, current.dirX) - from, 2 * 3.14159265358979323846);
+    const double angle = from + turn * alpha;
+    const double planeLength = std::hypot(current.planeX, current.planeY);
+    view.dirX = std::cos(angle);
+    view.dirY = std::sin(angle);
+    view.planeX = view.dirY * planeLength;
+    view.planeY = -view.dirX * planeLength;
+    return view;
+}
+
+// Projects the sprites of the entities in context.visible into the
+// batches. Moving entities are drawn alpha of the way from their
+// previous-tick position to their current one.
+void projectSprites(RenderContext& context, const Player& player, const GameWorld& world, float alpha, double time) {
+    const EnemyStore& enemies = world.enemies;
+    const PickupStore& pickups = world.pickups;
+    const ProjectileStore& projectiles = world.projectiles;
+    const ParticlePool& particles = world.particles;
+    const std::vector<Player>& previousPlayers = world.previousPlayers;
+    const std::vector<Player>& players = world.players;
+    const GameAssets& assets = world.assets;
+    RenderBatches& batches = context.batches;
+    const unsigned int viewWidth = batches.width;
+    const unsigned int viewHeight = batches.height;
+    
+    double invDet = 1.0 / (player.planeX * player.dirY - player.dirX * player.planeY);
+    
+    batches.clearSprites();
+    
+    // Pickups (flat coloured, over the atlas's white square so they share
+    // its bind), hiding all they cover
+    const AtlasFrame& white = assets.sprites.frame(SpriteAtlas::WHITE);
+    const sf::FloatRect whiteTexels = white.page ? sf::FloatRect(sf::Vector2f(white.rect.position) + sf::Vector2f(1, 1),
+                                                                 sf::Vector2f(white.rect.size) - sf::Vector2f(2, 2))
+                                                 : sf::FloatRect();
+    float bob = static_cast<float>(std::sin(time * 3) * 10);
+    for (int i : context.visible.pickups) {
+        double spriteX = pickups.x[i] - player.posX;
+        double spriteY = pickups.y[i] - player.posY;
+        
+        double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
+        double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
+        
+        if (transformY <= 0.1) continue;
+        
+        int spriteScreenX = static_cast<int>((viewWidth / 2) * (1 + transformX / transformY));
+        int spriteHeight = static_cast<int>(std::abs(viewHeight / transformY) * 0.5);
+        int spriteWidth = spriteHeight;
+        
+        int drawStartY = -spriteHeight / 2 + viewHeight / 2 + static_cast<int>(bob);
+        int drawEndY = spriteHeight / 2 + viewHeight / 2 + static_cast<int>(bob);
+        
+        if (drawStartY < 0) drawStartY = 0;
+        if (drawEndY >= static_cast<int>(viewHeight)) drawEndY = viewHeight - 1;
+        
+        sf::Color pickupColor;
+        switch (pickups.type[i]) {
+            case PickupType::HealthPack: pickupColor = sf::Color::Green; break;
+            case PickupType::Ammo: pickupColor = sf::Color::Yellow; break;
+            case PickupType::Armor: pickupColor = sf::Color::Blue; break;
+        }
+        
+        int left = spriteScreenX - spriteWidth / 2;
+        batches.addSprite({white.page, pickupColor, whiteTexels, transformY, left, spriteWidth, drawStartY, drawEndY,
+                           sf::IntRect({left, drawStartY}, {spriteWidth, drawEndY - drawStartY})},
+                          spriteX * spriteX + spriteY * spriteY);
+    }
+    
+    // Enemies, at the frame of their animation, hiding what its opaque core covers
+    for (int i : context.visible.enemies) {
+        const EnemyArt* look = assets.enemyLook(enemies.type[i], enemies.variant[i]);
+        const AtlasFrame* frame = look ? look->clip(enemies.anim[i]).frameAt(enemies.animTime[i]) : nullptr;
+        if (!frame || !frame->page) continue;
+        
+        double spriteX = interpolate(enemies.prevX[i], enemies.x[i], alpha) - player.posX;
+        double spriteY = interpolate(enemies.prevY[i], enemies.y[i], alpha) - player.posY;
+        
+        double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
+        double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
+        
+        if (transformY <= 0.1) continue;
+        
+        double spriteScreenX = (viewWidth / 2) * (1 + transformX / transformY);
+        double spriteHeight = std::abs(viewHeight / transformY);
+        if (spriteHeight < 1) continue;
+        
+        // Health indicator, applied as a vertex tint over the texture; the
+        // dying are drawn as they are
+        float healthPercent = enemies.active[i] ? static_cast<float>(enemies.health[i]) / enemies.maxHealth[i] : 1.f;
+        auto shade = static_cast<std::uint8_t>(255 * std::clamp(healthPercent, 0.f, 1.f));
+        sf::Color tint(shade, shade, shade);
+        
+        addFrame(batches, *frame, spriteScreenX - spriteHeight / 2, (viewHeight - spriteHeight) / 2, spriteHeight,
+                 transformY, tint, true, spriteX * spriteX + spriteY * spriteY);
+    }
+    
+    // Other players, flat in their colours like the pickups: as tall as the
+    // view at their distance and a third as wide, standing on the floor
+    for (int slot : context.visible.players) {
+        double spriteX = interpolate(previousPlayers[slot].posX, players[slot].posX, alpha) - player.posX;
+        double spriteY = interpolate(previousPlayers[slot].posY, players[slot].posY, alpha) - player.posY;
+        
+        double transformX = invDet * (player.dirY * spriteX - player.dirX * spriteY);
+        double transformY = invDet * (-player.planeY * spriteX + player.planeX * spriteY);
+        
+        if (transformY <= 0.1) continue;
+        
+        int spriteScreenX = static_cast<int>((viewWidth / 2) * (1 + transformX / transformY));
+        int spriteHeight = static_cast<int>(std::abs(viewHeight / transformY));
+        int spriteWidth = std::max(1, spriteHeight / 3);
+        int drawStartY = std::max(0, -spriteHeight / 2 + static_cast<int>(viewHeight / 2));
+        int drawEndY = std::min(static_cast<int>(viewHeight) - 1, spriteHeight / 2 + static_cast<int>(viewHeight / 2));
+        
+        int left = spriteScreenX - spriteWidth / 2;
+        batches.addSprite({white.page, PLAYER_COLORS[slot], whiteTexels, transformY, left, spriteWidth, drawStartY,
+                           drawEndY, sf::IntRect({left, drawStartY}, {spriteWidth, drawEndY - drawStartY})},
+                          spriteX * spriteX + spriteY * spriteY);
+    }
+    
+    // Projectiles and particles, as billboards from their flipbooks
+    for (int i : context.visible.projectiles) {
+        addBillboard(batches, player, invDet, interpolate(projectiles.prevX[i], projectiles.x[i], alpha),
+                     interpolate(projectiles.prevY[i], projectiles.y[i], alpha), 0.5, 0.2, projectiles.frame(i));
+    }
+    for (int i : context.visible.particles) {
+        addBillboard(batches, player, invDet, interpolate(particles.prevX[i], particles.x[i], alpha),
+                     interpolate(particles.prevY[i], particles.y[i], alpha),
+                     interpolate(particles.prevZ[i], particles.z[i], alpha),
+                     particles.size[i], particles.frame(i));
+    }
+}
+
+// The grey a wall column is tinted, by the same light levels as the
+// colormap; untextured walls are a darker flat grey
+std::uint8_t wallShade(const RenderContext& context, const RayHit& hit, bool textured) {
+    const Colormap& colormap = context.colormap;
+    return static_cast<std::uint8_t>((textured ? 255 : 120) *
+                                     colormap.light(colormap.level(hit.perpWallDist), hit.side == 1));
+}
+
+// ===========================================
+// BACKENDS
+// ===========================================
+
+void VertexArrayBackend::background(RenderContext& context, const RayCamera&) {
+    sf::VertexArray& walls = context.batches.walls;
+    const unsigned int viewWidth = context.viewWidth();
+    const unsigned int viewHeight = context.viewHeight();
+    
+    // Ceiling
+    writeQuad(&walls[0], 0.f, 0.f, static_cast<float>(viewWidth),
+              static_cast<float>(viewHeight / 2), sf::Color(50, 50, 50));
+    
+    // Floor
+    writeQuad(&walls[6], 0.f, static_cast<float>(viewHeight / 2), static_cast<float>(viewWidth),
+              static_cast<float>(viewHeight / 2), sf::Color(30, 30, 30));
+}
+
+// The tile's texel column over the visible rows, in column x's fixed slot
+void VertexArrayBackend::column(RenderContext& context, int x, const RayHit& hit, int lineHeight,
+                                int drawStart, int drawEnd, bool textured) {
+    const unsigned int viewHeight = context.viewHeight();
+    const double texPerPixel = static_cast<double>(SURFACE_TILE) / lineHeight;
+    if (drawStart < 0) drawStart = 0;
+    if (drawEnd > static_cast<int>(viewHeight)) drawEnd = viewHeight;
+    const double texTop = (drawStart - viewHeight / 2.0 + lineHeight / 2.0) * texPerPixel;
+    const sf::FloatRect tex({static_cast<float>(WALL_TILE.x * SURFACE_TILE + hit.wallX * SURFACE_TILE),
+                             static_cast<float>(WALL_TILE.y * SURFACE_TILE + texTop)},
+                            {0.f, static_cast<float>((drawEnd - drawStart) * texPerPixel)});
+    const std::uint8_t grey = wallShade(context, hit, textured);
+    writeQuad(&context.batches.walls[(x + 2) * 6], static_cast<float>(x), static_cast<float>(drawStart),
+              1.f, static_cast<float>(drawEnd - drawStart), sf::Color(grey, grey, grey), tex);
+}
+
+void VertexArrayBackend::present(sf::RenderTarget& target, RenderContext& context, const sf::Texture& wallTexture) {
+    sf::VertexArray& walls = context.batches.walls;
+    target.draw(&walls[0], 12, sf::PrimitiveType::Triangles);
+    target.draw(&walls[12], walls.getVertexCount() - 12, sf::PrimitiveType::Triangles,
+                sf::RenderStates(wallTexture.getSize().x > 0 ? &wallTexture : nullptr));
+}
+
+void VertexArrayBackend::sprites(sf::RenderTarget& target, RenderBatches& batches) {
+    drawSprites(target, batches);
+}
+
+// Floor rows and their mirrored ceiling rows, a slice of rows each
+void FramebufferBackend::background(RenderContext& context, const RayCamera& cam) {
+    Framebuffer& framebuffer = *context.framebuffer;
+    context.floorRows.update(context.viewWidth(), context.viewHeight(), context.colormap);
+    context.workers.parallelFor(static_cast<int>(context.floorRows.rows()), [&](int begin, int end) {
+        castFloorRows(framebuffer, cam, context.floorRows, context.colormap,
+                      context.floorTexels, context.ceilingTexels, begin, end);
+    });
+}
+
+void FramebufferBackend::column(RenderContext& context, int x, const RayHit& hit, int lineHeight,
+                                int drawStart, int drawEnd, bool) {
+    drawWallColumn(*context.framebuffer, x, hit, lineHeight, drawStart, drawEnd,
+                   context.colormap, context.wallTexels);
+}
+
+void FramebufferBackend::present(sf::RenderTarget& target, RenderContext& context, const sf::Texture&) {
+    target.draw(sf::Sprite(context.framebuffer->upload(),
+                           sf::IntRect({0, 0}, {static_cast<int>(context.viewWidth()),
+                                                static_cast<int>(context.viewHeight())})));
+}
+
+void FramebufferBackend::sprites(sf::RenderTarget& target, RenderBatches& batches) {
+    drawSprites(target, batches);
+}
+
+// Ceiling and floor are drawn with the walls
+void ShapeBackend::background(RenderContext&, const RayCamera&) {}
+
+void ShapeBackend::column(RenderContext& context, int x, const RayHit& hit, int,
+                          int drawStart, int drawEnd, bool textured) {
+    const std::uint8_t grey = wallShade(context, hit, textured);
+    context.wallSlices[x] = {static_cast<float>(drawStart), static_cast<float>(drawEnd - drawStart),
+                             WALL_TILE.x * SURFACE_TILE + static_cast<int>(hit.wallX * SURFACE_TILE),
+                             sf::Color(grey, grey, grey)};
+}
+
+// Each column stretches its whole tile column over its unclipped span, and
+// the target clips it
+void ShapeBackend::present(sf::RenderTarget& target, RenderContext& context, const sf::Texture& wallTexture) {
+    const float half = static_cast<float>(context.viewHeight() / 2);
+    sf::RectangleShape surface({static_cast<float>(context.viewWidth()), half});
+    surface.setFillColor(sf::Color(50, 50, 50));
+    target.draw(surface);
+    surface.setPosition({0.f, half});
+    surface.setFillColor(sf::Color(30, 30, 30));
+    target.draw(surface);
+    
+    sf::RectangleShape slice;
+    if (wallTexture.getSize().x > 0) slice.setTexture(&wallTexture);
+    for (unsigned int x = 0; x < context.viewWidth(); x++) {
+        const WallSlice& wall = context.wallSlices[x];
+        slice.setPosition({static_cast<float>(x), wall.top});
+        slice.setSize({1.f, wall.height});
+        slice.setTextureRect(sf::IntRect({wall.texelX, WALL_TILE.y * SURFACE_TILE}, {1, SURFACE_TILE}));
+        slice.setFillColor(wall.color);
+        target.draw(slice);
+    }
+}
+
+// The runs cullSprites kept, far to near, one shape each over the nearest
+// whole texels of its quad
+void ShapeBackend::sprites(sf::RenderTarget& target, RenderBatches& batches) {
+    cullSprites(batches);
+    
+    auto texel = [](sf::Vector2f coords) {
+        return sf::Vector2i(static_cast<int>(std::lround(coords.x)), static_cast<int>(std::lround(coords.y)));
+    };
+    sf::RectangleShape run;
+    for (auto it = batches.spriteOrder.rbegin(); it != batches.spriteOrder.rend(); ++it) {
+        const SpriteItem& sprite = batches.sprites[static_cast<std::uint32_t>(*it)];
+        run.setTexture(sprite.texture);
+        run.setFillColor(sprite.color);
+        for (std::size_t v = sprite.firstVertex; v < sprite.firstVertex + sprite.vertexCount; v += 6) {
+            // writeQuad puts the top left corner first and the bottom right fifth
+            const sf::Vertex& topLeft = batches.spriteRuns[v];
+            const sf::Vertex& bottomRight = batches.spriteRuns[v + 4];
+            const sf::Vector2i texTopLeft = texel(topLeft.texCoords);
+            const sf::Vector2i texSize = texel(bottomRight.texCoords) - texTopLeft;
+            run.setPosition(topLeft.position);
+            run.setSize(bottomRight.position - topLeft.position);
+            run.setTextureRect(sf::IntRect(texTopLeft, {std::max(texSize.x, 1), std::max(texSize.y, 1)}));
+            target.draw(run);
+        }
+    }
+}
+
+// ===========================================
+// PLAY VIEW
+// ===========================================
+
+// Casts every column, in parallel on the context's workers, and hands each
+// to Backend as it lands; walls are cast as SIMD packets when a packet ISA
+// is selected. Under interlacing, every hit is settled in two passes before
+// any column is handed on. Sprites, those in context.visible, are
+// composited after parallelFor returns, once every zBuffer slice is
+// complete.
+template <class Backend>
+void renderRaycaster(sf::RenderTarget& target, RenderContext& context, const Player& player,
+                     const GameWorld& world, float alpha, double time) {
+    const sf::Texture& wallTexture = *world.assets.wall;
+    const TileMap& map = world.map;
+    
+    RenderBatches& batches = context.batches;
+    const unsigned int viewWidth = batches.width;
+    const unsigned int viewHeight = batches.height;
+    ProfileScope wallScope(ProfileStage::Walls);
+    
+    RayCamera cam = rayCamera(player);
+    Backend::background(context, cam);
+    
+    std::vector<double>& zBuffer = batches.zBuffer;
+    
+    // Interlaced frames cast this frame's half of the columns, then rebuild
+    // the other half, which needs the first half complete
+    RayGrid grid = map.rayGrid();
+    InterlacedCaster* interlace = context.interlace.get();
+    const bool interlaced = interlace && interlace->begin(cam, viewWidth);
+    if (interlaced) {
+        context.workers.parallelFor(interlace->halfColumns(), [&](int begin, int end) {
+            interlace->castHalf(context.rayIsa, cam, grid, begin, end, context.hits.data());
+        });
+        context.workers.parallelFor(interlace->halfColumns(), [&](int begin, int end) {
+            interlace->rebuildHalf(context.rayIsa, cam, grid, begin, end, context.hits.data());
+        });
+    }
+    
+    // Raycast walls. Each worker owns a contiguous range of columns and writes
+    // only its own hits, zBuffer entries and column of the backend's output.
+    const bool wallTextured = wallTexture.getSize().x > 0;
+    const bool packets = !interlaced && context.rayIsa != RayIsa::Scalar;
+    context.workers.parallelFor(static_cast<int>(viewWidth), [&](int begin, int end) {
+        if (packets) castRayRange(context.rayIsa, cam, grid, viewWidth, begin, end, &context.hits[begin]);
+        for (int x = begin; x < end; x++) {
+            RayHit& hit = context.hits[x];
+            if (!interlaced && !packets) hit = castRay(player, map, viewWidth, x);
+            zBuffer[x] = hit.perpWallDist;
+            
+            int lineHeight = std::max(static_cast<int>(viewHeight / hit.perpWallDist), 1);
+            int drawStart = -lineHeight / 2 + viewHeight / 2;
+            int drawEnd = lineHeight / 2 + viewHeight / 2;
+            Backend::column(context, x, hit, lineHeight, drawStart, drawEnd, wallTextured);
+        }
+    });
+    
+    if (interlace) interlace->record(cam, viewWidth, context.hits.data());
+    
+    Backend::present(target, context, wallTexture);
+    wallScope.stop();
+    ProfileScope spriteScope(ProfileStage::Sprites);
+    
+    projectSprites(context, player, world, alpha, time);
+    Backend::sprites(target, batches);
+}
+
+void drawHud(sf::RenderTarget& target, const GameWorld& world, Hud& hud, int fps, int viewer) {
+    const Player& viewed = world.players[viewer];
+    HudValues values;
+    values.health = viewed.health;
+    values.maxHealth = viewed.maxHealth;
+    values.ammo = viewed.ammo;
+    values.score = viewed.score;
+    values.kills = viewed.kills;
+    values.enemies = static_cast<int>(world.enemies.size());
+    values.fps = fps;
+    values.effects = world.particles.count();
+    values.effectCapacity = world.particles.pressure.capacity;
+    ProfileScope hudScope(ProfileStage::Hud);
+    hud.update(values);
+    hud.draw(target);
+}
+
+template <class Backend>
+void drawPlayView(sf::RenderTarget& target, RenderContext& context, const GameWorld& world,
+                  Hud& hud, int fps, float alpha, int viewer, const Player* predicted) {
+    const Player view = predicted ? *predicted
+                                  : interpolatedView(world.previousPlayers[viewer], world.players[viewer], alpha);
+    {
+        ProfileScope scope(ProfileStage::Sprites);
+        gatherVisible(context.visible, world, view, viewer);
+    }
+    sf::RenderTarget& sceneTarget = context.scene ? static_cast<sf::RenderTarget&>(*context.scene) : target;
+    renderRaycaster<Backend>(sceneTarget, context, view, world, alpha,
+                             world.simTime + (alpha - 1.0f) * world.timestep);
+    
+    // Scale the view's corner of the scene target up to the window
+    if (context.scene) {
+        context.scene->display();
+        const sf::Vector2i size(static_cast<int>(context.viewWidth()), static_cast<int>(context.viewHeight()));
+        sf::Sprite upscaled(context.scene->getTexture(), sf::IntRect({0, 0}, size));
+        upscaled.setScale({static_cast<float>(context.output.x) / size.x,
+                           static_cast<float>(context.output.y) / size.y});
+        target.draw(upscaled);
+    }
+    drawHud(target, world, hud, fps, viewer);
+}
+
+template void drawPlayView<VertexArrayBackend>(sf::RenderTarget&, RenderContext&, const GameWorld&, Hud&, int,
+                                               float, int, const Player*);
+template void drawPlayView<FramebufferBackend>(sf::RenderTarget&, RenderContext&, const GameWorld&, Hud&, int,
+                                               float, int, const Player*);
+template void drawPlayView<ShapeBackend>(sf::RenderTarget&, RenderContext&, const GameWorld&, Hud&, int,
+                                         float, int, const Player*);
+
+void drawPlayView(sf::RenderTarget& target, RenderContext& context, const GameWorld& world,
+                  Hud& hud, int fps, float alpha, int viewer, const Player* predicted) {
+    switch (context.mode) {
+        case RenderMode::Batched:
+            drawPlayView<VertexArrayBackend>(target, context, world, hud, fps, alpha, viewer, predicted);
+            break;
+        case RenderMode::Software:
+            drawPlayView<FramebufferBackend>(target, context, world, hud, fps, alpha, viewer, predicted);
+            break;
+        case RenderMode::Shapes:
+            drawPlayView<ShapeBackend>(target, context, world, hud, fps, alpha, viewer, predicted);
+            break;
+    }
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "dynamic_resolution.hpp"
+#include "engine_config.hpp"
+#include "framebuffer.hpp"
+#include "game_world.hpp"
+#include "hud.hpp"
+#include "interlaced_cast.hpp"
+#include "ray_packet.hpp"
+#include "sprite_order.hpp"
+#include "surface_caster.hpp"
+#include "worker_pool.hpp"
+
+// ===========================================
+// RAYCASTING RENDERER
+// The 3D view over one of three backends: batched vertex arrays, the
+// software framebuffer and plain RectangleShapes. The backend is a
+// template parameter of the cast loop, so each gets its own copy of the
+// loop with its column writer inlined into it; nothing is dispatched per
+// column or per sprite. drawPlayView is built for all three here.
+// ===========================================
+
+// One sprite of a frame, projected into the view. texRect spans its full
+// width (left to left + width) and the already clipped rows top..bottom.
+struct SpriteItem {
+    const sf::Texture* texture; // null for a flat colour
+    sf::Color color;
+    sf::FloatRect texRect;
+    double depth;               // along the view, as in the zBuffer
+    int left, width;
+    int top, bottom;
+    sf::IntRect opaque;         // view pixels it hides completely
+    std::size_t firstVertex = 0, vertexCount = 0;
+};
+
+// Consecutive sprites sharing a texture, drawn with one call
+struct SpriteDraw {
+    const sf::Texture* texture;
+    std::size_t first, count;
+};
+
+// Sprites a frame holds before its lists grow
+constexpr std::size_t SPRITE_CAPACITY = 1024;
+
+// Geometry reused across frames. clear() keeps the vertex storage, so
+// after the first frame building the view allocates nothing, and neither
+// does a smaller view from setView. The background goes out in two draw
+// calls, the flat ceiling and floor and then every wall column over the
+// wall texture. Sprites follow far to near, one call per run of them
+// sharing a texture. Wall slots are fixed (column x owns quad x + 2) so
+// columns can be written from any thread.
+struct RenderBatches {
+    unsigned int width, height; // view size in pixels
+    sf::VertexArray walls{sf::PrimitiveType::Triangles};
+    std::vector<double> zBuffer;
+    std::vector<SpriteItem> sprites;        // in the order they were added
+    std::vector<std::uint64_t> spriteOrder; // sort entries into sprites, near to far once sorted
+    std::vector<std::uint64_t> sortScratch;
+    std::vector<sf::Vertex> spriteRuns;     // surviving columns, near to far
+    std::vector<sf::Vertex> spriteVertices; // the same runs, far to near
+    std::vector<SpriteDraw> spriteDraws;
+    ColumnCoverage coverage;
+    
+    RenderBatches(unsigned int viewWidth, unsigned int viewHeight)
+        : width(viewWidth), height(viewHeight), zBuffer(viewWidth) {
+        // 2 background quads + one quad per column, 6 vertices each
+        walls.resize((width + 2) * 6);
+        sprites.reserve(SPRITE_CAPACITY);
+        spriteOrder.reserve(SPRITE_CAPACITY);
+        sortScratch.reserve(SPRITE_CAPACITY);
+        spriteDraws.reserve(SPRITE_CAPACITY);
+        spriteRuns.reserve(SPRITE_CAPACITY * 6);
+        spriteVertices.reserve(SPRITE_CAPACITY * 6);
+    }
+    
+    // Up to the size constructed with
+    void setView(unsigned int viewWidth, unsigned int viewHeight) {
+        width = viewWidth;
+        height = viewHeight;
+        zBuffer.resize(width);
+        walls.resize((width + 2) * 6);
+    }
+    
+    void clearSprites() {
+        sprites.clear();
+        spriteOrder.clear();
+    }
+    
+    // Adds a sprite squaredDistance from the camera
+    void addSprite(const SpriteItem& sprite, double squaredDistance) {
+        spriteOrder.push_back(sortEntry(distanceKey(static_cast<float>(squaredDistance)),
+                                        static_cast<std::uint32_t>(sprites.size())));
+        sprites.push_back(sprite);
+    }
+};
+
+// 16x16 tiles of res/textures/world.png that surface the walls, floor and
+// ceiling, by tile column and row
+constexpr int SURFACE_TILE = 16;
+constexpr sf::Vector2i WALL_TILE{2, 1};     // brick
+constexpr sf::Vector2i FLOOR_TILE{5, 2};    // diamond flagstones
+constexpr sf::Vector2i CEILING_TILE{9, 1};  // parquet
+
+inline sf::IntRect surfaceTile(sf::Vector2i tile) {
+    return {{tile.x * SURFACE_TILE, tile.y * SURFACE_TILE}, {SURFACE_TILE, SURFACE_TILE}};
+}
+
+// Interlaced casting casts frames in full after a turn wider than a
+// 50-pixel mouse flick, about a tenth of a radian
+constexpr double INTERLACE_MAX_TURN = 50 * MOUSE_SENSITIVITY;
+
+// Internal render size for a config: the window scaled by renderScale
+sf::Vector2u renderSize(const EngineConfig& config);
+
+// Rows of the entities a frame may draw, and the slots of the players
+struct VisibleEntities {
+    std::vector<int> enemies, pickups, projectiles, particles;
+    std::vector<int> players;
+};
+
+// The live entities in regions the camera's region can see, or all of them
+// without a PVS. Enemies and pickups come out of the index buckets under the
+// visible regions, so their cost follows what is visible rather than what
+// exists; shots, effects, dying enemies and players are few, and are
+// tested one by one. The viewer's own player is left out.
+void gatherVisible(VisibleEntities& out, const GameWorld& world, const Player& view, int viewer);
+
+// Players' colours by slot, DOOM's green, indigo, brown and red
+inline const std::array<sf::Color, MAX_PLAYERS> PLAYER_COLORS = {
+    sf::Color(0x44, 0xAA, 0x44), sf::Color(0x60, 0x60, 0xB0), sf::Color(0x9C, 0x6C, 0x3C), sf::Color(0xC0, 0x30, 0x30)};
+
+// One wall column as the shapes backend draws it: the unclipped span in
+// view rows, the tile column it shows and its shade
+struct WallSlice {
+    float top, height;
+    int texelX;
+    sf::Color color;
+};
+
+// Renderer state owned by the front end and reused every frame, made for
+// one backend. The software path keeps the surfaces as palette indices
+// behind one colormap.
+//
+// The view is rendered at its own resolution. When that differs from the
+// window, or can change under dynamic resolution, the view goes to an
+// offscreen scene target sized for the largest view, and is scaled up to
+// the window afterwards. Every buffer is sized for the largest view once,
+// so resizing the view allocates nothing.
+struct RenderContext {
+    sf::Vector2u output;                      // window size
+    RenderMode mode;                          // the backend it was made for
+    RenderBatches batches;
+    std::unique_ptr<Framebuffer> framebuffer; // set in software mode
+    std::vector<WallSlice> wallSlices;        // set in shapes mode
+    WorkerPool workers;
+    RayIsa rayIsa;
+    std::vector<RayHit> hits;
+    Colormap colormap;
+    IndexedColumns wallTexels, floorTexels, ceilingTexels;
+    RowTables floorRows;
+    std::unique_ptr<sf::RenderTexture> scene;         // null when drawing straight to the window
+    std::unique_ptr<ResolutionController> resolution; // set for dynamic resolution
+    std::unique_ptr<InterlacedCaster> interlace;      // set for interlaced casting
+    VisibleEntities visible;                          // gathered for each frame
+    
+    explicit RenderContext(const EngineConfig& config);
+    
+    unsigned int viewWidth() const { return batches.width; }
+    unsigned int viewHeight() const { return batches.height; }
+    
+    void setView(unsigned int width, unsigned int height) {
+        batches.setView(width, height);
+        if (framebuffer) framebuffer->setViewport(width, height);
+    }
+    
+    // Feeds one frame's time to dynamic resolution, resizing the view when
+    // it asks to
+    void adaptResolution(double frameMs) {
+        if (resolution && resolution->update(frameMs)) setView(resolution->width(), resolution->height());
+    }
+    
+    // Cuts the surface tiles out of the world tileset; a missing tileset
+    // leaves the old flat colours
+    void setSurfaces(const sf::Image& tileset);
+};
+
+// The camera the packet kernels cast from
+RayCamera rayCamera(const Player& player);
+
+// Casts the ray for screen column x until it hits a wall or leaves the map.
+// Scalar reference path the SIMD kernels are checked against. Rays start on
+// an empty cell and move one cell per step, so the wall border stops them
+// before they can leave the map.
+RayHit castRay(const Player& player, const TileMap& map, int screenWidth, int x);
+
+// The camera alpha of the way from one tick's pose to the next. Direction
+// turns through the smaller angle and the plane stays perpendicular, so the
+// field of view does not shrink mid-turn.
+Player interpolatedView(const Player& previous, const Player& current, float alpha);
+
+// Renderer backends, each a set of static hooks the cast loop calls:
+// background before any column is cast, column from the worker that cast
+// column x (drawStart and drawEnd unclipped), present once every column
+// is in, and sprites for the frame's sorted sprite list. A context must be
+// made for the backend's MODE.
+
+// Ceiling and floor as two flat quads and every wall column as a quad over
+// the wall texture, in two draw calls; sprites in one call per texture run
+struct VertexArrayBackend {
+    static constexpr RenderMode MODE = RenderMode::Batched;
+    static void background(RenderContext& context, const RayCamera& cam);
+    static void column(RenderContext& context, int x, const RayHit& hit, int lineHeight,
+                       int drawStart, int drawEnd, bool textured);
+    static void present(sf::RenderTarget& target, RenderContext& context, const sf::Texture& wallTexture);
+    static void sprites(sf::RenderTarget& target, RenderBatches& batches);
+};
+
+// Textured floor, ceiling and walls rasterized on the workers into the
+// context's framebuffer, uploaded as one sprite; sprites batched as above
+struct FramebufferBackend {
+    static constexpr RenderMode MODE = RenderMode::Software;
+    static void background(RenderContext& context, const RayCamera& cam);
+    static void column(RenderContext& context, int x, const RayHit& hit, int lineHeight,
+                       int drawStart, int drawEnd, bool textured);
+    static void present(sf::RenderTarget& target, RenderContext& context, const sf::Texture& wallTexture);
+    static void sprites(sf::RenderTarget& target, RenderBatches& batches);
+};
+
+// A RectangleShape per wall column and per visible sprite run, as the
+// first raycasters here drew; a draw call each, so a reference for the
+// others rather than a way to play at high resolutions
+struct ShapeBackend {
+    static constexpr RenderMode MODE = RenderMode::Shapes;
+    static void background(RenderContext& context, const RayCamera& cam);
+    static void column(RenderContext& context, int x, const RayHit& hit, int lineHeight,
+                       int drawStart, int drawEnd, bool textured);
+    static void present(sf::RenderTarget& target, RenderContext& context, const sf::Texture& wallTexture);
+    static void sprites(sf::RenderTarget& target, RenderBatches& batches);
+};
+
+// The status bar over the view, for player viewer
+void drawHud(sf::RenderTarget& target, const GameWorld& world, Hud& hud, int fps, int viewer);
+
+// The 3D view through player viewer's eyes with its status bar over it,
+// alpha of a tick past the previous tick's state, or from predicted when
+// the caller has moved the camera on itself. Backend is one of the three
+// above, the one context was made for.
+template <class Backend>
+void drawPlayView(sf::RenderTarget& target, RenderContext& context, const GameWorld& world,
+                  Hud& hud, int fps, float alpha, int viewer = 0, const Player* predicted = nullptr);
+
+// As above, with the backend context was made for
+void drawPlayView(sf::RenderTarget& target, RenderContext& context, const GameWorld& world,
+                  Hud& hud, int fps, float alpha, int viewer = 0, const Player* predicted = nullptr);
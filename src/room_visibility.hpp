@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "dungeon_gen.hpp"
+#include "tile_map.hpp"
+#include "worker_pool.hpp"
+
+// ===========================================
+// ROOM VISIBILITY
+// A potentially visible set (PVS) over the regions of a generated dungeon,
+// built once after generation. Every room is a region. Corridor cells
+// outside the rooms are split into regions of at most CORRIDOR_BLOCK
+// tiles on a side, so a long corridor does not make everything it passes
+// visible at once. Neighbouring regions share an edge.
+//
+// A region sees the regions that rays cast from each of its cells reach.
+// The rays are spread evenly in angle and rotated from cell to cell, so
+// together they leave no wide gaps. The result is then made symmetric and
+// widened by one ring of neighbours, so an entity just past a door edge,
+// or a player off a cell's centre, is still kept. Everything is
+// deterministic, on any number of threads, so the simulation can depend
+// on it. A built PVS can be saved as its parts and rebuilt from them
+// without casting again.
+//
+// Each region keeps a sorted list of the regions it sees. A region sees
+// only a handful of others past its walls, so the lists grow with the
+// number of regions, not its square, and so does every pass over them.
+// ===========================================
+
+class RoomVisibility {
+public:
+    static constexpr int None = -1;
+    static constexpr int CORRIDOR_BLOCK = 8; // tiles
+    static constexpr int RAYS_PER_CELL = 64;
+
+    struct Bounds {
+        int minX, minY, maxX, maxY; // inclusive tiles
+    };
+
+    RoomVisibility(const TileMap& map, const std::vector<Room>& rooms, WorkerPool* workers = nullptr)
+        : m_width(map.width()), m_height(map.height()),
+          m_regions(static_cast<std::size_t>(m_width) * m_height, None) {
+        labelRooms(map, rooms);
+        labelCorridors(map);
+        findNeighbours();
+
+        // Each region writes only its own list
+        m_visible.assign(m_bounds.size(), {});
+        sortCells();
+        auto cast = [&](int begin, int end) {
+            std::vector<int> listedFor(m_bounds.size(), None);
+            for (int region = begin; region < end; region++) castFrom(map, region, listedFor);
+        };
+        if (workers) {
+            workers->parallelFor(regionCount(), cast);
+        } else {
+            cast(0, regionCount());
+        }
+
+        // Only the casts walk the cells
+        m_cells = {};
+        m_firstCell = {};
+
+        symmetrise();
+        widen();
+        symmetrise();
+    }
+
+    // The parts of a PVS built for a map of width x height, as saved from
+    // tileRegions(), allBounds(), roomRegions() and visibleLists(): region
+    // r sees visible[firstVisible[r] .. firstVisible[r + 1])
+    RoomVisibility(int width, int height, std::vector<int> regions, std::vector<Bounds> bounds, int roomRegions,
+                   const std::uint64_t* firstVisible, const int* visible)
+        : m_width(width), m_height(height), m_regions(std::move(regions)), m_bounds(std::move(bounds)),
+          m_roomRegions(roomRegions) {
+        findNeighbours();
+        m_visible.resize(m_bounds.size());
+        for (std::size_t r = 0; r < m_bounds.size(); r++) {
+            m_visible[r].assign(visible + firstVisible[r], visible + firstVisible[r + 1]);
+        }
+    }
+
+    // What the parts above must hold to describe a PVS of width x height:
+    // every list in order, without repeats, and naming regions that exist
+    static bool partsFit(int width, int height, const int* regions, std::size_t regionTiles, std::size_t regionCount,
+                         int roomRegions, const std::uint64_t* firstVisible, std::size_t firstCount,
+                         const int* visible, std::size_t visibleCount) {
+        if (regionTiles != static_cast<std::size_t>(width) * height || roomRegions < 0 ||
+            static_cast<std::size_t>(roomRegions) > regionCount || firstCount != regionCount + 1 ||
+            firstVisible[0] != 0 || firstVisible[regionCount] != visibleCount) {
+            return false;
+        }
+        const bool tilesFit = std::all_of(regions, regions + regionTiles, [&](int region) {
+            return region >= None && region < static_cast<int>(regionCount);
+        });
+        if (!tilesFit) return false;
+        for (std::size_t r = 0; r < regionCount; r++) {
+            if (firstVisible[r] > firstVisible[r + 1] || firstVisible[r + 1] > visibleCount) return false;
+            for (std::uint64_t i = firstVisible[r]; i < firstVisible[r + 1]; i++) {
+                if (visible[i] < 0 || visible[i] >= static_cast<int>(regionCount) ||
+                    (i > firstVisible[r] && visible[i] <= visible[i - 1])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    int regionCount() const { return static_cast<int>(m_bounds.size()); }
+
+    // None for walls and anything outside the map
+    int regionAt(int x, int y) const {
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height) return None;
+        return m_regions[static_cast<std::size_t>(y) * m_width + x];
+    }
+
+    int regionAt(double x, double y) const {
+        return regionAt(static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)));
+    }
+
+    // Conservatively true when either side is None
+    bool visible(int from, int to) const {
+        if (from == None || to == None) return true;
+        return std::binary_search(m_visible[from].begin(), m_visible[from].end(), to);
+    }
+
+    // Regions visible from region, itself included, in increasing order
+    const std::vector<int>& visibleFrom(int region) const { return m_visible[region]; }
+
+    const std::vector<int>& neighbours(int region) const { return m_neighbours[region]; }
+    const Bounds& bounds(int region) const { return m_bounds[region]; }
+    bool isRoom(int region) const { return region < m_roomRegions; }
+
+    const std::vector<int>& tileRegions() const { return m_regions; }
+    const std::vector<Bounds>& allBounds() const { return m_bounds; }
+    int roomRegions() const { return m_roomRegions; }
+
+    // Every region's visible list back to back, with where each starts and
+    // one past the last, for saving
+    void visibleLists(std::vector<std::uint64_t>& firstVisible, std::vector<std::int32_t>& visible) const {
+        firstVisible.assign(1, 0);
+        visible.clear();
+        for (const auto& list : m_visible) {
+            visible.insert(visible.end(), list.begin(), list.end());
+            firstVisible.push_back(visible.size());
+        }
+    }
+
+    // Ordered region pairs that can see each other, self pairs included
+    std::size_t visiblePairs() const {
+        std::size_t pairs = 0;
+        for (const auto& list : m_visible) pairs += list.size();
+        return pairs;
+    }
+
+private:
+    int& cell(int x, int y) { return m_regions[static_cast<std::size_t>(y) * m_width + x]; }
+
+    void grow(int region, int x, int y) {
+        Bounds& b = m_bounds[region];
+        b.minX = std::min(b.minX, x);
+        b.minY = std::min(b.minY, y);
+        b.maxX = std::max(b.maxX, x);
+        b.maxY = std::max(b.maxY, y);
+    }
+
+    void labelRooms(const TileMap& map, const std::vector<Room>& rooms) {
+        for (const Room& room : rooms) {
+            const int region = static_cast<int>(m_bounds.size());
+            m_bounds.push_back({room.x, room.y, room.x, room.y});
+            for (int y = std::max(room.y, 0); y < std::min(room.y + room.h, m_height); y++) {
+                for (int x = std::max(room.x, 0); x < std::min(room.x + room.w, m_width); x++) {
+                    if (map.at(x, y) != TileType::Empty || cell(x, y) != None) continue;
+                    cell(x, y) = region;
+                    grow(region, x, y);
+                }
+            }
+        }
+        m_roomRegions = static_cast<int>(m_bounds.size());
+    }
+
+    // 4-connected flood fill of the remaining empty cells, clipped to blocks
+    void labelCorridors(const TileMap& map) {
+        std::vector<int> stack;
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) {
+                if (map.at(x, y) != TileType::Empty || cell(x, y) != None) continue;
+                const int region = static_cast<int>(m_bounds.size());
+                const int blockX = x / CORRIDOR_BLOCK, blockY = y / CORRIDOR_BLOCK;
+                m_bounds.push_back({x, y, x, y});
+                cell(x, y) = region;
+                stack.push_back(y * m_width + x);
+                while (!stack.empty()) {
+                    const int cx = stack.back() % m_width, cy = stack.back() / m_width;
+                    stack.pop_back();
+                    grow(region, cx, cy);
+                    const int next[4][2] = {{cx + 1, cy}, {cx - 1, cy}, {cx, cy + 1}, {cx, cy - 1}};
+                    for (const auto& n : next) {
+                        if (regionAt(n[0], n[1]) != None || !map.contains(n[0], n[1]) ||
+                            map.at(n[0], n[1]) != TileType::Empty || n[0] / CORRIDOR_BLOCK != blockX ||
+                            n[1] / CORRIDOR_BLOCK != blockY) continue;
+                        cell(n[0], n[1]) = region;
+                        stack.push_back(n[1] * m_width + n[0]);
+                    }
+                }
+            }
+        }
+    }
+
+    void findNeighbours() {
+        m_neighbours.assign(m_bounds.size(), {});
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) {
+                const int here = regionAt(x, y);
+                if (here == None) continue;
+                for (int other : {regionAt(x + 1, y), regionAt(x, y + 1)}) {
+                    if (other == None || other == here) continue;
+                    // Skips the common run along one boundary; the rest
+                    // goes at the sort below
+                    if (!m_neighbours[here].empty() && m_neighbours[here].back() == other) continue;
+                    m_neighbours[here].push_back(other);
+                    m_neighbours[other].push_back(here);
+                }
+            }
+        }
+        for (auto& list : m_neighbours) {
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+        }
+    }
+
+    // Cells grouped by region, region r at m_cells[m_firstCell[r] .. m_firstCell[r + 1])
+    void sortCells() {
+        m_firstCell.assign(m_bounds.size() + 1, 0);
+        for (int region : m_regions) {
+            if (region != None) m_firstCell[region + 1]++;
+        }
+        for (std::size_t r = 0; r < m_bounds.size(); r++) m_firstCell[r + 1] += m_firstCell[r];
+        m_cells.resize(m_firstCell.back());
+        std::vector<std::size_t> next(m_firstCell.begin(), m_firstCell.end() - 1);
+        for (std::size_t i = 0; i < m_regions.size(); i++) {
+            if (m_regions[i] != None) m_cells[next[m_regions[i]]++] = static_cast<int>(i);
+        }
+    }
+
+    // Walks rays out of every cell of region through the grid until they
+    // meet a wall, listing every region they pass through. listedFor[r] is
+    // the last region whose list r went into, so each goes in once.
+    void castFrom(const TileMap& map, int region, std::vector<int>& listedFor) {
+        std::vector<int>& seen = m_visible[region];
+        auto see = [&](int other) {
+            if (listedFor[other] == region) return;
+            listedFor[other] = region;
+            seen.push_back(other);
+        };
+        see(region);
+        for (int other : m_neighbours[region]) see(other);
+        constexpr double TAU = 6.283185307179586;
+        constexpr double GOLDEN = 0.6180339887498949;
+        for (std::size_t i = m_firstCell[region]; i < m_firstCell[region + 1]; i++) {
+            const int startX = m_cells[i] % m_width, startY = m_cells[i] / m_width;
+            const double turn = std::fmod(i * GOLDEN, 1.0);
+            for (int ray = 0; ray < RAYS_PER_CELL; ray++) {
+                const double angle = (ray + turn) * (TAU / RAYS_PER_CELL);
+                const double dx = std::cos(angle), dy = std::sin(angle);
+                int x = startX, y = startY;
+                const int stepX = dx < 0 ? -1 : 1, stepY = dy < 0 ? -1 : 1;
+                const double deltaX = dx != 0 ? std::abs(1 / dx) : 1e30;
+                const double deltaY = dy != 0 ? std::abs(1 / dy) : 1e30;
+                double nextX = 0.5 * deltaX, nextY = 0.5 * deltaY;
+                while (true) {
+                    if (nextX < nextY) {
+                        nextX += deltaX;
+                        x += stepX;
+                    } else {
+                        nextY += deltaY;
+                        y += stepY;
+                    }
+                    if (map.blocks(x, y)) break;
+                    const int here = regionAt(x, y);
+                    if (here != None) see(here);
+                }
+            }
+        }
+        sortList(seen);
+    }
+
+    static void sortList(std::vector<int>& list) {
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        list.shrink_to_fit();
+    }
+
+    // Adds b sees a for every a sees b. Going through a in order appends
+    // to each reverse list in order, so both sides merge already sorted.
+    void symmetrise() {
+        std::vector<std::vector<int>> seenBy(m_visible.size());
+        for (int a = 0; a < regionCount(); a++) {
+            for (int b : m_visible[a]) seenBy[b].push_back(a);
+        }
+        std::vector<int> merged;
+        for (std::size_t b = 0; b < m_visible.size(); b++) {
+            merged.clear();
+            std::set_union(m_visible[b].begin(), m_visible[b].end(), seenBy[b].begin(), seenBy[b].end(),
+                           std::back_inserter(merged));
+            m_visible[b].assign(merged.begin(), merged.end());
+            seenBy[b] = {};
+        }
+    }
+
+    // Adds every neighbour of every region a region sees
+    void widen() {
+        std::vector<int> wider;
+        for (std::size_t a = 0; a < m_visible.size(); a++) {
+            wider = m_visible[a];
+            for (int b : m_visible[a]) wider.insert(wider.end(), m_neighbours[b].begin(), m_neighbours[b].end());
+            sortList(wider);
+            m_visible[a].assign(wider.begin(), wider.end());
+        }
+    }
+
+    int m_width, m_height;
+    std::vector<int> m_regions; // per tile
+    std::vector<Bounds> m_bounds;
+    int m_roomRegions = 0;      // rooms come first
+    std::vector<std::vector<int>> m_neighbours;
+    std::vector<std::vector<int>> m_visible; // sorted
+    std::vector<std::size_t> m_firstCell;
+    std::vector<int> m_cells;
+};
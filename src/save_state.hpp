@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ===========================================
+// SAVE FILES
+// A level and the state of play on it, laid out to be memory-mapped and
+// read in place. Nothing is parsed. A fixed header holds the settings the
+// level was made under and a table of sections. Each section is an array
+// of fixed-size little-endian records, starting on a SAVE_ALIGN boundary,
+// so it can be read through a pointer straight into the mapping. Opening
+// a save checks the magic, the version and that every section lies inside
+// the file, and nothing more.
+//
+// The tile section is the map's own storage, border and padding included.
+// A map of the same shape takes it in one copy, in whichever layout it was
+// saved.
+// ===========================================
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "Save files are read in place and are little-endian"
+#endif
+
+constexpr std::size_t SAVE_ALIGN = 16;
+
+enum class SaveSection : std::uint32_t {
+    Tiles,        // bytes of the map's storage
+    Rooms,        // SaveRoom
+    Player,       // SavePlayer, by slot
+    Enemies,      // SaveEnemy, by row
+    EnemyOrder,   // u32 rows in spatial hash bucket order, see below
+    Pickups,      // SavePickup, by row
+    PickupOrder,  // u32, as EnemyOrder
+    Projectiles,  // SaveProjectile
+    Particles,    // SaveParticle
+    VisibilityRegions, // i32 region per map cell, row-major, of the level's PVS
+    VisibilityBounds,  // SaveBounds per region
+    VisibilityFirst,   // u64 start of each region's list in VisibilityList, and its end
+    VisibilityList,    // i32 regions each region sees, in order, list after list
+    Count
+};
+
+// The visibility sections are empty when the level has no PVS; the
+// header's visibilityRooms says how many regions, from the first, are
+// rooms. Loading them skips the ray casts, the slowest part of a load.
+//
+// The order lists hold every indexed row, bucket by bucket and head to
+// tail within one. Inserting them again in reverse rebuilds each bucket in
+// the same order, so queries visit entities as they did when saved and the
+// session plays on exactly.
+
+struct SaveArea {
+    std::uint64_t offset; // from the start of the file
+    std::uint64_t count;  // records
+};
+
+struct SaveHeader {
+    char magic[4];
+    std::uint16_t version;
+    std::uint16_t tickRate;
+    std::uint64_t seed;
+    std::int32_t mapWidth, mapHeight;
+    std::int32_t mapBorder;
+    std::uint32_t flags;       // SaveFlag bits
+    double simTime;            // seconds played
+    std::uint32_t reserved;
+    std::int32_t visibilityRooms;
+    SaveArea sections[static_cast<std::size_t>(SaveSection::Count)];
+};
+
+namespace SaveFlag {
+enum : std::uint32_t {
+    Morton = 1 << 0, // tiles are in Z-order
+};
+} // namespace SaveFlag
+
+struct SaveRoom {
+    std::int32_t x, y, w, h;
+};
+
+struct SaveBounds {
+    std::int32_t minX, minY, maxX, maxY;
+};
+
+struct SavePlayer {
+    double posX, posY, dirX, dirY, planeX, planeY, momX, momY;
+    std::int32_t health, maxHealth, ammo, score, kills;
+    float shotCooldown;
+};
+
+struct SaveEnemy {
+    double x, y, dirX, dirY;
+    float speed, attackCooldown, animTime;
+    std::int32_t health, maxHealth;
+    std::uint8_t type, active, variant, anim;
+};
+
+struct SavePickup {
+    double x, y;
+    std::int32_t value;
+    std::uint8_t type, active;
+    std::uint8_t reserved[2];
+};
+
+struct SaveProjectile {
+    double x, y, velX, velY;
+    float timeLeft;
+    std::int32_t damage;
+    std::uint8_t shooter; // slot + 1, 0 for none
+    std::uint8_t reserved[7];
+};
+
+struct SaveParticle {
+    double x, y, z, velX, velY, velZ, gravity;
+    float timeLeft, lifetime, size;
+    std::uint8_t effect; // the caller's numbering
+    std::uint8_t reserved[3];
+};
+
+static_assert(sizeof(SaveHeader) == 48 + 16 * static_cast<std::size_t>(SaveSection::Count));
+static_assert(sizeof(SavePlayer) == 88 && sizeof(SaveEnemy) == 56 && sizeof(SavePickup) == 24 &&
+              sizeof(SaveProjectile) == 48 && sizeof(SaveParticle) == 72, "save records are read in place");
+
+// Records of one section, pointing into the mapped file
+template <typename T>
+struct SaveArray {
+    const T* data = nullptr;
+    std::size_t count = 0;
+
+    const T* begin() const { return data; }
+    const T* end() const { return data + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](std::size_t i) const { return data[i]; }
+};
+
+// Builds a save in memory, then writes it in one go
+class SaveWriter {
+public:
+    // 2: one player record per slot, each with its shot cooldown
+    // 3: the PVS as sorted per-region lists rather than a bit matrix
+    static constexpr std::uint16_t VERSION = 3;
+
+    explicit SaveWriter(std::size_t expectedBytes = 0) : m_bytes(sizeof(SaveHeader), 0) {
+        m_bytes.reserve(sizeof(SaveHeader) + expectedBytes);
+        std::memcpy(m_header.magic, MAGIC, 4);
+        m_header.version = VERSION;
+    }
+
+    // Fields other than magic, version and sections
+    SaveHeader& header() { return m_header; }
+
+    template <typename T>
+    void section(SaveSection id, const T* records, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "save records are raw bytes");
+        m_bytes.resize((m_bytes.size() + SAVE_ALIGN - 1) / SAVE_ALIGN * SAVE_ALIGN, 0);
+        m_header.sections[static_cast<std::size_t>(id)] = {m_bytes.size(), count};
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(records);
+        m_bytes.insert(m_bytes.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    template <typename T>
+    void section(SaveSection id, const std::vector<T>& records) { section(id, records.data(), records.size()); }
+
+    // Through a temporary file renamed over path, so a failed write never
+    // leaves half a save behind
+    bool write(const std::filesystem::path& path) {
+        std::memcpy(m_bytes.data(), &m_header, sizeof(SaveHeader));
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(m_bytes.data()), static_cast<std::streamsize>(m_bytes.size()));
+            if (!out) return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        return !error;
+    }
+
+    std::size_t bytes() const { return m_bytes.size(); }
+
+    static constexpr char MAGIC[4] = {'D', 'S', 'A', 'V'};
+
+private:
+    SaveHeader m_header{};
+    std::vector<std::uint8_t> m_bytes;
+};
+
+// A save opened for reading. Where the platform has mmap the file is
+// mapped read-only and the pages load as they are touched; elsewhere it is
+// read into memory whole.
+class SaveFile {
+public:
+    SaveFile() = default;
+    SaveFile(const SaveFile&) = delete;
+    SaveFile& operator=(const SaveFile&) = delete;
+    ~SaveFile() { close(); }
+
+    // False for a missing file, another format or version, or a section
+    // outside the file
+    bool open(const std::filesystem::path& path) {
+        close();
+        if (!map(path) || m_size < sizeof(SaveHeader)) {
+            close();
+            return false;
+        }
+        const SaveHeader& head = header();
+        if (std::memcmp(head.magic, SaveWriter::MAGIC, 4) != 0 || head.version != SaveWriter::VERSION) {
+            close();
+            return false;
+        }
+        for (const SaveArea& area : head.sections) {
+            if (area.offset % SAVE_ALIGN != 0 || area.offset > m_size) {
+                close();
+                return false;
+            }
+        }
+        m_valid = fits<std::uint8_t>(SaveSection::Tiles) && fits<SaveRoom>(SaveSection::Rooms) &&
+                  fits<SavePlayer>(SaveSection::Player) && fits<SaveEnemy>(SaveSection::Enemies) &&
+                  fits<std::uint32_t>(SaveSection::EnemyOrder) && fits<SavePickup>(SaveSection::Pickups) &&
+                  fits<std::uint32_t>(SaveSection::PickupOrder) && fits<SaveProjectile>(SaveSection::Projectiles) &&
+                  fits<SaveParticle>(SaveSection::Particles) &&
+                  fits<std::int32_t>(SaveSection::VisibilityRegions) &&
+                  fits<SaveBounds>(SaveSection::VisibilityBounds) &&
+                  fits<std::uint64_t>(SaveSection::VisibilityFirst) &&
+                  fits<std::int32_t>(SaveSection::VisibilityList);
+        if (!m_valid) close();
+        return m_valid;
+    }
+
+    bool isOpen() const { return m_valid; }
+    const SaveHeader& header() const { return *reinterpret_cast<const SaveHeader*>(m_data); }
+
+    template <typename T>
+    SaveArray<T> section(SaveSection id) const {
+        const SaveArea& area = header().sections[static_cast<std::size_t>(id)];
+        return {reinterpret_cast<const T*>(m_data + area.offset), static_cast<std::size_t>(area.count)};
+    }
+
+    std::size_t bytes() const { return m_size; }
+
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (m_mapped) munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+        m_buffer.clear();
+        m_buffer.shrink_to_fit();
+        m_data = nullptr;
+        m_size = 0;
+        m_mapped = false;
+        m_valid = false;
+    }
+
+private:
+    bool map(const std::filesystem::path& path) {
+#if defined(__unix__) || defined(__APPLE__)
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* data = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                m_data = static_cast<const std::uint8_t*>(data);
+                m_size = static_cast<std::size_t>(info.st_size);
+                m_mapped = true;
+            }
+        }
+        ::close(fd);
+        if (m_mapped) return true;
+#endif
+        // Still aligned for the records: vector storage comes from operator new
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        m_data = m_buffer.data();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    template <typename T>
+    bool fits(SaveSection id) const {
+        const SaveArea& area = header().sections[static_cast<std::size_t>(id)];
+        return area.count <= (m_size - area.offset) / sizeof(T);
+    }
+
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_mapped = false;
+    bool m_valid = false;
+    std::vector<std::uint8_t> m_buffer;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// ===========================================
+// SPATIAL HASH
+// Uniform grid with one bucket per map tile. Each bucket is an intrusive
+// doubly linked list of entity ids, so insert, remove and a move into another
+// tile are O(1), and a move within the same tile touches nothing. Queries
+// visit only the buckets under the query shape and compare squared
+// distances.
+// ===========================================
+
+class SpatialHash {
+public:
+    static constexpr int None = -1;
+
+    // Covers the width x height tile map; positions outside it are clamped
+    // into the edge buckets
+    SpatialHash(int width, int height)
+        : m_width(std::max(width, 1)), m_height(std::max(height, 1)),
+          m_heads(static_cast<std::size_t>(m_width) * m_height, None) {}
+
+    // id indexes the caller's entity array; ids need not be dense
+    void insert(int id, double x, double y) {
+        if (id >= static_cast<int>(m_entries.size())) m_entries.resize(static_cast<std::size_t>(id) + 1);
+        Entry& entry = m_entries[id];
+        if (entry.cell != None) unlink(id);
+        entry.x = x;
+        entry.y = y;
+        link(id, cellOf(x, y));
+    }
+
+    void update(int id, double x, double y) {
+        Entry& entry = m_entries[id];
+        entry.x = x;
+        entry.y = y;
+        int cell = cellOf(x, y);
+        if (cell != entry.cell) {
+            unlink(id);
+            link(id, cell);
+        }
+    }
+
+    void remove(int id) {
+        if (id < static_cast<int>(m_entries.size()) && m_entries[id].cell != None) unlink(id);
+    }
+
+    bool contains(int id) const {
+        return id >= 0 && id < static_cast<int>(m_entries.size()) && m_entries[id].cell != None;
+    }
+
+    void clear() {
+        std::fill(m_heads.begin(), m_heads.end(), None);
+        m_entries.clear();
+    }
+
+    // Calls fn(id, distanceSquared) for every entity within radius of (x, y).
+    // fn must not insert, update or remove while the query runs.
+    template <typename Fn>
+    void forEachInRadius(double x, double y, double radius, Fn&& fn) const {
+        const double radiusSq = radius * radius;
+        forEachInBox(x - radius, y - radius, x + radius, y + radius, [&](int id, const Entry& entry) {
+            double dx = entry.x - x;
+            double dy = entry.y - y;
+            double distSq = dx * dx + dy * dy;
+            if (distSq <= radiusSq) fn(id, distSq);
+        });
+    }
+
+    // Calls fn(id) for every entity in the tiles [x0, x1] x [y0, y1]
+    template <typename Fn>
+    void forEachInTiles(int x0, int y0, int x1, int y1, Fn&& fn) const {
+        forEachInBox(x0, y0, x1, y1, [&](int id, const Entry&) { fn(id); });
+    }
+
+    // First entity, by distance along the segment from (x0, y0) to (x1, y1),
+    // whose position lies within radius of the segment and which accept(id)
+    // admits. Returns None when nothing is hit.
+    template <typename Pred>
+    int firstOnSegment(double x0, double y0, double x1, double y1, double radius, Pred&& accept) const {
+        const double dx = x1 - x0;
+        const double dy = y1 - y0;
+        const double lengthSq = dx * dx + dy * dy;
+        const double radiusSq = radius * radius;
+
+        int best = None;
+        double bestT = 2.0;
+        forEachInBox(std::min(x0, x1) - radius, std::min(y0, y1) - radius,
+                     std::max(x0, x1) + radius, std::max(y0, y1) + radius,
+                     [&](int id, const Entry& entry) {
+            double px = entry.x - x0;
+            double py = entry.y - y0;
+            double t = lengthSq > 0 ? std::clamp((px * dx + py * dy) / lengthSq, 0.0, 1.0) : 0.0;
+            double ox = px - t * dx;
+            double oy = py - t * dy;
+            if (ox * ox + oy * oy <= radiusSq && t < bestT && accept(id)) {
+                best = id;
+                bestT = t;
+            }
+        });
+        return best;
+    }
+
+private:
+    struct Entry {
+        double x = 0, y = 0;
+        int cell = None;
+        int prev = None;
+        int next = None;
+    };
+
+    int clampX(double x) const { return std::clamp(static_cast<int>(std::floor(x)), 0, m_width - 1); }
+    int clampY(double y) const { return std::clamp(static_cast<int>(std::floor(y)), 0, m_height - 1); }
+    int cellOf(double x, double y) const { return clampY(y) * m_width + clampX(x); }
+
+    template <typename Fn>
+    void forEachInBox(double minX, double minY, double maxX, double maxY, Fn&& fn) const {
+        const int cx0 = clampX(minX), cx1 = clampX(maxX);
+        const int cy0 = clampY(minY), cy1 = clampY(maxY);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                for (int id = m_heads[static_cast<std::size_t>(cy) * m_width + cx]; id != None;) {
+                    const Entry& entry = m_entries[id];
+                    int next = entry.next;
+                    fn(id, entry);
+                    id = next;
+                }
+            }
+        }
+    }
+
+    void link(int id, int cell) {
+        Entry& entry = m_entries[id];
+        entry.cell = cell;
+        entry.prev = None;
+        entry.next = m_heads[cell];
+        if (entry.next != None) m_entries[entry.next].prev = id;
+        m_heads[cell] = id;
+    }
+
+    void unlink(int id) {
+        Entry& entry = m_entries[id];
+        if (entry.prev != None) {
+            m_entries[entry.prev].next = entry.next;
+        } else {
+            m_heads[entry.cell] = entry.next;
+        }
+        if (entry.next != None) m_entries[entry.next].prev = entry.prev;
+        entry.cell = entry.prev = entry.next = None;
+    }
+
+    int m_width;
+    int m_height;
+    std::vector<int> m_heads;
+    std::vector<Entry> m_entries;
+};
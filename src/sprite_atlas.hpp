@@ -0,0 +1,435 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asset_manager.hpp"
+#include "sprite_order.hpp"
+
+// ===========================================
+// SPRITE ATLAS
+// Every sprite frame packed into a few power-of-two pages at load, so one
+// texture bind covers a whole batch of sprites. Frames are asked for up
+// front, as an area of an image, and belong to a group drawn at one scale:
+// the group's largest frame side spans the sprite's square, and each frame
+// sits in that square at its own size, anchored at the bottom centre for
+// things that stand on the floor or at the centre for effects.
+//
+// Packing sorts the frames by height and fills shelves across a page, with
+// a transparent gutter so no frame samples its neighbour. The packed pages
+// and a table of the frames can be saved. A later start whose sources have
+// the same sizes and times loads those pages instead of decoding every
+// frame and packing it again.
+//
+// Table layout, little-endian: "SATL", u16 version, u64 stamp of the
+// sources, u32 page count, per page u16 width and height, u32 frame count,
+// then per frame an i16 page (-1 when it did not load), u16 x, y, width and
+// height on the page, and the u16 x, y, width and height of its opaque core.
+// ===========================================
+
+struct AtlasFrame {
+    const sf::Texture* page = nullptr; // null when the frame did not load
+    sf::IntRect rect;                  // on the page
+    sf::FloatRect box;                 // in the group's unit square, y down
+    sf::IntRect core;                  // largest fully opaque part, relative to rect
+};
+
+class SpriteAtlas {
+public:
+    enum class Anchor : std::uint8_t { Bottom, Centre };
+
+    static constexpr std::uint16_t VERSION = 1;
+    static constexpr unsigned int MAX_PAGE = 2048;
+    static constexpr unsigned int MIN_PAGE = 64;
+    static constexpr int GUTTER = 1;     // transparent pixels right of and below each frame
+    static constexpr int WHITE = 0;      // frame id of a solid white square, for flat colours
+    static constexpr int WHITE_SIZE = 4;
+
+    SpriteAtlas() {
+        m_groups.push_back(Anchor::Centre);
+        m_sources.push_back({{}, {}, 0});
+        m_frames.emplace_back();
+    }
+
+    SpriteAtlas(const SpriteAtlas&) = delete;
+    SpriteAtlas& operator=(const SpriteAtlas&) = delete;
+
+    // A new scale group; its frames are placed by anchor
+    int group(Anchor anchor) {
+        m_groups.push_back(anchor);
+        return static_cast<int>(m_groups.size()) - 1;
+    }
+
+    // Queues area of the image at path, or all of it for an empty area, as
+    // a frame of group; returns the frame's id. Only before request().
+    int add(int group, const std::filesystem::path& path, sf::IntRect area = {}) {
+        m_sources.push_back({path, area, group});
+        m_frames.emplace_back();
+        return static_cast<int>(m_frames.size()) - 1;
+    }
+
+    // Starts loading, once every frame is queued: the saved pages when
+    // cacheDir holds an atlas of the same sources, and otherwise every
+    // source image. An empty cacheDir neither loads nor saves.
+    void request(AssetManager& assets, const std::filesystem::path& cacheDir) {
+        m_cacheDir = cacheDir;
+        m_stamp = stampSources();
+        m_cached = !cacheDir.empty() && loadTable(tablePath());
+        if (m_cached) {
+            for (std::size_t page = 0; page < m_pageSizes.size(); page++) {
+                m_pages.push_back(&assets.texture(pagePath(page)));
+            }
+        } else {
+            requestSources(assets);
+        }
+    }
+
+    // Once the manager has finished: points the frames at the saved pages,
+    // or packs and uploads the sources, saving the result. A saved page that
+    // fails to load falls back to packing, waiting on the sources then.
+    void finish(AssetManager& assets) {
+        if (m_cached) {
+            bool loaded = true;
+            for (std::size_t page = 0; page < m_pages.size(); page++) {
+                loaded = loaded && assets.loaded(pagePath(page));
+            }
+            if (loaded) {
+                for (std::size_t id = 0; id < m_frames.size(); id++) {
+                    if (m_framePages[id] >= 0) m_frames[id].page = m_pages[m_framePages[id]];
+                }
+                layoutGroups();
+                return;
+            }
+            m_cached = false;
+            m_pages.clear();
+            requestSources(assets);
+            assets.waitAll();
+        }
+        pack(assets);
+        if (!m_cacheDir.empty() && !save()) {
+            std::cerr << "Could not save the sprite atlas to " << m_cacheDir.string() << "\n";
+        }
+        m_images.clear();
+    }
+
+    const AtlasFrame& frame(int id) const { return m_frames[id]; }
+    std::size_t frames() const { return m_frames.size(); }
+    std::size_t pages() const { return m_pages.size(); }
+    sf::Vector2u pageSize(std::size_t page) const { return m_pageSizes[page]; }
+
+    // True when the pages came from the cache rather than a fresh pack
+    bool cached() const { return m_cached; }
+
+    // Frames whose source failed to load or would not fit on a page
+    std::size_t missing() const {
+        std::size_t count = 0;
+        for (const AtlasFrame& frame : m_frames) count += frame.page == nullptr;
+        return count;
+    }
+
+    // Share of the page area covered by frames
+    double fill() const {
+        double used = 0, total = 0;
+        for (const AtlasFrame& frame : m_frames) {
+            if (frame.page) used += static_cast<double>(frame.rect.size.x) * frame.rect.size.y;
+        }
+        for (sf::Vector2u size : m_pageSizes) total += static_cast<double>(size.x) * size.y;
+        return total > 0 ? used / total : 0.0;
+    }
+
+private:
+    struct Source {
+        std::filesystem::path path; // empty for the white square
+        sf::IntRect area;
+        int group;
+    };
+
+    // Where a frame goes while packing
+    struct Placement {
+        int id;
+        sf::Vector2i size;
+        int page = -1;
+        sf::Vector2i position;
+    };
+
+    std::filesystem::path tablePath() const { return m_cacheDir / "sprites.atlas"; }
+
+    std::filesystem::path pagePath(std::size_t page) const {
+        return m_cacheDir / ("sprites" + std::to_string(page) + ".png");
+    }
+
+    void requestSources(AssetManager& assets) {
+        for (const Source& source : m_sources) {
+            if (!source.path.empty()) assets.image(source.path);
+        }
+    }
+
+    // Every source as asked for, with its size and time on disk
+    std::uint64_t stampSources() const {
+        std::uint64_t hash = 0xCBF29CE484222325ull;
+        auto mix = [&](std::uint64_t value) {
+            for (int i = 0; i < 8; i++) hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 0x100000001B3ull;
+        };
+        mix(VERSION);
+        mix(maxPage());
+        for (const Source& source : m_sources) {
+            for (char c : source.path.generic_string()) mix(static_cast<unsigned char>(c));
+            for (int value : {source.area.position.x, source.area.position.y, source.area.size.x, source.area.size.y}) {
+                mix(static_cast<std::uint32_t>(value));
+            }
+            mix(static_cast<std::uint64_t>(m_groups[source.group]));
+            if (source.path.empty()) continue;
+            std::error_code error;
+            const auto bytes = std::filesystem::file_size(source.path, error);
+            mix(error ? ~0ull : bytes);
+            const auto time = std::filesystem::last_write_time(source.path, error);
+            mix(error ? ~0ull : static_cast<std::uint64_t>(time.time_since_epoch().count()));
+        }
+        return hash;
+    }
+
+    static unsigned int maxPage() { return std::min(MAX_PAGE, sf::Texture::getMaximumSize()); }
+
+    static unsigned int powerOfTwo(double size) {
+        unsigned int side = MIN_PAGE;
+        while (side < size && side < MAX_PAGE) side *= 2;
+        return side;
+    }
+
+    // Packs every loaded source, trying one page at the smallest size that
+    // could hold them and doubling it until they fit, then spilling onto
+    // more pages of the largest size
+    void pack(AssetManager& assets) {
+        std::vector<Placement> placements;
+        double area = 0;
+        int widest = 0;
+        const int largest = static_cast<int>(maxPage());
+        for (std::size_t id = 0; id < m_sources.size(); id++) {
+            const Source& source = m_sources[id];
+            m_frames[id] = AtlasFrame();
+            sf::Vector2i size(WHITE_SIZE, WHITE_SIZE);
+            if (!source.path.empty()) {
+                if (!assets.loaded(source.path)) continue;
+                const sf::IntRect clipped = sourceArea(assets.image(source.path), source.area);
+                size = clipped.size;
+                if (size.x <= 0 || size.y <= 0) continue;
+            }
+            if (size.x + GUTTER > largest || size.y + GUTTER > largest) continue;
+            placements.push_back({static_cast<int>(id), size});
+            widest = std::max({widest, size.x + GUTTER, size.y + GUTTER});
+            area += static_cast<double>(size.x + GUTTER) * (size.y + GUTTER);
+        }
+        std::stable_sort(placements.begin(), placements.end(), [](const Placement& a, const Placement& b) {
+            return a.size.y != b.size.y ? a.size.y > b.size.y : a.size.x > b.size.x;
+        });
+
+        unsigned int side = std::min(powerOfTwo(std::max(std::sqrt(area), static_cast<double>(widest))),
+                                     static_cast<unsigned int>(largest));
+        while (shelve(placements, side, true) > 1 && side < static_cast<unsigned int>(largest)) side *= 2;
+        const int pageCount = shelve(placements, side, false);
+
+        // Each page keeps its width and drops the rows it does not use
+        m_pageSizes.assign(pageCount, {side, MIN_PAGE});
+        for (const Placement& placement : placements) {
+            if (placement.page < 0) continue;
+            sf::Vector2u& size = m_pageSizes[placement.page];
+            size.y = std::max(size.y, powerOfTwo(placement.position.y + placement.size.y + GUTTER));
+        }
+
+        std::vector<sf::Image> images;
+        for (sf::Vector2u size : m_pageSizes) images.emplace_back(size, sf::Color::Transparent);
+        const sf::Image white({WHITE_SIZE, WHITE_SIZE}, sf::Color::White);
+        for (const Placement& placement : placements) {
+            if (placement.page < 0) continue;
+            const Source& source = m_sources[placement.id];
+            AtlasFrame& frame = m_frames[placement.id];
+            frame.rect = sf::IntRect(placement.position, placement.size);
+            const sf::Vector2u at(static_cast<unsigned int>(placement.position.x),
+                                  static_cast<unsigned int>(placement.position.y));
+            if (source.path.empty()) {
+                (void)images[placement.page].copy(white, at);
+                frame.core = sf::IntRect({0, 0}, placement.size);
+            } else {
+                const sf::Image& image = assets.image(source.path);
+                const sf::IntRect area = sourceArea(image, source.area);
+                (void)images[placement.page].copy(image, at, area);
+                frame.core = opaqueCore(image, area);
+            }
+        }
+        for (const Source& source : m_sources) {
+            if (!source.path.empty()) assets.releaseImage(source.path);
+        }
+
+        m_pageTextures.clear();
+        m_pages.clear();
+        for (const sf::Image& image : images) {
+            auto texture = std::make_unique<sf::Texture>();
+            if (!texture->loadFromImage(image)) texture.reset();
+            m_pages.push_back(texture.get());
+            m_pageTextures.push_back(std::move(texture));
+        }
+        m_framePages.assign(m_frames.size(), -1);
+        for (const Placement& placement : placements) {
+            if (placement.page < 0 || !m_pages[placement.page]) continue;
+            m_framePages[placement.id] = placement.page;
+            m_frames[placement.id].page = m_pages[placement.page];
+        }
+        m_images = std::move(images);
+        layoutGroups();
+    }
+
+    // Shelf fill of side x side pages. With firstOnly, stops at the first
+    // frame that would need a second page; returns the pages used.
+    static int shelve(std::vector<Placement>& placements, unsigned int side, bool firstOnly) {
+        const int limit = static_cast<int>(side);
+        int page = 0, x = 0, y = 0, shelf = 0;
+        for (Placement& placement : placements) {
+            const int w = placement.size.x + GUTTER, h = placement.size.y + GUTTER;
+            if (x + w > limit) {
+                x = 0;
+                y += shelf;
+                shelf = 0;
+            }
+            if (y + h > limit) {
+                if (firstOnly) return page + 2;
+                page++;
+                x = y = shelf = 0;
+            }
+            placement.page = page;
+            placement.position = {x, y};
+            x += w;
+            shelf = std::max(shelf, h);
+        }
+        return placements.empty() ? 1 : page + 1;
+    }
+
+    // area clipped to the image, or all of it for an empty area
+    static sf::IntRect sourceArea(const sf::Image& image, sf::IntRect area) {
+        const sf::Vector2i size(static_cast<int>(image.getSize().x), static_cast<int>(image.getSize().y));
+        if (area.size.x <= 0 || area.size.y <= 0) return sf::IntRect({0, 0}, size);
+        const int left = std::max(area.position.x, 0), top = std::max(area.position.y, 0);
+        const int right = std::min(area.position.x + area.size.x, size.x);
+        const int bottom = std::min(area.position.y + area.size.y, size.y);
+        return sf::IntRect({left, top}, {std::max(right - left, 0), std::max(bottom - top, 0)});
+    }
+
+    // Boxes follow from the frame sizes, so the table need not hold them
+    void layoutGroups() {
+        std::vector<int> side(m_groups.size(), 0);
+        for (std::size_t id = 0; id < m_frames.size(); id++) {
+            const sf::IntRect& rect = m_frames[id].rect;
+            side[m_sources[id].group] = std::max({side[m_sources[id].group], rect.size.x, rect.size.y});
+        }
+        for (std::size_t id = 0; id < m_frames.size(); id++) {
+            AtlasFrame& frame = m_frames[id];
+            const int group = m_sources[id].group;
+            if (side[group] == 0) continue;
+            const float w = static_cast<float>(frame.rect.size.x) / side[group];
+            const float h = static_cast<float>(frame.rect.size.y) / side[group];
+            const float top = m_groups[group] == Anchor::Bottom ? 1 - h : (1 - h) / 2;
+            frame.box = sf::FloatRect({(1 - w) / 2, top}, {w, h});
+        }
+    }
+
+    bool save() const {
+        std::error_code error;
+        std::filesystem::create_directories(m_cacheDir, error);
+        for (std::size_t page = 0; page < m_images.size(); page++) {
+            if (!m_images[page].saveToFile(pagePath(page))) return false;
+        }
+
+        std::vector<std::uint8_t> bytes;
+        bytes.insert(bytes.end(), MAGIC, MAGIC + 4);
+        put(bytes, VERSION, 2);
+        put(bytes, m_stamp, 8);
+        put(bytes, m_pageSizes.size(), 4);
+        for (sf::Vector2u size : m_pageSizes) {
+            put(bytes, size.x, 2);
+            put(bytes, size.y, 2);
+        }
+        put(bytes, m_frames.size(), 4);
+        for (std::size_t id = 0; id < m_frames.size(); id++) {
+            const AtlasFrame& frame = m_frames[id];
+            put(bytes, static_cast<std::uint16_t>(m_framePages[id]), 2);
+            for (int value : {frame.rect.position.x, frame.rect.position.y, frame.rect.size.x, frame.rect.size.y,
+                              frame.core.position.x, frame.core.position.y, frame.core.size.x, frame.core.size.y}) {
+                put(bytes, static_cast<std::uint16_t>(value), 2);
+            }
+        }
+        std::ofstream out(tablePath(), std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(out);
+    }
+
+    // False for a missing table, another version, other sources, or a file cut short
+    bool loadTable(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (bytes.size() < HEADER_BYTES) return false;
+        for (int i = 0; i < 4; i++) {
+            if (bytes[i] != static_cast<std::uint8_t>(MAGIC[i])) return false;
+        }
+
+        std::size_t at = 4;
+        if (get(bytes, at, 2) != VERSION || get(bytes, at, 8) != m_stamp) return false;
+        const std::uint64_t pageCount = get(bytes, at, 4);
+        if (bytes.size() - at < pageCount * PAGE_BYTES + 4) return false;
+        std::vector<sf::Vector2u> pageSizes;
+        for (std::uint64_t page = 0; page < pageCount; page++) {
+            const auto width = static_cast<unsigned int>(get(bytes, at, 2));
+            pageSizes.push_back({width, static_cast<unsigned int>(get(bytes, at, 2))});
+        }
+        if (get(bytes, at, 4) != m_frames.size() || bytes.size() - at < m_frames.size() * FRAME_BYTES) return false;
+
+        std::vector<int> framePages(m_frames.size());
+        for (std::size_t id = 0; id < m_frames.size(); id++) {
+            framePages[id] = static_cast<std::int16_t>(static_cast<std::uint16_t>(get(bytes, at, 2)));
+            if (framePages[id] >= static_cast<int>(pageCount)) return false;
+            int values[8];
+            for (int& value : values) value = static_cast<int>(get(bytes, at, 2));
+            m_frames[id].rect = sf::IntRect({values[0], values[1]}, {values[2], values[3]});
+            m_frames[id].core = sf::IntRect({values[4], values[5]}, {values[6], values[7]});
+        }
+        m_pageSizes = std::move(pageSizes);
+        m_framePages = std::move(framePages);
+        return true;
+    }
+
+    static void put(std::vector<std::uint8_t>& bytes, std::uint64_t value, int size) {
+        for (int i = 0; i < size; i++) bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+
+    static std::uint64_t get(const std::vector<std::uint8_t>& bytes, std::size_t& at, int size) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < size; i++) value |= static_cast<std::uint64_t>(bytes[at++]) << (8 * i);
+        return value;
+    }
+
+    static constexpr char MAGIC[4] = {'S', 'A', 'T', 'L'};
+    static constexpr std::size_t HEADER_BYTES = 4 + 2 + 8 + 4;
+    static constexpr std::size_t PAGE_BYTES = 4;
+    static constexpr std::size_t FRAME_BYTES = 2 + 8 * 2;
+
+    std::vector<Anchor> m_groups;
+    std::vector<Source> m_sources;              // by frame id
+    std::vector<AtlasFrame> m_frames;
+    std::vector<int> m_framePages;              // page index per frame, -1 for none
+    std::vector<sf::Vector2u> m_pageSizes;
+    std::vector<const sf::Texture*> m_pages;    // owned below, or by the asset manager when cached
+    std::vector<std::unique_ptr<sf::Texture>> m_pageTextures;
+    std::vector<sf::Image> m_images;            // packed pages, until saved
+    std::filesystem::path m_cacheDir;
+    std::uint64_t m_stamp = 0;
+    bool m_cached = false;
+};
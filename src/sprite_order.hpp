@@ -0,0 +1,131 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ===========================================
+// SPRITE ORDERING
+// Helpers for drawing every sprite of a frame in depth order. Sprites are
+// sorted by squared distance with an LSD radix sort, which is stable, so
+// ties keep their collection order and frames stay deterministic. They are
+// walked front to back once against a per-column coverage mask, and a
+// column hidden behind the opaque part of a nearer sprite is dropped before
+// it costs a vertex. What survives is drawn back to front, so alpha blends
+// over what is behind it.
+// ===========================================
+
+// Orders like the distance for any non-negative float, as IEEE 754 bit
+// patterns of positive numbers sort as unsigned integers
+inline std::uint32_t distanceKey(float squaredDistance) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &squaredDistance, sizeof(bits));
+    return bits;
+}
+
+// Sort entry: key in the high 32 bits, caller's row in the low 32
+inline std::uint64_t sortEntry(std::uint32_t key, std::uint32_t row) {
+    return (static_cast<std::uint64_t>(key) << 32) | row;
+}
+
+// Sorts entries by key, stably, in four 8-bit passes through scratch.
+// A pass where every key shares the digit is skipped, which for distances
+// under a few thousand tiles is usually the top byte.
+inline void radixSortEntries(std::vector<std::uint64_t>& entries, std::vector<std::uint64_t>& scratch) {
+    scratch.resize(entries.size());
+    for (int shift = 32; shift < 64; shift += 8) {
+        std::array<std::size_t, 257> offsets{};
+        for (std::uint64_t entry : entries) offsets[((entry >> shift) & 0xFF) + 1]++;
+        if (std::find(offsets.begin() + 1, offsets.end(), entries.size()) != offsets.end()) continue;
+        for (int digit = 0; digit < 256; digit++) offsets[digit + 1] += offsets[digit];
+        for (std::uint64_t entry : entries) scratch[offsets[(entry >> shift) & 0xFF]++] = entry;
+        entries.swap(scratch);
+    }
+}
+
+// Per screen column, the rows already hidden by opaque sprites and the
+// depth they are hidden at. One span is kept per column: overlapping spans
+// merge, keeping the farther depth so the merged span hides only what is
+// behind both, and otherwise the taller span wins.
+class ColumnCoverage {
+public:
+    void reset(unsigned int width) {
+        m_top.assign(width, 0);
+        m_bottom.assign(width, 0);
+        m_depth.assign(width, 0.0);
+    }
+
+    // Rows [top, bottom) of column x, at depth, are behind something opaque
+    bool covered(int x, int top, int bottom, double depth) const {
+        return top >= m_top[x] && bottom <= m_bottom[x] && depth >= m_depth[x];
+    }
+
+    // Marks area, clipped to the mask, as opaque at depth
+    void cover(const sf::IntRect& area, double depth) {
+        const int left = std::max(area.position.x, 0);
+        const int right = std::min(area.position.x + area.size.x, static_cast<int>(m_top.size()));
+        const int top = area.position.y, bottom = area.position.y + area.size.y;
+        if (area.size.y <= 0) return;
+        for (int x = left; x < right; x++) {
+            if (m_bottom[x] <= m_top[x]) {
+                m_top[x] = top;
+                m_bottom[x] = bottom;
+                m_depth[x] = depth;
+            } else if (top <= m_bottom[x] && bottom >= m_top[x]) {
+                m_top[x] = std::min(m_top[x], top);
+                m_bottom[x] = std::max(m_bottom[x], bottom);
+                m_depth[x] = std::max(m_depth[x], depth);
+            } else if (bottom - top > m_bottom[x] - m_top[x]) {
+                m_top[x] = top;
+                m_bottom[x] = bottom;
+                m_depth[x] = depth;
+            }
+        }
+    }
+
+private:
+    std::vector<int> m_top, m_bottom;
+    std::vector<double> m_depth;
+};
+
+// Largest rectangle of fully opaque pixels inside frame, relative to the
+// frame's corner; empty when there is none or the image does not hold the
+// frame. Runs once per frame of a sheet, at load.
+inline sf::IntRect opaqueCore(const sf::Image& image, const sf::IntRect& frame) {
+    const sf::Vector2u size = image.getSize();
+    if (frame.position.x < 0 || frame.position.y < 0 || frame.size.x <= 0 || frame.size.y <= 0 ||
+        static_cast<unsigned int>(frame.position.x + frame.size.x) > size.x ||
+        static_cast<unsigned int>(frame.position.y + frame.size.y) > size.y) {
+        return {};
+    }
+
+    // Row by row, the run of opaque pixels ending at each column's row,
+    // then the largest rectangle under that histogram
+    const std::uint8_t* pixels = image.getPixelsPtr();
+    std::vector<int> heights(frame.size.x + 1, 0);
+    std::vector<int> stack;
+    sf::IntRect best;
+    for (int y = 0; y < frame.size.y; y++) {
+        for (int x = 0; x < frame.size.x; x++) {
+            const std::size_t at = (static_cast<std::size_t>(frame.position.y + y) * size.x + frame.position.x + x) * 4;
+            heights[x] = pixels[at + 3] == 255 ? heights[x] + 1 : 0;
+        }
+        stack.clear();
+        for (int x = 0; x <= frame.size.x; x++) {
+            while (!stack.empty() && heights[stack.back()] >= heights[x]) {
+                const int height = heights[stack.back()];
+                stack.pop_back();
+                const int left = stack.empty() ? 0 : stack.back() + 1;
+                if (height * (x - left) > best.size.x * best.size.y) {
+                    best = sf::IntRect({left, y - height + 1}, {x - left, height});
+                }
+            }
+            stack.push_back(x);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "framebuffer.hpp"
+#include "ray_packet.hpp"
+
+// ===========================================
+// SOFTWARE SURFACES
+// Textured walls, floor and ceiling for the framebuffer renderer, done the
+// way DOOM does them. Textures hold 8-bit palette indices. A colormap maps
+// an index and a light level to a finished pixel, so fog costs one table
+// read instead of three multiplies per pixel. Textures are column-major,
+// so a wall column reads its texture column in order.
+//
+// Floor and ceiling are cast one row at a time. A row's distance, light
+// level and step scale depend only on the view size, so they come from
+// tables rebuilt only when it changes. The camera plane, which turns every
+// frame, only scales the step: one multiply per row.
+// ===========================================
+
+// DOOM-style COLORMAP over a palette of up to 256 colours: one 256-entry
+// table per light level, brightest first, plus a darker copy of every
+// level for walls facing along y
+class Colormap {
+public:
+    static constexpr int COLOURS = 256;
+    static constexpr int LIGHT_LEVELS = 32;
+
+    // Light falls off linearly up to fogDistance tiles, where it is down to
+    // 1 - maxFog; darkSide scales the y-facing copies
+    explicit Colormap(double fogDistance = 20.0, double maxFog = 0.7, double darkSide = 1 / 1.5)
+        : m_levelScale((LIGHT_LEVELS - 1) / fogDistance), m_maxFog(maxFog), m_darkSide(darkSide) {}
+
+    // Palette index for a colour. New colours are added until the palette is
+    // full; after that a colour maps to its nearest entry.
+    std::uint8_t index(std::uint8_t r, std::uint8_t g, std::uint8_t b) {
+        const std::uint32_t key = (static_cast<std::uint32_t>(r) << 16) | (g << 8) | b;
+        auto it = m_lookup.find(key);
+        if (it != m_lookup.end()) return it->second;
+
+        std::uint8_t entry;
+        if (m_palette.size() < COLOURS) {
+            entry = static_cast<std::uint8_t>(m_palette.size());
+            m_palette.push_back(sf::Color(r, g, b));
+        } else {
+            entry = nearest(r, g, b);
+        }
+        m_lookup.emplace(key, entry);
+        m_dirty = true;
+        return entry;
+    }
+
+    // Rebuilds the light tables when the palette has grown
+    void build() {
+        if (!m_dirty) return;
+        m_maps.assign(static_cast<std::size_t>(2 * LIGHT_LEVELS) * COLOURS, packRGBA(0, 0, 0));
+        for (int level = 0; level < LIGHT_LEVELS; level++) {
+            for (std::size_t i = 0; i < m_palette.size(); i++) {
+                m_maps[level * COLOURS + i] = shade(m_palette[i], light(level));
+                m_maps[(LIGHT_LEVELS + level) * COLOURS + i] = shade(m_palette[i], light(level, true));
+            }
+        }
+        m_dirty = false;
+    }
+
+    // Light level for something distance tiles away
+    int level(double distance) const {
+        return std::min(LIGHT_LEVELS - 1, static_cast<int>(distance * m_levelScale));
+    }
+
+    // Brightness of a level, 0 to 1, for renderers that shade on the GPU
+    double light(int level, bool dark = false) const {
+        const double light = 1.0 - m_maxFog * level / (LIGHT_LEVELS - 1);
+        return dark ? light * m_darkSide : light;
+    }
+
+    // The 256 pixels of one light level
+    const std::uint32_t* map(int level, bool dark = false) const {
+        return &m_maps[static_cast<std::size_t>((dark ? LIGHT_LEVELS : 0) + level) * COLOURS];
+    }
+
+    std::size_t paletteSize() const { return m_palette.size(); }
+
+private:
+    static std::uint32_t shade(sf::Color c, double light) {
+        return packRGBA(static_cast<std::uint8_t>(c.r * light), static_cast<std::uint8_t>(c.g * light),
+                        static_cast<std::uint8_t>(c.b * light));
+    }
+
+    std::uint8_t nearest(std::uint8_t r, std::uint8_t g, std::uint8_t b) const {
+        std::size_t best = 0;
+        int bestDistance = 1 << 30;
+        for (std::size_t i = 0; i < m_palette.size(); i++) {
+            const int dr = m_palette[i].r - r, dg = m_palette[i].g - g, db = m_palette[i].b - b;
+            const int distance = dr * dr + dg * dg + db * db;
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = i;
+            }
+        }
+        return static_cast<std::uint8_t>(best);
+    }
+
+    double m_levelScale;
+    double m_maxFog;
+    double m_darkSide;
+    std::vector<sf::Color> m_palette;
+    std::unordered_map<std::uint32_t, std::uint8_t> m_lookup;
+    std::vector<std::uint32_t> m_maps;
+    bool m_dirty = true;
+};
+
+// Palette indices stored column-major, column x at
+// texels[x * height, (x + 1) * height), so a wall column reads one run.
+// Both sides are powers of two so coordinates wrap with a mask.
+struct IndexedColumns {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    std::vector<std::uint8_t> texels;
+
+    const std::uint8_t* column(unsigned int x) const {
+        return texels.data() + static_cast<std::size_t>(x) * height;
+    }
+
+    std::uint8_t sample(unsigned int x, unsigned int y) const {
+        return column(x & (width - 1))[y & (height - 1)];
+    }
+
+    // area of image through colormap's palette. An area the image does not
+    // hold, as when it failed to load, gives one texel of fallback.
+    static IndexedColumns fromImage(const sf::Image& image, sf::IntRect area, Colormap& colormap,
+                                    sf::Color fallback) {
+        IndexedColumns result;
+        const sf::Vector2u size = image.getSize();
+        const bool inside = area.position.x >= 0 && area.position.y >= 0 && area.size.x > 0 && area.size.y > 0 &&
+                            static_cast<unsigned int>(area.position.x + area.size.x) <= size.x &&
+                            static_cast<unsigned int>(area.position.y + area.size.y) <= size.y;
+        if (!inside) {
+            result.width = result.height = 1;
+            result.texels.push_back(colormap.index(fallback.r, fallback.g, fallback.b));
+            return result;
+        }
+
+        result.width = static_cast<unsigned int>(area.size.x);
+        result.height = static_cast<unsigned int>(area.size.y);
+        result.texels.resize(static_cast<std::size_t>(result.width) * result.height);
+
+        // sf::Image is row-major RGBA8; transpose while indexing
+        const std::uint8_t* src = image.getPixelsPtr();
+        for (unsigned int y = 0; y < result.height; y++) {
+            for (unsigned int x = 0; x < result.width; x++) {
+                const std::uint8_t* p = src + ((static_cast<std::size_t>(area.position.y) + y) * size.x +
+                                               area.position.x + x) * 4;
+                result.texels[static_cast<std::size_t>(x) * result.height + y] = colormap.index(p[0], p[1], p[2]);
+            }
+        }
+        return result;
+    }
+};
+
+// Floor row r is screen row height / 2 + r; the ceiling row mirroring it is
+// height / 2 - 1 - r. Rows are sampled through their pixel centre.
+class RowTables {
+public:
+    // No work unless the view size changed
+    void update(unsigned int width, unsigned int height, const Colormap& colormap) {
+        if (width == m_width && height == m_height) return;
+        m_width = width;
+        m_height = height;
+
+        const unsigned int rows = height - height / 2;
+        distance.resize(rows);
+        stepScale.resize(rows);
+        light.resize(rows);
+        for (unsigned int r = 0; r < rows; r++) {
+            distance[r] = 0.5 * height / (r + 0.5);
+            stepScale[r] = distance[r] * 2 / width;
+            light[r] = colormap.level(distance[r]);
+        }
+        m_rebuilds++;
+    }
+
+    std::size_t rows() const { return distance.size(); }
+    std::size_t rebuilds() const { return m_rebuilds; }
+
+    std::vector<double> distance;  // tiles from the camera plane
+    std::vector<double> stepScale; // world step per pixel, per unit of camera plane
+    std::vector<int> light;        // colormap level
+
+private:
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    std::size_t m_rebuilds = 0;
+};
+
+// World coordinate in 16.16 fixed point, modulo 65536 tiles: the low 16
+// bits are the position within the tile, and stepping wraps for free
+inline std::uint32_t toTileFixed(double world) {
+    return static_cast<std::uint32_t>(static_cast<std::int64_t>(std::floor(world * 65536.0)));
+}
+
+// Floor rows [begin, end) and their mirrored ceiling rows, textured by
+// world coordinate with one texture repeat per tile
+inline void castFloorRows(Framebuffer& framebuffer, const RayCamera& cam, const RowTables& tables,
+                          const Colormap& colormap, const IndexedColumns& floor,
+                          const IndexedColumns& ceiling, int begin, int end) {
+    const unsigned int width = framebuffer.width();
+    const unsigned int height = framebuffer.height();
+    const unsigned int horizon = height / 2;
+    const double leftX = cam.dirX - cam.planeX;
+    const double leftY = cam.dirY - cam.planeY;
+
+    for (int r = begin; r < end; r++) {
+        const double distance = tables.distance[r];
+        const double stepX = tables.stepScale[r] * cam.planeX;
+        const double stepY = tables.stepScale[r] * cam.planeY;
+        // Centre of the leftmost pixel
+        std::uint32_t u = toTileFixed(cam.posX + distance * leftX + 0.5 * stepX);
+        std::uint32_t v = toTileFixed(cam.posY + distance * leftY + 0.5 * stepY);
+        const auto du = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::llround(stepX * 65536.0)));
+        const auto dv = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::llround(stepY * 65536.0)));
+        const std::uint32_t* shade = colormap.map(tables.light[r]);
+
+        std::uint32_t* floorRow = framebuffer.row(horizon + r);
+        const bool mirrored = horizon >= static_cast<unsigned int>(r) + 1;
+        std::uint32_t* ceilingRow = mirrored ? framebuffer.row(horizon - 1 - r) : nullptr;
+        for (unsigned int x = 0; x < width; x++, u += du, v += dv) {
+            const std::uint32_t tileU = u & 0xFFFF, tileV = v & 0xFFFF;
+            floorRow[x] = shade[floor.sample((tileU * floor.width) >> 16, (tileV * floor.height) >> 16)];
+            if (ceilingRow) {
+                ceilingRow[x] = shade[ceiling.sample((tileU * ceiling.width) >> 16, (tileV * ceiling.height) >> 16)];
+            }
+        }
+    }
+}
+
+// Column x of a wall hit, rows [drawStart, drawEnd) of a wall lineHeight
+// pixels tall centred on the horizon
+inline void drawWallColumn(Framebuffer& framebuffer, unsigned int x, const RayHit& hit, int lineHeight,
+                           int drawStart, int drawEnd, const Colormap& colormap,
+                           const IndexedColumns& texture) {
+    const unsigned int height = framebuffer.height();
+    drawStart = std::max(drawStart, 0);
+    drawEnd = std::min(drawEnd, static_cast<int>(height));
+    if (x >= framebuffer.width() || drawStart >= drawEnd) return;
+
+    const unsigned int texX = std::min(static_cast<unsigned int>(hit.wallX * texture.width), texture.width - 1);
+    const std::uint8_t* texels = texture.column(texX);
+    const unsigned int mask = texture.height - 1;
+    const std::uint32_t* shade = colormap.map(colormap.level(hit.perpWallDist), hit.side == 1);
+
+    const double step = static_cast<double>(texture.height) / lineHeight;
+    double texY = (drawStart - static_cast<double>(height) / 2 + lineHeight / 2.0) * step;
+    std::uint32_t* dst = framebuffer.row(static_cast<unsigned int>(drawStart)) + x;
+    const std::size_t stride = framebuffer.stride();
+    for (int y = drawStart; y < drawEnd; y++, dst += stride) {
+        *dst = shade[texels[static_cast<unsigned int>(static_cast<int>(texY)) & mask]];
+        texY += step;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ray_packet.hpp"
+
+// ===========================================
+// TILE MAP
+// One byte per cell in a single allocation. A ring of wall cells around the
+// map lets lookups step one cell past the edge without a bounds check.
+// Cells are stored row-major, or in Morton (Z-order) so that square
+// neighbourhoods share cache lines.
+// ===========================================
+
+enum class TileType : std::uint8_t { Empty = 0, Wall = 1 };
+enum class TileLayout { RowMajor, Morton };
+
+// Interleaves the low 16 bits of x and y: x in the even bits, y in the odd
+inline std::uint32_t mortonEncode(std::uint32_t x, std::uint32_t y) {
+    auto spread = [](std::uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+class TileMap {
+public:
+    // The map starts as solid wall, border included
+    TileMap(int width, int height, TileLayout layout = TileLayout::RowMajor, int border = 1)
+        : m_width(width), m_height(height), m_border(border), m_layout(layout),
+          m_stride(width + 2 * border) {
+        const int paddedHeight = height + 2 * border;
+        std::size_t cells = static_cast<std::size_t>(m_stride) * paddedHeight;
+        if (layout == TileLayout::Morton) {
+            // Z-order covers a power-of-two square
+            std::size_t side = 1;
+            while (side < static_cast<std::size_t>(std::max(m_stride, paddedHeight))) side <<= 1;
+            cells = side * side;
+        }
+        m_cells.assign(cells + RAY_GRID_PADDING, static_cast<std::uint8_t>(TileType::Wall));
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int border() const { return m_border; }
+    TileLayout layout() const { return m_layout; }
+
+    bool contains(int x, int y) const {
+        return x >= 0 && x < m_width && y >= 0 && y < m_height;
+    }
+
+    // Storage offset of a cell; valid up to border cells outside the map
+    std::size_t index(int x, int y) const {
+        const auto px = static_cast<std::uint32_t>(x + m_border);
+        const auto py = static_cast<std::uint32_t>(y + m_border);
+        if (m_layout == TileLayout::Morton) return mortonEncode(px, py);
+        return static_cast<std::size_t>(py) * m_stride + px;
+    }
+
+    TileType at(int x, int y) const { return static_cast<TileType>(m_cells[index(x, y)]); }
+
+    void set(int x, int y, TileType tile) { m_cells[index(x, y)] = static_cast<std::uint8_t>(tile); }
+
+    // Unchecked: x and y may be at most border cells outside the map
+    bool isWall(int x, int y) const { return m_cells[index(x, y)] != 0; }
+
+    // Checked: everything outside the map is wall
+    bool blocks(int x, int y) const { return !contains(x, y) || isWall(x, y); }
+
+    // Sets every map cell; the border stays wall
+    void fill(TileType tile) {
+        for (int y = 0; y < m_height; y++) {
+            for (int x = 0; x < m_width; x++) set(x, y, tile);
+        }
+    }
+
+    // Every stored cell, border and padding included, in storage order; a
+    // map of the same size, border and layout takes them in one copy
+    const std::uint8_t* storage() const { return m_cells.data(); }
+    std::uint8_t* storage() { return m_cells.data(); }
+    std::size_t storageSize() const { return m_cells.size(); }
+
+    // View for the packet DDA kernels, which index rows directly. Row-major
+    // maps only.
+    RayGrid rayGrid() const {
+        return {m_cells.data() + index(0, 0), m_width, m_height, m_stride};
+    }
+
+private:
+    int m_width;
+    int m_height;
+    int m_border;
+    TileLayout m_layout;
+    int m_stride;
+    std::vector<std::uint8_t> m_cells;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// ===========================================
+// WORKER POOL
+// Persistent threads for data-parallel frame work. Threads are spawned
+// once; each parallelFor wakes them, hands every participant one
+// contiguous slice, and returns only when all slices are done, so the
+// call doubles as the barrier before dependent work.
+// ===========================================
+
+class WorkerPool {
+public:
+    // threadCount participants in total; the calling thread is one of them
+    explicit WorkerPool(unsigned int threadCount) {
+        if (threadCount == 0) threadCount = 1;
+        m_threads.reserve(threadCount - 1);
+        for (unsigned int i = 1; i < threadCount; i++) {
+            m_threads.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_generation++;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(m_threads.size()) + 1; }
+
+    // Calls fn(begin, end) once per participant over disjoint slices of
+    // [0, count). Not reentrant: one parallelFor at a time per pool.
+    template <typename Fn>
+    void parallelFor(int count, Fn&& fn) {
+        using Task = std::remove_reference_t<Fn>;
+        if (m_threads.empty() || count <= 1) {
+            fn(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = [](void* context, int begin, int end) { (*static_cast<Task*>(context))(begin, end); };
+            m_context = const_cast<void*>(static_cast<const void*>(&fn));
+            m_count = count;
+            m_pending = static_cast<unsigned int>(m_threads.size());
+            m_generation++;
+        }
+        m_wake.notify_all();
+
+        runSlice(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0; });
+    }
+
+    // Default participant count for this machine
+    static unsigned int hardwareThreads() {
+        unsigned int count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+private:
+    void runSlice(unsigned int index) {
+        const long long participants = size();
+        int begin = static_cast<int>(m_count * index / participants);
+        int end = static_cast<int>(m_count * (index + 1) / participants);
+        if (begin < end) m_task(m_context, begin, end);
+    }
+
+    void workerLoop(unsigned int index) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_generation != seen; });
+                seen = m_generation;
+                if (m_stopping) return;
+            }
+
+            runSlice(index);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) m_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    // Current job, published under m_mutex before m_generation changes
+    void (*m_task)(void*, int, int) = nullptr;
+    void* m_context = nullptr;
+    long long m_count = 0;
+    unsigned int m_pending = 0;
+    std::uint64_t m_generation = 0;
+    bool m_stopping = false;
+};
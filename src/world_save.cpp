@@ -0,0 +1,314 @@
+#include "world_save.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+// Particle flipbooks by their number in saves
+std::array<const SpriteAnimation*, 4> savedEffects(const EffectAnimations& effects) {
+    return {&effects.blood, &effects.deathPuff, &effects.shot, &effects.impact};
+}
+
+// Rows in bucket order, see SaveSection::EnemyOrder
+std::vector<std::uint32_t> bucketOrder(const SpatialHash& index, const TileMap& map) {
+    std::vector<std::uint32_t> order;
+    index.forEachInTiles(0, 0, map.width() - 1, map.height() - 1,
+                         [&](int id) { order.push_back(static_cast<std::uint32_t>(id)); });
+    return order;
+}
+
+bool saveWorld(const GameWorld& world, const std::filesystem::path& path) {
+    if (!world.dungeonMap) return false;
+    const TileMap& map = *world.dungeonMap;
+    SaveWriter save(map.storageSize() + world.enemies.size() * sizeof(SaveEnemy));
+    SaveHeader& header = save.header();
+    header.tickRate = static_cast<std::uint16_t>(world.tickRate);
+    header.seed = world.seed;
+    header.mapWidth = map.width();
+    header.mapHeight = map.height();
+    header.mapBorder = map.border();
+    header.flags = map.layout() == TileLayout::Morton ? SaveFlag::Morton : 0;
+    header.simTime = world.simTime;
+    save.section(SaveSection::Tiles, map.storage(), map.storageSize());
+    
+    std::vector<SaveRoom> rooms;
+    for (const Room& room : world.rooms) rooms.push_back({room.x, room.y, room.w, room.h});
+    save.section(SaveSection::Rooms, rooms);
+    
+    std::vector<SavePlayer> players;
+    for (const Player& p : world.players) {
+        players.push_back({p.posX, p.posY, p.dirX, p.dirY, p.planeX, p.planeY, p.momX, p.momY,
+                           p.health, p.maxHealth, p.ammo, p.score, p.kills, p.shotCooldown});
+    }
+    save.section(SaveSection::Player, players);
+    
+    const EnemyStore& e = world.enemies;
+    std::vector<SaveEnemy> enemies;
+    enemies.reserve(e.size());
+    for (std::size_t i = 0; i < e.size(); i++) {
+        enemies.push_back({e.x[i], e.y[i], e.dirX[i], e.dirY[i], e.speed[i], e.attackCooldown[i], e.animTime[i],
+                           e.health[i], e.maxHealth[i], static_cast<std::uint8_t>(e.type[i]), e.active[i],
+                           e.variant[i], static_cast<std::uint8_t>(e.anim[i])});
+    }
+    save.section(SaveSection::Enemies, enemies);
+    save.section(SaveSection::EnemyOrder, bucketOrder(world.enemyIndex, map));
+    
+    const PickupStore& k = world.pickups;
+    std::vector<SavePickup> pickups;
+    for (std::size_t i = 0; i < k.size(); i++) {
+        pickups.push_back({k.x[i], k.y[i], k.value[i], static_cast<std::uint8_t>(k.type[i]), k.active[i], {}});
+    }
+    save.section(SaveSection::Pickups, pickups);
+    save.section(SaveSection::PickupOrder, bucketOrder(world.pickupIndex, map));
+    
+    const ProjectileStore& s = world.projectiles;
+    std::vector<SaveProjectile> projectiles;
+    for (std::size_t i = 0; i < s.size(); i++) {
+        projectiles.push_back({s.x[i], s.y[i], s.velX[i], s.velY[i], s.timeLeft[i], s.damage[i], s.shooter[i], {}});
+    }
+    save.section(SaveSection::Projectiles, projectiles);
+    
+    const ParticlePool& f = world.particles;
+    const auto effects = savedEffects(world.assets.effects);
+    std::vector<SaveParticle> particles;
+    particles.reserve(f.count());
+    for (std::size_t i = 0; i < f.count(); i++) {
+        const auto effect = std::find(effects.begin(), effects.end(), f.animation[i]) - effects.begin();
+        particles.push_back({f.x[i], f.y[i], f.z[i], f.velX[i], f.velY[i], f.velZ[i], f.gravity[i],
+                             f.timeLeft[i], f.lifetime[i], f.size[i], static_cast<std::uint8_t>(effect), {}});
+    }
+    save.section(SaveSection::Particles, particles);
+    
+    if (world.visibility) {
+        const RoomVisibility& visibility = *world.visibility;
+        header.visibilityRooms = visibility.roomRegions();
+        std::vector<SaveBounds> bounds;
+        for (const RoomVisibility::Bounds& b : visibility.allBounds()) bounds.push_back({b.minX, b.minY, b.maxX, b.maxY});
+        save.section(SaveSection::VisibilityRegions, visibility.tileRegions());
+        save.section(SaveSection::VisibilityBounds, bounds);
+        std::vector<std::uint64_t> firstVisible;
+        std::vector<std::int32_t> visible;
+        visibility.visibleLists(firstVisible, visible);
+        save.section(SaveSection::VisibilityFirst, firstVisible);
+        save.section(SaveSection::VisibilityList, visible);
+    }
+    return save.write(path);
+}
+
+std::vector<Room> savedRooms(const SaveFile& save) {
+    std::vector<Room> rooms;
+    for (const SaveRoom& room : save.section<SaveRoom>(SaveSection::Rooms)) {
+        rooms.push_back({room.x, room.y, room.w, room.h});
+    }
+    return rooms;
+}
+
+bool applySaveHeader(EngineConfig& config, const SaveHeader& header) {
+    if (header.mapWidth < 32 || header.mapWidth > 4096 || header.mapHeight < 32 || header.mapHeight > 4096 ||
+        header.mapBorder < 1 || header.mapBorder > 16) {
+        return false;
+    }
+    config.seed = header.seed;
+    config.mapWidth = header.mapWidth;
+    config.mapHeight = header.mapHeight;
+    config.mapLayout = (header.flags & SaveFlag::Morton) ? TileLayout::Morton : TileLayout::RowMajor;
+    config.tickRate = std::clamp<int>(header.tickRate, MIN_TICK_RATE, MAX_TICK_RATE);
+    config.infinite = false;
+    return true;
+}
+
+std::unique_ptr<RoomVisibility> savedVisibility(const SaveFile& save, const TileMap& map) {
+    const auto regions = save.section<std::int32_t>(SaveSection::VisibilityRegions);
+    const auto bounds = save.section<SaveBounds>(SaveSection::VisibilityBounds);
+    const auto firstVisible = save.section<std::uint64_t>(SaveSection::VisibilityFirst);
+    const auto visible = save.section<std::int32_t>(SaveSection::VisibilityList);
+    if (regions.empty() || firstVisible.empty() ||
+        !RoomVisibility::partsFit(map.width(), map.height(), regions.data, regions.size(), bounds.size(),
+                                  save.header().visibilityRooms, firstVisible.data, firstVisible.size(),
+                                  visible.data, visible.size())) {
+        return nullptr;
+    }
+    std::vector<RoomVisibility::Bounds> regionBounds;
+    regionBounds.reserve(bounds.size());
+    for (const SaveBounds& b : bounds) regionBounds.push_back({b.minX, b.minY, b.maxX, b.maxY});
+    return std::make_unique<RoomVisibility>(map.width(), map.height(),
+                                            std::vector<int>(regions.begin(), regions.end()),
+                                            std::move(regionBounds), save.header().visibilityRooms,
+                                            firstVisible.data, visible.data);
+}
+
+// Every value finite, so none can carry a NaN into the map lookups
+template <typename... Values>
+bool finite(Values... values) {
+    return (std::isfinite(static_cast<double>(values)) && ...);
+}
+
+bool onMap(const TileMap& map, double x, double y) {
+    return finite(x, y) && x >= 0 && x < map.width() && y >= 0 && y < map.height();
+}
+
+// Every stored byte a tile, and every one outside the map a wall: the
+// empty cells of the whole storage are exactly those inside the map
+bool tilesFit(const TileMap& map, const SaveArray<std::uint8_t>& tiles) {
+    if (tiles.size() != map.storageSize()) return false;
+    const auto maxTile = static_cast<std::uint8_t>(TileType::Wall);
+    if (std::any_of(tiles.begin(), tiles.end(), [&](std::uint8_t tile) { return tile > maxTile; })) return false;
+    const auto empty = static_cast<std::size_t>(std::count(tiles.begin(), tiles.end(), 0));
+    std::size_t emptyInside = 0;
+    for (int y = 0; y < map.height(); y++) {
+        for (int x = 0; x < map.width(); x++) emptyInside += tiles[map.index(x, y)] == 0;
+    }
+    return empty == emptyInside;
+}
+
+bool saveConsistent(const SaveFile& save, const TileMap& map, std::size_t players) {
+    if (save.section<SavePlayer>(SaveSection::Player).size() != players) return false;
+    if (!tilesFit(map, save.section<std::uint8_t>(SaveSection::Tiles))) return false;
+    for (const SaveRoom& room : save.section<SaveRoom>(SaveSection::Rooms)) {
+        if (room.x < 0 || room.y < 0 || room.w <= 0 || room.h <= 0 || room.x > map.width() - room.w ||
+            room.y > map.height() - room.h) {
+            return false;
+        }
+    }
+    for (const SavePlayer& p : save.section<SavePlayer>(SaveSection::Player)) {
+        if (!onMap(map, p.posX, p.posY) ||
+            !finite(p.dirX, p.dirY, p.planeX, p.planeY, p.momX, p.momY, p.shotCooldown)) {
+            return false;
+        }
+    }
+    const auto enemies = save.section<SaveEnemy>(SaveSection::Enemies);
+    const auto pickups = save.section<SavePickup>(SaveSection::Pickups);
+    for (std::uint32_t id : save.section<std::uint32_t>(SaveSection::EnemyOrder)) {
+        if (id >= enemies.size()) return false;
+    }
+    for (std::uint32_t id : save.section<std::uint32_t>(SaveSection::PickupOrder)) {
+        if (id >= pickups.size()) return false;
+    }
+    for (const SaveEnemy& enemy : enemies) {
+        if (enemy.type >= ENEMY_TYPES || enemy.anim > static_cast<std::uint8_t>(EnemyAnim::Die) ||
+            !onMap(map, enemy.x, enemy.y) ||
+            !finite(enemy.dirX, enemy.dirY, enemy.speed, enemy.attackCooldown, enemy.animTime)) {
+            return false;
+        }
+    }
+    for (const SavePickup& pickup : pickups) {
+        if (pickup.type > static_cast<std::uint8_t>(PickupType::Armor) || !onMap(map, pickup.x, pickup.y)) {
+            return false;
+        }
+    }
+    for (const SaveProjectile& shot : save.section<SaveProjectile>(SaveSection::Projectiles)) {
+        if (shot.shooter > players || !onMap(map, shot.x, shot.y) || !finite(shot.velX, shot.velY, shot.timeLeft)) {
+            return false;
+        }
+    }
+    for (const SaveParticle& particle : save.section<SaveParticle>(SaveSection::Particles)) {
+        if (!onMap(map, particle.x, particle.y) ||
+            !finite(particle.z, particle.velX, particle.velY, particle.velZ, particle.gravity, particle.timeLeft,
+                    particle.lifetime, particle.size)) {
+            return false;
+        }
+    }
+    return players > 0;
+}
+
+bool restoreWorld(GameWorld& world, const SaveFile& save, WorkerPool* workers) {
+    const SaveHeader& header = save.header();
+    TileMap* map = world.dungeonMap.get();
+    const auto tiles = save.section<std::uint8_t>(SaveSection::Tiles);
+    if (!map || header.mapWidth != map->width() || header.mapHeight != map->height() ||
+        header.mapBorder != map->border() ||
+        ((header.flags & SaveFlag::Morton) != 0) != (map->layout() == TileLayout::Morton) ||
+        header.tickRate != world.tickRate || !saveConsistent(save, *map, world.players.size())) {
+        return false;
+    }
+    
+    std::vector<Room> rooms = savedRooms(save);
+    const bool sameRooms = std::equal(rooms.begin(), rooms.end(), world.rooms.begin(), world.rooms.end(),
+                                      [](const Room& a, const Room& b) {
+                                          return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+                                      });
+    if (!sameRooms || std::memcmp(tiles.data, map->storage(), tiles.size()) != 0) {
+        std::memcpy(map->storage(), tiles.data, tiles.size());
+        world.rooms = std::move(rooms);
+        world.visibility = savedVisibility(save, *map);
+        if (!world.visibility) world.visibility = std::make_unique<RoomVisibility>(*map, world.rooms, workers);
+    }
+    world.flowField.invalidate();
+    
+    const auto players = save.section<SavePlayer>(SaveSection::Player);
+    for (std::size_t slot = 0; slot < players.size(); slot++) {
+        const SavePlayer& p = players[slot];
+        Player& player = world.players[slot];
+        player.posX = p.posX; player.posY = p.posY;
+        player.dirX = p.dirX; player.dirY = p.dirY;
+        player.planeX = p.planeX; player.planeY = p.planeY;
+        player.momX = p.momX; player.momY = p.momY;
+        player.health = p.health; player.maxHealth = p.maxHealth;
+        player.ammo = p.ammo; player.score = p.score; player.kills = p.kills;
+        player.shotCooldown = p.shotCooldown;
+    }
+    world.previousPlayers = world.players;
+    
+    // Buckets push to their head, so rows go back in reverse
+    const auto enemies = save.section<SaveEnemy>(SaveSection::Enemies);
+    EnemyStore& e = world.enemies;
+    e = EnemyStore();
+    e.reserve(enemies.size());
+    for (const SaveEnemy& enemy : enemies) {
+        const int id = static_cast<int>(e.size());
+        e.add(enemy.x, enemy.y, static_cast<EnemyType>(enemy.type), enemy.maxHealth, enemy.speed, enemy.variant);
+        e.dirX[id] = enemy.dirX;
+        e.dirY[id] = enemy.dirY;
+        e.attackCooldown[id] = enemy.attackCooldown;
+        e.health[id] = enemy.health;
+        e.active[id] = enemy.active;
+        e.anim[id] = static_cast<EnemyAnim>(enemy.anim);
+        e.animTime[id] = enemy.animTime;
+        if (!enemy.active && e.anim[id] == EnemyAnim::Die && enemy.animTime < ENEMY_DEATH_TIME) e.dying.push_back(id);
+    }
+    const auto enemyOrder = save.section<std::uint32_t>(SaveSection::EnemyOrder);
+    world.enemyIndex.clear();
+    for (std::size_t i = enemyOrder.size(); i-- > 0;) {
+        const int id = static_cast<int>(enemyOrder[i]);
+        world.enemyIndex.insert(id, e.x[id], e.y[id]);
+    }
+    
+    PickupStore& k = world.pickups;
+    k = PickupStore();
+    for (const SavePickup& pickup : save.section<SavePickup>(SaveSection::Pickups)) {
+        k.add(pickup.x, pickup.y, static_cast<PickupType>(pickup.type), pickup.value);
+        k.active.back() = pickup.active;
+    }
+    const auto pickupOrder = save.section<std::uint32_t>(SaveSection::PickupOrder);
+    world.pickupIndex.clear();
+    for (std::size_t i = pickupOrder.size(); i-- > 0;) {
+        const int id = static_cast<int>(pickupOrder[i]);
+        world.pickupIndex.insert(id, k.x[id], k.y[id]);
+    }
+    
+    ProjectileStore& s = world.projectiles;
+    s.clear();
+    for (const SaveProjectile& shot : save.section<SaveProjectile>(SaveSection::Projectiles)) {
+        if (!s.add(shot.x, shot.y, 0, 0, shot.shooter)) break;
+        s.velX.back() = shot.velX;
+        s.velY.back() = shot.velY;
+        s.timeLeft.back() = shot.timeLeft;
+        s.damage.back() = shot.damage;
+    }
+    
+    ParticlePool& f = world.particles;
+    const auto effects = savedEffects(world.assets.effects);
+    f.clear();
+    for (const SaveParticle& particle : save.section<SaveParticle>(SaveSection::Particles)) {
+        const SpriteAnimation* effect = particle.effect < effects.size() ? effects[particle.effect] : nullptr;
+        if (!f.spawn(effect, particle.x, particle.y, particle.z, particle.velX, particle.velY, particle.velZ,
+                     particle.gravity, particle.size, particle.lifetime)) break;
+        f.timeLeft.back() = particle.timeLeft;
+    }
+    
+    world.cues.clear();
+    world.simTime = header.simTime;
+    world.simAccumulator = 0.0f;
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "game_world.hpp"
+#include "save_state.hpp"
+
+// ===========================================
+// SAVES
+// A fixed level and everything on it, in the SaveFile format. Loading one
+// back also restores the order of every spatial hash bucket, so a restored
+// session plays on exactly as the saved one would have.
+// ===========================================
+
+// False for a streamed world, which has no fixed level to save, or when
+// the file cannot be written
+bool saveWorld(const GameWorld& world, const std::filesystem::path& path);
+
+// The level's rooms, as saved
+std::vector<Room> savedRooms(const SaveFile& save);
+
+// A save brings the level it was made on, like a demo header. False for a
+// map no --map-size could have made.
+bool applySaveHeader(EngineConfig& config, const SaveHeader& header);
+
+// The PVS saved with the level on map, or null when there is none or it
+// does not fit map
+std::unique_ptr<RoomVisibility> savedVisibility(const SaveFile& save, const TileMap& map);
+
+// True when every row and player save refers to exists, every stored enum
+// and tile is in range, the map's wall border is whole, and every position
+// is finite and on map, for a session of players on a map of the save's
+// shape. A save can come from anywhere, so nothing in it is used before
+// this holds.
+bool saveConsistent(const SaveFile& save, const TileMap& map, std::size_t players);
+
+// Replaces the state of play with the save's, read straight from the
+// mapped file. A different level of the same shape replaces the tiles and
+// the PVS, from the save or built again when it has none. False, leaving
+// world as it was, for a streamed world, a map of another size or layout,
+// another tick rate or an inconsistent save or one of another number of
+// players.
+bool restoreWorld(GameWorld& world, const SaveFile& save, WorkerPool* workers = nullptr);
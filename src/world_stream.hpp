@@ -0,0 +1,370 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dungeon_gen.hpp"
+#include "tile_map.hpp"
+
+// ===========================================
+// WORLD STREAMING
+// An unbounded world made of square chunks, each generated from its own
+// seed (see generateChunk), so a chunk can be rebuilt identically at any
+// time and never needs saving. Background threads generate the chunks
+// around the player, a bounded LRU cache keeps the recent ones, and a fixed
+// window of chunks centred on the player is copied into a plain TileMap
+// that the renderer, collision and pathing use as before.
+//
+// The window keeps the player in its centre chunk: crossing into another
+// chunk moves the window a whole chunk, and everything in window
+// coordinates has to move back by the same amount. Coordinates therefore
+// stay small however far the player walks.
+// ===========================================
+
+struct ChunkCoord {
+    std::int64_t x = 0, y = 0;
+
+    bool operator==(const ChunkCoord& other) const { return x == other.x && y == other.y; }
+};
+
+struct ChunkCoordHash {
+    std::size_t operator()(const ChunkCoord& c) const {
+        return static_cast<std::size_t>(mixSeed(static_cast<std::uint64_t>(c.x), static_cast<std::uint64_t>(c.y)));
+    }
+};
+
+// A generated chunk; rooms are in chunk-local tiles
+struct WorldChunk {
+    ChunkCoord coord;
+    std::vector<TileType> tiles; // size * size, row-major
+    std::vector<Room> rooms;
+};
+
+// Least recently used chunks, up to a fixed count. Main thread only.
+class ChunkCache {
+public:
+    explicit ChunkCache(std::size_t capacity) : m_capacity(std::max<std::size_t>(capacity, 1)) {}
+
+    // Marks the chunk as just used; nullptr when it is not cached
+    const WorldChunk* find(const ChunkCoord& coord) {
+        auto it = m_entries.find(coord);
+        if (it == m_entries.end()) return nullptr;
+        m_order.splice(m_order.begin(), m_order, it->second);
+        return it->second->get();
+    }
+
+    void insert(std::unique_ptr<WorldChunk> chunk) {
+        ChunkCoord coord = chunk->coord;
+        auto it = m_entries.find(coord);
+        if (it != m_entries.end()) {
+            *it->second = std::move(chunk);
+            m_order.splice(m_order.begin(), m_order, it->second);
+            return;
+        }
+        m_order.push_front(std::move(chunk));
+        m_entries.emplace(coord, m_order.begin());
+        if (m_order.size() > m_capacity) {
+            m_entries.erase(m_order.back()->coord);
+            m_order.pop_back();
+            m_evicted++;
+        }
+    }
+
+    std::size_t size() const { return m_order.size(); }
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t evicted() const { return m_evicted; }
+
+private:
+    std::size_t m_capacity;
+    std::size_t m_evicted = 0;
+    std::list<std::unique_ptr<WorldChunk>> m_order; // most recent first
+    std::unordered_map<ChunkCoord, std::list<std::unique_ptr<WorldChunk>>::iterator, ChunkCoordHash> m_entries;
+};
+
+// Threads that turn chunk requests into chunks. Requests are served in the
+// order they were made; finished chunks wait until collect().
+class ChunkGenerator {
+public:
+    ChunkGenerator(std::uint64_t seed, int chunkSize, int threadCount)
+        : m_seed(seed), m_chunkSize(chunkSize) {
+        for (int i = 0; i < std::max(threadCount, 1); i++) {
+            m_threads.emplace_back([this] { run(); });
+        }
+    }
+
+    ~ChunkGenerator() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    ChunkGenerator(const ChunkGenerator&) = delete;
+    ChunkGenerator& operator=(const ChunkGenerator&) = delete;
+
+    void request(const ChunkCoord& coord) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_queue.push_back(coord);
+        }
+        m_wake.notify_one();
+    }
+
+    // Drops queued requests keep() rejects and appends them to dropped;
+    // chunks already being generated still finish
+    template <typename Pred>
+    void retain(Pred&& keep, std::vector<ChunkCoord>& dropped) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto kept = std::stable_partition(m_queue.begin(), m_queue.end(), keep);
+        dropped.insert(dropped.end(), kept, m_queue.end());
+        m_queue.erase(kept, m_queue.end());
+    }
+
+    // Moves every finished chunk into out
+    void collect(std::vector<std::unique_ptr<WorldChunk>>& out) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& chunk : m_done) out.push_back(std::move(chunk));
+        m_done.clear();
+    }
+
+    // Blocks until nothing is queued or being generated
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_queue.empty() && m_busy == 0; });
+    }
+
+    int chunkSize() const { return m_chunkSize; }
+
+private:
+    void run() {
+        TileMap scratch(m_chunkSize, m_chunkSize);
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping) return;
+            ChunkCoord coord = m_queue.front();
+            m_queue.pop_front();
+            m_busy++;
+            lock.unlock();
+
+            auto chunk = std::make_unique<WorldChunk>();
+            chunk->coord = coord;
+            generateChunk(scratch, m_chunkSize, m_seed, coord.x, coord.y, chunk->rooms);
+            chunk->tiles.resize(static_cast<std::size_t>(m_chunkSize) * m_chunkSize);
+            for (int y = 0; y < m_chunkSize; y++) {
+                for (int x = 0; x < m_chunkSize; x++) {
+                    chunk->tiles[static_cast<std::size_t>(y) * m_chunkSize + x] = scratch.at(x, y);
+                }
+            }
+
+            lock.lock();
+            m_done.push_back(std::move(chunk));
+            if (--m_busy == 0 && m_queue.empty()) m_idle.notify_all();
+        }
+    }
+
+    std::uint64_t m_seed;
+    int m_chunkSize;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<ChunkCoord> m_queue;
+    std::vector<std::unique_ptr<WorldChunk>> m_done;
+    int m_busy = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+struct WorldStreamSettings {
+    int chunkSize = 64;
+    int windowRadius = 1;        // window is (2r + 1)^2 chunks
+    int prefetchRadius = 2;      // chunks requested around the player
+    std::size_t cacheChunks = 64;
+    int generatorThreads = 2;
+    bool waitForWindow = false;  // update blocks until the window is complete
+};
+
+class WorldStream {
+public:
+    WorldStream(std::uint64_t seed, const WorldStreamSettings& settings, TileLayout layout = TileLayout::RowMajor)
+        : m_settings(settings),
+          m_windowChunks(2 * settings.windowRadius + 1),
+          m_map(m_windowChunks * settings.chunkSize, m_windowChunks * settings.chunkSize, layout),
+          m_cache(std::max(settings.cacheChunks, 2 * prefetchArea())),
+          m_generator(seed, settings.chunkSize, settings.generatorThreads),
+          m_origin{-settings.windowRadius, -settings.windowRadius},
+          m_slots(static_cast<std::size_t>(m_windowChunks) * m_windowChunks, nullptr) {}
+
+    // The resident window, in window tiles
+    const TileMap& map() const { return m_map; }
+
+    // World chunk at window tile (0, 0)
+    ChunkCoord origin() const { return m_origin; }
+    int chunkSize() const { return m_settings.chunkSize; }
+    int windowRadius() const { return m_settings.windowRadius; }
+
+    // Chunk shown at window chunk slot (sx, sy), or nullptr while it is
+    // still being generated
+    const WorldChunk* slot(int sx, int sy) const {
+        return m_slots[static_cast<std::size_t>(sy) * m_windowChunks + sx];
+    }
+
+    // Once per frame with the player in window tiles. When the player has
+    // left the centre chunk the window moves, and shiftX / shiftY are the
+    // tiles everything in window coordinates must subtract; both are zero
+    // otherwise. Returns true when any window tile changed.
+    //
+    // With waitForWindow set a missing window chunk stalls the caller until
+    // it is built, so the map only changes when the window moves and a
+    // replayed session sees the same tiles on the same tick.
+    bool update(double playerX, double playerY, double dirX, double dirY, int& shiftX, int& shiftY) {
+        bool changed = advance(playerX, playerY, dirX, dirY, shiftX, shiftY);
+        if (!m_settings.waitForWindow) return changed;
+        playerX -= shiftX;
+        playerY -= shiftY;
+        while (windowMissing()) {
+            m_generator.wait();
+            int nextX = 0, nextY = 0;
+            changed |= advance(playerX, playerY, dirX, dirY, nextX, nextY);
+        }
+        return changed;
+    }
+
+    // Blocks until every window chunk is resident, before the first frame
+    void fillWindow() {
+        const double centre = (m_settings.windowRadius + 0.5) * m_settings.chunkSize;
+        int shiftX = 0, shiftY = 0;
+        advance(centre, centre, 0.0, 0.0, shiftX, shiftY);
+        while (windowMissing()) {
+            m_generator.wait();
+            advance(centre, centre, 0.0, 0.0, shiftX, shiftY);
+        }
+    }
+
+    std::size_t cachedChunks() const { return m_cache.size(); }
+    std::size_t cacheCapacity() const { return m_cache.capacity(); }
+    std::size_t evictedChunks() const { return m_cache.evicted(); }
+    std::size_t generatedChunks() const { return m_generated; }
+    std::size_t pendingChunks() const { return m_pending.size(); }
+
+private:
+    struct ChunkOffset {
+        int dx, dy;
+    };
+
+    bool windowMissing() const {
+        return std::find(m_slots.begin(), m_slots.end(), nullptr) != m_slots.end();
+    }
+
+    bool advance(double playerX, double playerY, double dirX, double dirY, int& shiftX, int& shiftY) {
+        const int size = m_settings.chunkSize;
+        const int radius = m_settings.windowRadius;
+        const int slotX = std::clamp(static_cast<int>(std::floor(playerX / size)), 0, m_windowChunks - 1);
+        const int slotY = std::clamp(static_cast<int>(std::floor(playerY / size)), 0, m_windowChunks - 1);
+        shiftX = (slotX - radius) * size;
+        shiftY = (slotY - radius) * size;
+
+        bool changed = false;
+        if (shiftX != 0 || shiftY != 0) {
+            m_origin.x += slotX - radius;
+            m_origin.y += slotY - radius;
+            playerX -= shiftX;
+            playerY -= shiftY;
+            m_map.fill(TileType::Wall);
+            std::fill(m_slots.begin(), m_slots.end(), nullptr);
+            changed = true;
+        }
+
+        // Finished chunks go into the cache, then everything near the player
+        // is touched or requested, nearest to a point one chunk ahead first.
+        // The cache holds at least two surroundings' worth, so touching keeps
+        // every shown chunk from being evicted.
+        m_finished.clear();
+        m_generator.collect(m_finished);
+        for (auto& chunk : m_finished) {
+            m_pending.erase(chunk->coord);
+            m_generated++;
+            m_cache.insert(std::move(chunk));
+        }
+
+        const ChunkCoord centre{m_origin.x + radius, m_origin.y + radius};
+        const double aheadX = playerX / size - radius + dirX - 0.5;
+        const double aheadY = playerY / size - radius + dirY - 0.5;
+        const int reach = m_settings.prefetchRadius;
+        m_wanted.clear();
+        for (int dy = -reach; dy <= reach; dy++) {
+            for (int dx = -reach; dx <= reach; dx++) m_wanted.push_back({dx, dy});
+        }
+        std::sort(m_wanted.begin(), m_wanted.end(), [&](const ChunkOffset& a, const ChunkOffset& b) {
+            return (a.dx - aheadX) * (a.dx - aheadX) + (a.dy - aheadY) * (a.dy - aheadY) <
+                   (b.dx - aheadX) * (b.dx - aheadX) + (b.dy - aheadY) * (b.dy - aheadY);
+        });
+        for (const ChunkOffset& offset : m_wanted) {
+            ChunkCoord coord{centre.x + offset.dx, centre.y + offset.dy};
+            if (m_cache.find(coord) || m_pending.count(coord)) continue;
+            m_pending.insert(coord);
+            m_generator.request(coord);
+        }
+
+        m_dropped.clear();
+        m_generator.retain([&](const ChunkCoord& coord) {
+            return std::max(std::abs(coord.x - centre.x), std::abs(coord.y - centre.y)) <= reach;
+        }, m_dropped);
+        for (const ChunkCoord& coord : m_dropped) m_pending.erase(coord);
+
+        // Copy in window chunks that arrived; a missing one stays solid wall
+        for (int sy = 0; sy < m_windowChunks; sy++) {
+            for (int sx = 0; sx < m_windowChunks; sx++) {
+                const WorldChunk* chunk = m_cache.find({m_origin.x + sx, m_origin.y + sy});
+                const WorldChunk*& shown = m_slots[static_cast<std::size_t>(sy) * m_windowChunks + sx];
+                if (chunk == shown) continue;
+                blit(sx, sy, *chunk);
+                shown = chunk;
+                changed = true;
+            }
+        }
+        return changed;
+    }
+
+    std::size_t prefetchArea() const {
+        const std::size_t side = 2 * static_cast<std::size_t>(m_settings.prefetchRadius) + 1;
+        return side * side;
+    }
+
+    void blit(int slotX, int slotY, const WorldChunk& chunk) {
+        const int size = m_settings.chunkSize;
+        const int x0 = slotX * size, y0 = slotY * size;
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                m_map.set(x0 + x, y0 + y, chunk.tiles[static_cast<std::size_t>(y) * size + x]);
+            }
+        }
+    }
+
+    WorldStreamSettings m_settings;
+    int m_windowChunks;
+    TileMap m_map;
+    ChunkCache m_cache;
+    ChunkGenerator m_generator;
+    ChunkCoord m_origin;
+    std::vector<const WorldChunk*> m_slots;
+    std::unordered_set<ChunkCoord, ChunkCoordHash> m_pending;
+    std::vector<std::unique_ptr<WorldChunk>> m_finished;
+    std::vector<ChunkOffset> m_wanted;
+    std::vector<ChunkCoord> m_dropped;
+    std::size_t m_generated = 0;
+};
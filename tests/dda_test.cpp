@@ -0,0 +1,80 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "dungeon_gen.hpp"
+#include "game_world.hpp"
+#include "ray_packet.hpp"
+#include "raycast_renderer.hpp"
+
+// ===========================================
+// PACKET DDA TEST
+// Casts every column of a view with each ray ISA this machine runs and
+// compares every RayHit bit for bit against the scalar castRay. Views
+// stand in every room of a few generated dungeons, facing 16 ways plus
+// straight along each axis, where a ray direction component is exactly 0.
+// ===========================================
+
+constexpr int SCREEN_COLUMNS = 1280;
+
+bool sameBits(double a, double b) {
+    std::uint64_t bitsA, bitsB;
+    std::memcpy(&bitsA, &a, sizeof(a));
+    std::memcpy(&bitsB, &b, sizeof(b));
+    return bitsA == bitsB;
+}
+
+Player viewFrom(double x, double y, double dirX, double dirY) {
+    Player pose(x, y);
+    pose.dirX = dirX;
+    pose.dirY = dirY;
+    pose.planeX = -dirY * 0.66;
+    pose.planeY = dirX * 0.66;
+    return pose;
+}
+
+int main() {
+    int failures = 0;
+    for (int size : {64, 256}) {
+        for (std::uint64_t seed : {1ull, 42ull, 20260101ull}) {
+            TileMap map(size, size);
+            std::vector<Room> rooms;
+            generateDungeon(map, rooms, seed);
+            const RayGrid grid = map.rayGrid();
+
+            std::vector<Player> poses;
+            for (const Room& room : rooms) {
+                const double x = room.centerX() + 0.37, y = room.centerY() + 0.61;
+                for (int i = 0; i < 16; i++) {
+                    const double angle = i * (2 * 3.14159265358979 / 16) + 0.01;
+                    poses.push_back(viewFrom(x, y, std::cos(angle), std::sin(angle)));
+                }
+                const double axes[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+                for (const auto& axis : axes) poses.push_back(viewFrom(x, y, axis[0], axis[1]));
+            }
+
+            std::vector<RayHit> reference(SCREEN_COLUMNS), hits(SCREEN_COLUMNS);
+            for (RayIsa isa : {RayIsa::Scalar, RayIsa::SSE2, RayIsa::AVX2, RayIsa::NEON}) {
+                if (!rayIsaSupported(isa)) continue;
+                std::size_t mismatches = 0;
+                for (const Player& pose : poses) {
+                    for (int x = 0; x < SCREEN_COLUMNS; x++) reference[x] = castRay(pose, map, SCREEN_COLUMNS, x);
+                    castRayRange(isa, rayCamera(pose), grid, SCREEN_COLUMNS, 0, SCREEN_COLUMNS, hits.data());
+                    for (int x = 0; x < SCREEN_COLUMNS; x++) {
+                        if (!sameBits(hits[x].perpWallDist, reference[x].perpWallDist) ||
+                            hits[x].side != reference[x].side || !sameBits(hits[x].wallX, reference[x].wallX)) {
+                            mismatches++;
+                        }
+                    }
+                }
+                std::cout << rayIsaName(isa) << " on " << size << "x" << size << ", seed " << seed << ": "
+                          << (mismatches == 0 ? "matches scalar" : "MISMATCH") << " (" << mismatches << " of "
+                          << poses.size() * SCREEN_COLUMNS << " rays differ)\n";
+                if (mismatches > 0) failures++;
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}